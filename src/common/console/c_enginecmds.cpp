@@ -52,6 +52,7 @@
 #include "version.h"
 #include "findfile.h"
 #include "md5.h"
+#include "i_time.h"
 
 extern FILE* Logfile;
 
@@ -336,3 +337,53 @@ CCMD(printlocalized)
 	}
 
 }
+
+//==========================================================================
+//
+// CCMD stringbench
+//
+// Times the FString operations that dominate parsing and per-tic script
+// code: short tokens, copies, small formatted numbers and appending.
+//
+//==========================================================================
+
+CCMD(stringbench)
+{
+	static const char *const tokens[] = { "x", "id", "v1", "sector", "special", "arg0", "texturemiddle", "blocking" };
+	int count = argv.argc() > 1 ? (int)strtol(argv[1], nullptr, 0) : 1000000;
+	if (count <= 0) return;
+	unsigned total = 0;
+
+	uint64_t t0 = I_nsTime();
+	for (int i = 0; i < count; i++)
+	{
+		FString token = tokens[i & 7];
+		total += (unsigned)token.Len();
+	}
+	uint64_t t1 = I_nsTime();
+	FString source = "v1";
+	for (int i = 0; i < count; i++)
+	{
+		FString copy = source;
+		total += (unsigned)copy.Len();
+	}
+	uint64_t t2 = I_nsTime();
+	for (int i = 0; i < count; i++)
+	{
+		FString num;
+		num.Format("%d", i & 1023);
+		total += (unsigned)num.Len();
+	}
+	uint64_t t3 = I_nsTime();
+	for (int i = 0; i < count / 16; i++)
+	{
+		FString line;
+		for (int j = 0; j < 16; j++) line += tokens[j & 7][0];
+		total += (unsigned)line.Len();
+	}
+	uint64_t t4 = I_nsTime();
+
+	double n = count;
+	Printf("construct %.1f  copy %.1f  format %.1f  append %.1f ns/op (%u)\n",
+		(t1 - t0) / n, (t2 - t1) / n, (t3 - t2) / n, (t4 - t3) / n, total);
+}
@@ -916,6 +916,7 @@ xx(Unit)
 xx(Size)
 xx(Push)
 xx(Insert)
+xx(Fill)
 xx(Copy)
 xx(Move)
 xx(Voidptr)
@@ -1295,7 +1295,8 @@ void FScanner::AddSymbol(const char* name, double value)
 int FScriptPosition::ErrorCounter;
 int FScriptPosition::WarnCounter;
 int FScriptPosition::Developer;
-bool FScriptPosition::StrictErrors;	// makes all OPTERROR messages real errors.
+thread_local bool FScriptPosition::StrictErrors;	// makes all OPTERROR messages real errors.
+thread_local FScriptMessageBuffer *FScriptPosition::MessageBuffer;
 bool FScriptPosition::errorout;		// call I_Error instead of printing the error itself.
 
 
@@ -1362,13 +1363,13 @@ void FScriptPosition::Message (int severity, const char *message, ...) const
 	case MSG_WARNING:
 	case MSG_DEBUGWARN:
 	case MSG_DEBUGERROR:	// This is intentionally not being printed as an 'error', the difference to MSG_DEBUGWARN is only the severity level at which it gets triggered.
-		WarnCounter++;
+		if (MessageBuffer == nullptr) WarnCounter++;
 		type = "warning";
 		color = TEXTCOLOR_ORANGE;
 		break;
 
 	case MSG_ERROR:
-		ErrorCounter++;
+		if (MessageBuffer == nullptr) ErrorCounter++;
 		type = "error";
 		color = TEXTCOLOR_RED;
 		break;
@@ -1387,14 +1388,59 @@ void FScriptPosition::Message (int severity, const char *message, ...) const
 		break;
 
 	case MSG_FATAL:
+		if (MessageBuffer != nullptr)
+		{
+			MessageBuffer->Messages.Push({ MSG_FATAL, PRINT_HIGH, FStringf("Script error, \"%s\" line %d:\n%s\n",
+				FileName.GetChars(), ScriptLine, composed.GetChars()) });
+			return;
+		}
 		I_Error ("Script error, \"%s\" line %d:\n%s\n",
 			FileName.GetChars(), ScriptLine, composed.GetChars());
 		return;
 	}
+	if (MessageBuffer != nullptr)
+	{
+		// The counters get updated when the buffer is flushed.
+		int kind = severity == MSG_ERROR ? MSG_ERROR : *type == 'w' ? MSG_WARNING : MSG_MESSAGE;
+		MessageBuffer->Messages.Push({ kind, level,
+			FStringf("%sScript %s, \"%s\" line %d:\n%s%s\n", color, type, FileName.GetChars(), ScriptLine, color, composed.GetChars()) });
+		return;
+	}
 	Printf (level, "%sScript %s, \"%s\" line %d:\n%s%s\n",
 		color, type, FileName.GetChars(), ScriptLine, color, composed.GetChars());
 }
 
+//==========================================================================
+//
+// FScriptMessageBuffer::Flush
+//
+// Must be called from the main thread.
+//
+//==========================================================================
+
+void FScriptMessageBuffer::Flush()
+{
+	for (auto &msg : Messages)
+	{
+		switch (msg.Severity)
+		{
+		case MSG_FATAL:
+			I_Error("%s", msg.Text.GetChars());
+			break;
+
+		case MSG_ERROR:
+			FScriptPosition::ErrorCounter++;
+			break;
+
+		case MSG_WARNING:
+			FScriptPosition::WarnCounter++;
+			break;
+		}
+		Printf(msg.PrintLevel, "%s", msg.Text.GetChars());
+	}
+	Messages.Clear();
+}
+
 //==========================================================================
 //
 // ParseHex
@@ -222,6 +222,26 @@ enum
 	MSG_MESSAGE
 };
 
+//==========================================================================
+//
+// Collects the messages a worker thread generates so that they can be
+// printed in a deterministic order once all work is done.
+//
+//==========================================================================
+
+struct FScriptMessageBuffer
+{
+	struct Entry
+	{
+		int Severity;	// MSG_WARNING, MSG_ERROR, MSG_FATAL or MSG_MESSAGE
+		int PrintLevel;
+		FString Text;
+	};
+	TArray<Entry> Messages;
+
+	void Flush();
+};
+
 //==========================================================================
 //
 // a class that remembers a parser position
@@ -232,7 +252,8 @@ struct FScriptPosition
 {
 	static int WarnCounter;
 	static int ErrorCounter;
-	static bool StrictErrors;
+	static thread_local bool StrictErrors;
+	static thread_local FScriptMessageBuffer *MessageBuffer;	// if set, messages get collected here instead of being printed.
 	static int Developer;
 	static bool errorout;
 	FName FileName;
@@ -467,6 +467,8 @@ void FStringTable::InsertString(int lumpnum, int langid, FName label, const FStr
 			te.strings[i].Substitute(replacee, replacement);
 		}
 	}
+	// GetString hands out pointers into these strings, which must not move when the table grows.
+	for (auto &str : te.strings) str.MoveToHeap();
 	allStrings[langid].Insert(label, te);
 }
 
@@ -389,6 +389,12 @@ static inline void GC::WriteBarrier(DObject *pointed)
 	}
 }
 
+inline bool GC::NeedsMark(DObject *obj)
+{
+	return obj != nullptr && !(obj->ObjectFlags & OF_Released) &&
+		((obj->ObjectFlags & OF_EuthanizeMe) || obj->IsWhite());
+}
+
 #include "memarena.h"
 extern FMemArena ClassDataAllocator;
 #include "symbols.h"
@@ -62,6 +62,10 @@
 #include "menu.h"
 #include "stats.h"
 #include "printf.h"
+#include "c_cvars.h"
+#include "i_time.h"
+#include "ctpl.h"
+#include <thread>
 
 // MACROS ------------------------------------------------------------------
 
@@ -91,6 +95,13 @@
 #define GCSWEEPCOST		10
 #define GCFINALIZECOST	100
 
+// Number of single steps between time checks in budget mode.
+#define GCBUDGETCHECK	32
+
+// Ranges smaller than this are not worth splitting between threads.
+#define GCPARALLELMIN	1024u
+#define GCMAXMARKTHREADS	8
+
 // TYPES -------------------------------------------------------------------
 
 // EXTERNAL FUNCTION PROTOTYPES --------------------------------------------
@@ -99,10 +110,23 @@
 
 // PRIVATE FUNCTION PROTOTYPES ---------------------------------------------
 
+namespace GC { static void BudgetChanged(); }
+
 // EXTERNAL DATA DECLARATIONS ----------------------------------------------
 
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
 
+// When non-0, collection steps are not paced by allocations but done once
+// per frame, right before it is presented, for up to this many
+// microseconds. Allocation pacing only takes over if memory grows past
+// twice the usual threshold.
+CUSTOM_CVAR(Int, gc_budget, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	GC::BudgetChanged();
+}
+
+CVAR(Bool, gc_parallelmark, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
 namespace GC
 {
 size_t AllocBytes;
@@ -117,11 +141,24 @@ EGCState State = GCS_Pause;
 int Pause = DEFAULT_GCPAUSE;
 int StepMul = DEFAULT_GCMUL;
 int StepCount;
+int CycleCount;
 size_t Dept;
 bool FinalGC;
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
+// Collection starts at this amount of memory in budget mode. Threshold is
+// then only a limit for when allocation pacing has to step in.
+static size_t BudgetThreshold;
+
+// Pause times of all steps and full collections, for stat gc.
+enum { NUM_PAUSE_BUCKETS = 8 };
+static const unsigned PauseBucketLimits[NUM_PAUSE_BUCKETS - 1] = { 50, 100, 250, 500, 1000, 2500, 5000 };
+static unsigned PauseHistogram[NUM_PAUSE_BUCKETS];
+static uint64_t MaxPause;
+
+static std::unique_ptr<ctpl::thread_pool> MarkPool;
+
 // CODE --------------------------------------------------------------------
 
 //==========================================================================
@@ -135,6 +172,62 @@ bool FinalGC;
 void SetThreshold()
 {
 	Threshold = (Estimate / 100) * Pause;
+	if (gc_budget > 0)
+	{
+		BudgetThreshold = Threshold;
+		Threshold *= 2;
+	}
+	else
+	{
+		BudgetThreshold = 0;
+	}
+}
+
+//==========================================================================
+//
+// BudgetChanged
+//
+// Recomputes the thresholds for the new gc_budget right away instead of
+// leaving the old ones in place until the current cycle finishes.
+//
+//==========================================================================
+
+static void BudgetChanged()
+{
+	if (State == GCS_Pause)
+	{
+		SetThreshold();
+	}
+	else if (gc_budget > 0)
+	{
+		BudgetThreshold = (Estimate / 100) * Pause;
+	}
+	else
+	{
+		// Let allocation pacing finish the running cycle.
+		BudgetThreshold = 0;
+		Threshold = MIN(Threshold, AllocBytes);
+	}
+}
+
+//==========================================================================
+//
+// RecordPause
+//
+// Adds the time since start to the pause histogram.
+//
+//==========================================================================
+
+static void RecordPause(uint64_t start)
+{
+	uint64_t us = (I_nsTime() - start) / 1000;
+	int bucket = 0;
+	while (bucket < NUM_PAUSE_BUCKETS - 1 && us >= PauseBucketLimits[bucket])
+	{
+		bucket++;
+	}
+	PauseHistogram[bucket]++;
+	MaxPause = MAX(MaxPause, us);
 }
 
 //==========================================================================
@@ -354,6 +447,7 @@ static size_t SingleStep()
 	case GCS_Finalize:
 		State = GCS_Pause;		// end collection
 		Dept = 0;
+		CycleCount++;
 		return 0;
 
 	default:
@@ -373,6 +467,7 @@ static size_t SingleStep()
 
 void Step()
 {
+	uint64_t start = I_nsTime();
 	size_t lim = (GCSTEPSIZE/100) * StepMul;
 	size_t olim;
 	if (lim == 0)
@@ -403,6 +498,130 @@ void Step()
 		SetThreshold();
 	}
 	StepCount++;
+	RecordPause(start);
+}
+
+//==========================================================================
+//
+// BudgetStep
+//
+// Performs single steps until the collection is done or gc_budget
+// microseconds have passed. A new collection is started once memory
+// reaches BudgetThreshold.
+//
+//==========================================================================
+
+void BudgetStep()
+{
+	if (gc_budget <= 0)
+	{
+		return;
+	}
+	if (State == GCS_Pause)
+	{
+		if (BudgetThreshold == 0)
+		{ // The mode was just switched on.
+			SetThreshold();
+		}
+		if (AllocBytes < BudgetThreshold)
+		{
+			return;
+		}
+	}
+
+	uint64_t start = I_nsTime();
+	uint64_t deadline = start + uint64_t(gc_budget) * 1000;
+	do
+	{
+		for (int i = 0; i < GCBUDGETCHECK && State != GCS_Pause; i++)
+		{
+			SingleStep();
+		}
+	} while (State != GCS_Pause && I_nsTime() < deadline);
+
+	if (State == GCS_Pause)
+	{
+		SetThreshold();
+	}
+	else
+	{
+		// Allocation pacing is only a backstop while the collection is in progress.
+		Threshold = MAX(Threshold, AllocBytes + (Estimate / 100) * Pause);
+	}
+	StepCount++;
+	RecordPause(start);
+}
+
+//==========================================================================
+//
+// ParallelMarkAvailable
+//
+//==========================================================================
+
+static int MarkThreadCount()
+{
+	static int hwthreads = clamp<int>(std::thread::hardware_concurrency(), 1, GCMAXMARKTHREADS);
+	return gc_parallelmark ? hwthreads : 1;
+}
+
+bool ParallelMarkAvailable()
+{
+	return MarkThreadCount() > 1;
+}
+
+//==========================================================================
+//
+// MarkParallel
+//
+// The scan functions only read, and the calling thread waits for the
+// workers, so nothing can change under them. All marking is done by the
+// calling thread afterwards.
+//
+//==========================================================================
+
+void MarkParallel(size_t count, const GCScanFunc &scan)
+{
+	static TArray<DObject **> found[GCMAXMARKTHREADS];
+	int numthreads = MarkThreadCount();
+
+	if (numthreads > 1 && count >= GCPARALLELMIN)
+	{
+		if (MarkPool == nullptr)
+		{
+			MarkPool.reset(new ctpl::thread_pool(numthreads - 1));
+		}
+		size_t chunk = (count + numthreads - 1) / numthreads;
+		std::future<void> done[GCMAXMARKTHREADS];
+		for (int i = 1; i < numthreads; i++)
+		{
+			size_t first = MIN(count, chunk * i), last = MIN(count, chunk * (i + 1));
+			done[i] = MarkPool->push([&scan, first, last, i](int)
+			{
+				found[i].Clear();
+				scan(first, last, found[i]);
+			});
+		}
+		found[0].Clear();
+		scan(0, MIN(count, chunk), found[0]);
+		for (int i = 1; i < numthreads; i++)
+		{
+			done[i].wait();
+		}
+	}
+	else
+	{
+		numthreads = 1;
+		found[0].Clear();
+		scan(0, count, found[0]);
+	}
+
+	for (int i = 0; i < numthreads; i++)
+	{
+		for (auto obj : found[i])
+		{
+			Mark(obj);
+		}
+	}
 }
 
 //==========================================================================
@@ -415,6 +634,7 @@ void Step()
 
 void FullGC()
 {
+	uint64_t start = I_nsTime();
 	if (State <= GCS_Propagate)
 	{
 		// Reset sweep mark to sweep all elements (returning them to white)
@@ -434,6 +654,7 @@ void FullGC()
 		SingleStep();
 	}
 	SetThreshold();
+	RecordPause(start);
 }
 
 //==========================================================================
@@ -580,6 +801,17 @@ ADD_STAT(gc)
 	{
 		out.AppendFormat("  %zuK", (GC::Dept + 1023) >> 10);
 	}
+	if (gc_budget > 0)
+	{
+		out.AppendFormat("  Budget:%dus", *gc_budget);
+	}
+	out += "\nPauses:";
+	for (int i = 0; i < GC::NUM_PAUSE_BUCKETS; i++)
+	{
+		if (i < GC::NUM_PAUSE_BUCKETS - 1) out.AppendFormat("  <%uus:%u", GC::PauseBucketLimits[i], GC::PauseHistogram[i]);
+		else out.AppendFormat("  more:%u", GC::PauseHistogram[i]);
+	}
+	out.AppendFormat("  Max:%lluus", (unsigned long long)GC::MaxPause);
 	return out;
 }
 
@@ -595,7 +827,7 @@ CCMD(gc)
 {
 	if (argv.argc() == 1)
 	{
-		Printf ("Usage: gc stop|now|full|count|pause [size]|stepmul [size]\n");
+		Printf ("Usage: gc stop|now|full|count|resetstats|pause [size]|stepmul [size]\n");
 		return;
 	}
 	if (stricmp(argv[1], "stop") == 0)
@@ -610,6 +842,11 @@ CCMD(gc)
 	{
 		GC::FullGC();
 	}
+	else if (stricmp(argv[1], "resetstats") == 0)
+	{
+		memset(GC::PauseHistogram, 0, sizeof(GC::PauseHistogram));
+		GC::MaxPause = 0;
+	}
 	else if (stricmp(argv[1], "count") == 0)
 	{
 		int cnt = 0;
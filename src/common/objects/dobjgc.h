@@ -1,5 +1,6 @@
 #pragma once
 #include <stdint.h>
+#include <functional>
 #include "tarray.h"
 class DObject;
 class FSerializer;
@@ -26,6 +27,7 @@ enum EObjectFlags
 	OF_Transient		= 1 << 11,		// Object should not be archived (references to it will be nulled on disk)
 	OF_Spawned			= 1 << 12,      // Thinker was spawned at all (some thinkers get deleted before spawning)
 	OF_Released			= 1 << 13,		// Object was released from the GC system and should not be processed by GC function
+	OF_Pooled			= 1 << 14,		// Object is parked in a recycling pool (also has OF_EuthanizeMe and OF_Fixed set while there)
 };
 
 template<class T> class TObjPtr;
@@ -70,6 +72,9 @@ namespace GC
 	// Is this the final collection just before exit?
 	extern bool FinalGC;
 
+	// Number of collections that have run to completion.
+	extern int CycleCount;
+
 	// Current white value for known-dead objects.
 	static inline uint32_t OtherWhite()
 	{
@@ -82,6 +87,10 @@ namespace GC
 	// Does one collection step.
 	void Step();
 
+	// Does collection steps for up to gc_budget microseconds, if that
+	// mode is enabled. Meant to be called once per frame.
+	void BudgetStep();
+
 	// Does a complete collection.
 	void FullGC();
 
@@ -158,6 +167,25 @@ namespace GC
 	using GCMarkerFunc = void(*)();
 	void AddMarkerFunc(GCMarkerFunc func);
 
+	// Checks without changing anything whether Mark would do something
+	// with this object.
+	inline bool NeedsMark(DObject *obj);
+
+	// Adds the address of the pointer to the list if it needs marking.
+	template<class T> void Collect(TObjPtr<T> &obj, TArray<DObject **> &out);
+
+	// Scans the range [first, last) of some array of pointer holders and
+	// collects the pointers that need marking. This runs on worker
+	// threads, so it must not change anything.
+	using GCScanFunc = std::function<void(size_t first, size_t last, TArray<DObject **> &out)>;
+
+	// Splits [0, count) between the worker threads, lets them scan it and
+	// marks everything they collected.
+	void MarkParallel(size_t count, const GCScanFunc &scan);
+
+	// Whether MarkParallel can actually use more than one thread.
+	bool ParallelMarkAvailable();
+
 }
 
 // A template class to help with handling read barriers. It does not
@@ -241,6 +269,7 @@ public:
 	}
 
 	template<class U> friend inline void GC::Mark(TObjPtr<U> &obj);
+	template<class U> friend inline void GC::Collect(TObjPtr<U> &obj, TArray<DObject **> &out);
 	template<class U> friend FSerializer &Serialize(FSerializer &arc, const char *key, TObjPtr<U> &value, TObjPtr<U> *);
 	template<class U> friend FSerializer &Serialize(FSerializer &arc, const char *key, TObjPtr<U> &value, U *);
 
@@ -260,4 +289,12 @@ namespace GC
 	{
 		GC::Mark(&obj.o);
 	}
+
+	template<class T> inline void Collect(TObjPtr<T> &obj, TArray<DObject **> &out)
+	{
+		if (NeedsMark(obj.o))
+		{
+			out.Push(&obj.o);
+		}
+	}
 }
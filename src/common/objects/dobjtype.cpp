@@ -64,7 +64,7 @@ EXTERN_CVAR(Bool, strictdecorate);
 FMemArena ClassDataAllocator(32768);	// use this for all static class data that can be released in bulk when the type system is shut down.
 
 TArray<PClass *> PClass::AllClasses;
-TMap<FName, PClass*> PClass::ClassMap;
+TOpenMap<FName, PClass*> PClass::ClassMap;
 TArray<VMFunction**> PClass::FunctionPtrList;
 bool PClass::bShutdown;
 bool PClass::bVMOperational;
@@ -133,7 +133,7 @@ public:
 	static void FindFunction(VMFunction **pptr, FName cls, FName func);
 	PClass *FindClassTentative(FName name);
 
-	static TMap<FName, PClass*> ClassMap;
+	static TOpenMap<FName, PClass*> ClassMap;
 	static TArray<PClass *> AllClasses;
 	static TArray<VMFunction**> FunctionPtrList;
 
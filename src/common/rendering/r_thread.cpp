@@ -39,6 +39,10 @@ void PeekThreadedErrorPane();
 CVAR(Int, r_multithreaded, 1, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 CVAR(Int, r_debug_draw, 0, 0);
 
+// How the lines of the screen are divided among the drawer threads:
+// 0 = every Nth line (better balanced), 1 = one contiguous band per thread (better cache use)
+CVAR(Int, r_drawerpartition, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+
 /////////////////////////////////////////////////////////////////////////////
 
 DrawerThreads *DrawerThreads::Instance()
@@ -58,7 +62,7 @@ DrawerThreads::~DrawerThreads()
 
 void DrawerThreads::Execute(DrawerCommandQueuePtr commands)
 {
-	if (!commands || commands->commands.empty())
+	if (!commands || commands->runs.empty())
 		return;
 	
 	auto queue = Instance();
@@ -68,6 +72,8 @@ void DrawerThreads::Execute(DrawerCommandQueuePtr commands)
 	// Add to queue and awaken worker threads
 	std::unique_lock<std::mutex> start_lock(queue->start_mutex);
 	std::unique_lock<std::mutex> end_lock(queue->end_mutex);
+	if (queue->active_commands.empty())
+		queue->partition_mode = r_drawerpartition;
 	queue->active_commands.push_back(commands);
 	queue->tasks_left += queue->threads.size();
 	end_lock.unlock();
@@ -116,11 +122,7 @@ void DrawerThreads::WaitForWorkers()
 		thread.current_queue = 0;
 
 	for (auto &list : queue->active_commands)
-	{
-		for (auto &command : list->commands)
-			command->~DrawerCommand();
 		list->Clear();
-	}
 	queue->active_commands.clear();
 }
 
@@ -137,30 +139,27 @@ void DrawerThreads::WorkerMain(DrawerThread *thread)
 		// Grab the commands
 		DrawerCommandQueuePtr list = active_commands[thread->current_queue];
 		thread->current_queue++;
-		thread->numa_start_y = thread->numa_node * screen->GetHeight() / thread->num_numa_nodes;
-		thread->numa_end_y = (thread->numa_node + 1) * screen->GetHeight() / thread->num_numa_nodes;
-		if (thread->poly)
-		{
-			thread->poly->numa_start_y = thread->numa_start_y;
-			thread->poly->numa_end_y = thread->numa_end_y;
-		}
+		SetupLinePartition(thread);
 		start_lock.unlock();
 
 		// Do the work:
 		if (r_debug_draw)
 		{
-			for (auto& command : list->commands)
+			for (auto& run : list->runs)
 			{
-				thread->debug_draw_pos++;
-				if (thread->debug_draw_pos < debug_draw_end)
-					command->Execute(thread);
+				// Only the commands before debug_draw_end are drawn
+				size_t count = 0;
+				if (thread->debug_draw_pos + 1 < debug_draw_end)
+					count = MIN(run.Count, debug_draw_end - thread->debug_draw_pos - 1);
+				thread->debug_draw_pos += run.Count;
+				run.Execute(thread, run.Data, count);
 			}
 		}
 		else
 		{
-			for (auto& command : list->commands)
+			for (auto& run : list->runs)
 			{
-				command->Execute(thread);
+				run.Execute(thread, run.Data, run.Count);
 			}
 		}
 
@@ -174,6 +173,41 @@ void DrawerThreads::WorkerMain(DrawerThread *thread)
 	}
 }
 
+// Each NUMA node draws its own band of the screen. Inside that band the node's
+// threads either take every Nth line or split it further into one band each.
+// The drawers only look at the resulting range and line step, so a band is
+// simply an interleave with a step of one.
+void DrawerThreads::SetupLinePartition(DrawerThread *thread)
+{
+	int height = screen->GetHeight();
+	int node_start_y = thread->numa_node * height / thread->num_numa_nodes;
+	int node_end_y = (thread->numa_node + 1) * height / thread->num_numa_nodes;
+
+	if (partition_mode == 1)
+	{
+		int node_height = node_end_y - node_start_y;
+		thread->numa_start_y = node_start_y + thread->node_core * node_height / thread->node_num_cores;
+		thread->numa_end_y = node_start_y + (thread->node_core + 1) * node_height / thread->node_num_cores;
+		thread->core = 0;
+		thread->num_cores = 1;
+	}
+	else
+	{
+		thread->numa_start_y = node_start_y;
+		thread->numa_end_y = node_end_y;
+		thread->core = thread->node_core;
+		thread->num_cores = thread->node_num_cores;
+	}
+
+	if (thread->poly)
+	{
+		thread->poly->core = thread->core;
+		thread->poly->num_cores = thread->num_cores;
+		thread->poly->numa_start_y = thread->numa_start_y;
+		thread->poly->numa_end_y = thread->numa_end_y;
+	}
+}
+
 void DrawerThreads::StartThreads()
 {
 	std::unique_lock<std::mutex> lock(threads_mutex);
@@ -216,8 +250,8 @@ void DrawerThreads::StartThreads()
 				{
 					DrawerThreads *queue = this;
 					DrawerThread *thread = &threads[curThread++];
-					thread->core = i;
-					thread->num_cores = I_GetNumaNodeThreadCount(numaNode);
+					thread->node_core = i;
+					thread->node_num_cores = I_GetNumaNodeThreadCount(numaNode);
 					thread->numa_node = numaNode;
 					thread->num_numa_nodes = I_GetNumaNodeCount();
 					thread->thread = std::thread([=]() { queue->WorkerMain(thread); });
@@ -231,8 +265,8 @@ void DrawerThreads::StartThreads()
 			{
 				DrawerThreads *queue = this;
 				DrawerThread *thread = &threads[i];
-				thread->core = i;
-				thread->num_cores = num_threads;
+				thread->node_core = i;
+				thread->node_num_cores = num_threads;
 				thread->numa_node = 0;
 				thread->num_numa_nodes = 1;
 				thread->thread = std::thread([=]() { queue->WorkerMain(thread); });
@@ -261,9 +295,45 @@ DrawerCommandQueue::DrawerCommandQueue(RenderMemory *frameMemory) : FrameMemory(
 {
 }
 
-void *DrawerCommandQueue::AllocMemory(size_t size)
+DrawerCommandQueue::~DrawerCommandQueue()
+{
+	Clear();
+}
+
+void DrawerCommandQueue::Clear()
 {
-	return FrameMemory->AllocMemory<uint8_t>((int)size);
+	for (auto &run : runs)
+		run.Destroy(run.Data, run.Count);
+	runs.clear();
+	ChunkPos = nullptr;
+	ChunkEnd = nullptr;
+}
+
+void *DrawerCommandQueue::AllocCommand(ExecuteRunFunc execute, DestroyRunFunc destroy, size_t size)
+{
+	if ((size_t)(ChunkEnd - ChunkPos) < size)
+	{
+		size_t chunkSize = MAX<size_t>(size, ChunkSize);
+		ChunkPos = FrameMemory->AllocMemory<uint8_t>((int)chunkSize);
+		ChunkEnd = ChunkPos + chunkSize;
+	}
+
+	uint8_t *ptr = ChunkPos;
+	ChunkPos += size;
+
+	// Extend the last run if this command directly follows it
+	if (!runs.empty())
+	{
+		CommandRun &last = runs.back();
+		if (last.Execute == execute && last.Data + last.Count * size == ptr)
+		{
+			last.Count++;
+			return ptr;
+		}
+	}
+
+	runs.push_back({ execute, destroy, ptr, 1 });
+	return ptr;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -273,7 +343,7 @@ void GroupMemoryBarrierCommand::Execute(DrawerThread *thread)
 	std::unique_lock<std::mutex> lock(mutex);
 	count++;
 	condition.notify_all();
-	condition.wait(lock, [&]() { return count >= (size_t)thread->num_cores; });
+	condition.wait(lock, [&]() { return count >= (size_t)thread->node_num_cores; });
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -48,9 +48,13 @@ public:
 	// Thread line index of this thread
 	int core = 0;
 
-	// Number of active threads
+	// Line step between the lines rendered by this thread
 	int num_cores = 1;
 
+	// Position of this thread among the threads of its NUMA node
+	int node_core = 0;
+	int node_num_cores = 1;
+
 	// NUMA node this thread belongs to
 	int numa_node = 0;
 
@@ -164,6 +168,7 @@ private:
 	void StartThreads();
 	void StopThreads();
 	void WorkerMain(DrawerThread *thread);
+	void SetupLinePartition(DrawerThread *thread);
 
 	static DrawerThreads *Instance();
 	
@@ -174,6 +179,7 @@ private:
 	std::condition_variable start_condition;
 	std::vector<DrawerCommandQueuePtr> active_commands;
 	bool shutdown_flag = false;
+	int partition_mode = 0;
 
 	std::mutex end_mutex;
 	std::condition_variable end_condition;
@@ -188,12 +194,16 @@ private:
 
 class RenderMemory;
 
+// Commands are stored back to back in memory. Consecutive commands of the same
+// type form a run, which the worker threads execute with a single indirect call.
 class DrawerCommandQueue
 {
 public:
 	DrawerCommandQueue(RenderMemory *memoryAllocator);
+	~DrawerCommandQueue();
 	
-	void Clear() { commands.clear(); }
+	// Destroys all queued commands
+	void Clear();
 	
 	// Queue command to be executed by drawer worker threads
 	template<typename T, typename... Types>
@@ -202,9 +212,9 @@ public:
 		DrawerThreads *threads = DrawerThreads::Instance();
 		if (r_multithreaded != 0)
 		{
-			void *ptr = AllocMemory(sizeof(T));
-			T *command = new (ptr)T(std::forward<Types>(args)...);
-			commands.push_back(command);
+			static_assert(alignof(T) <= CommandAlignment, "Drawer command needs a larger alignment");
+			void *ptr = AllocCommand(&ExecuteRun<T>, &DestroyRun<T>, CommandSize<T>());
+			new (ptr)T(std::forward<Types>(args)...);
 		}
 		else
 		{
@@ -214,10 +224,52 @@ public:
 	}
 	
 private:
+	typedef void(*ExecuteRunFunc)(DrawerThread *thread, uint8_t *data, size_t count);
+	typedef void(*DestroyRunFunc)(uint8_t *data, size_t count);
+
+	struct CommandRun
+	{
+		ExecuteRunFunc Execute;
+		DestroyRunFunc Destroy;
+		uint8_t *Data;
+		size_t Count;
+	};
+
+	enum
+	{
+		CommandAlignment = 16,
+		ChunkSize = 64 * 1024
+	};
+
+	template<typename T>
+	static constexpr size_t CommandSize()
+	{
+		return (sizeof(T) + CommandAlignment - 1) / CommandAlignment * CommandAlignment;
+	}
+
+	template<typename T>
+	static void ExecuteRun(DrawerThread *thread, uint8_t *data, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			T *command = reinterpret_cast<T *>(data + i * CommandSize<T>());
+			command->T::Execute(thread);
+		}
+	}
+
+	template<typename T>
+	static void DestroyRun(uint8_t *data, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+			reinterpret_cast<T *>(data + i * CommandSize<T>())->~T();
+	}
+
 	// Allocate memory valid for the duration of a command execution
-	void *AllocMemory(size_t size);
+	void *AllocCommand(ExecuteRunFunc execute, DestroyRunFunc destroy, size_t size);
 	
-	std::vector<DrawerCommand *> commands;
+	std::vector<CommandRun> runs;
+	uint8_t *ChunkPos = nullptr;
+	uint8_t *ChunkEnd = nullptr;
 	RenderMemory *FrameMemory;
 	
 	friend class DrawerThreads;
@@ -8136,7 +8136,7 @@ FxExpression *FxMemberFunctionCall::Resolve(FCompileContext& ctx)
 					}
 				}
 
-				if (isDynArrayObj && ((MethodName == NAME_Push && idx == 0) || (MethodName == NAME_Insert && idx == 1)))
+				if (isDynArrayObj && ((MethodName == NAME_Push && idx == 0) || (MethodName == NAME_Insert && idx == 1) || (MethodName == NAME_Fill && idx == 0)))
 				{
 					// Null pointers are always valid.
 					if (!a->isConstant() || static_cast<FxConstant*>(a)->GetValue().GetPointer() != nullptr)
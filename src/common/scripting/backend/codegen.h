@@ -135,10 +135,18 @@ struct ExpVal
 		}
 	}
 
+	// Strings never share their data with anything else, neither when they enter an ExpVal nor when they
+	// are copied out of one. Function bodies get emitted on multiple threads and FString's reference
+	// counting is not thread safe.
+	static FString CopyString(const FString &str)
+	{
+		return FString(str.GetChars(), str.Len());
+	}
+
 	ExpVal(const FString &str)
 	{
 		Type = TypeString;
-		::new(&pointer) FString(str);
+		::new(&pointer) FString(CopyString(str));
 	}
 
 	ExpVal(const ExpVal &o)
@@ -146,7 +154,7 @@ struct ExpVal
 		Type = o.Type;
 		if (o.Type == TypeString)
 		{
-			::new(&pointer) FString(*(FString *)&o.pointer);
+			::new(&pointer) FString(CopyString(*(FString *)&o.pointer));
 		}
 		else
 		{
@@ -163,7 +171,7 @@ struct ExpVal
 		Type = o.Type;
 		if (o.Type == TypeString)
 		{
-			::new(&pointer) FString(*(FString *)&o.pointer);
+			::new(&pointer) FString(CopyString(*(FString *)&o.pointer));
 		}
 		else
 		{
@@ -198,7 +206,7 @@ struct ExpVal
 
 	const FString GetString() const
 	{
-		return Type == TypeString ? *(FString *)&pointer : Type == TypeName ? FString(FName(ENamedName(Int)).GetChars()) : FString();
+		return Type == TypeString ? CopyString(*(FString *)&pointer) : Type == TypeName ? FString(FName(ENamedName(Int)).GetChars()) : FString();
 	}
 
 	bool GetBool() const
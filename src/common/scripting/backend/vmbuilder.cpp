@@ -37,6 +37,7 @@
 #include "m_argv.h"
 #include "c_cvars.h"
 #include "jit.h"
+#include "parallel_for.h"
 
 CVAR(Bool, strictdecorate, false, CVAR_GLOBALCONFIG | CVAR_ARCHIVE)
 
@@ -812,110 +813,182 @@ VMFunction *FFunctionBuildList::AddFunction(PNamespace *gnspc, const VersionInfo
 }
 
 
-void FFunctionBuildList::Build()
+//==========================================================================
+//
+// FFunctionBuildList :: Resolve
+//
+// Resolving creates types, looks up and adds symbols and names and
+// allocates expression nodes, so this must be done on the main thread.
+// Everything the emit pass needs from global state is prepared here.
+//
+//==========================================================================
+
+bool FFunctionBuildList::Resolve(Item &item)
 {
-	VMDisassemblyDumper disasmdump(VMDisassemblyDumper::Overwrite);
+	// We don't know the return type in advance for anonymous functions.
+	FCompileContext ctx(item.CurGlobals, item.Func, item.Func->SymbolName == NAME_None ? nullptr : item.Func->Variants[0].Proto, item.FromDecorate, item.StateIndex, item.StateCount, item.Lump, item.Version);
 
-	for (auto &item : mItems)
+	// Allocate registers for the function's arguments and create local variable nodes before starting to resolve it.
+	item.Builder = new VMFunctionBuilder(item.Func->GetImplicitArgs());
+	VMFunctionBuilder &buildit = *item.Builder;
+	for (unsigned i = 0; i < item.Func->Variants[0].Proto->ArgumentTypes.Size(); i++)
 	{
-		// [Player701] Do not emit code for abstract functions
-		bool isAbstract = item.Func->Variants[0].Implementation->VarFlags & VARF_Abstract;
-		if (isAbstract) continue;
+		auto type = item.Func->Variants[0].Proto->ArgumentTypes[i];
+		auto name = item.Func->Variants[0].ArgNames[i];
+		auto flags = item.Func->Variants[0].ArgFlags[i];
+		// this won't get resolved and won't get emitted. It is only needed so that the code generator can retrieve the necessary info about this argument to do its work.
+		auto local = new FxLocalVariableDeclaration(type, name, nullptr, flags, FScriptPosition());
+		if (!(flags & VARF_Out)) local->RegNum = buildit.Registers[type->GetRegType()].Get(type->GetRegCount());
+		else local->RegNum = buildit.Registers[REGT_POINTER].Get(1);
+		ctx.FunctionArgs.Push(local);
+	}
 
-		assert(item.Code != NULL);
+	FScriptPosition::StrictErrors = !item.FromDecorate || strictdecorate;
+	item.Code = item.Code->Resolve(ctx);
+	// If we need extra space, load the frame pointer into a register so that we do not have to call the wasteful LFP instruction more than once.
+	if (item.Function->ExtraSpace > 0)
+	{
+		buildit.FramePointer = ExpEmit(&buildit, REGT_POINTER);
+		buildit.FramePointer.Fixed = true;
+		buildit.Emit(OP_LFP, buildit.FramePointer.RegNum);
+	}
 
-		// We don't know the return type in advance for anonymous functions.
-		FCompileContext ctx(item.CurGlobals, item.Func, item.Func->SymbolName == NAME_None ? nullptr : item.Func->Variants[0].Proto, item.FromDecorate, item.StateIndex, item.StateCount, item.Lump, item.Version);
+	// Make sure resolving it didn't obliterate it.
+	if (item.Code == nullptr)
+	{
+		return false;
+	}
 
-		// Allocate registers for the function's arguments and create local variable nodes before starting to resolve it.
-		VMFunctionBuilder buildit(item.Func->GetImplicitArgs());
-		for (unsigned i = 0; i < item.Func->Variants[0].Proto->ArgumentTypes.Size(); i++)
+	if (!item.Code->CheckReturn())
+	{
+		auto newcmpd = new FxCompoundStatement(item.Code->ScriptPosition);
+		newcmpd->Add(item.Code);
+		newcmpd->Add(new FxReturnStatement(nullptr, item.Code->ScriptPosition));
+		item.Code = newcmpd->Resolve(ctx);
+	}
+
+	item.Proto = ctx.ReturnProto;
+	if (item.Proto == nullptr)
+	{
+		item.Code->ScriptPosition.Message(MSG_ERROR, "Function %s without prototype", item.PrintableName.GetChars());
+		return false;
+	}
+
+	// Generate prototype for anonymous functions.
+	VMScriptFunction *sfunc = item.Function;
+	// create a new prototype from the now known return type and the argument list of the function's template prototype.
+	if (sfunc->Proto == nullptr)
+	{
+		sfunc->Proto = NewPrototype(item.Proto->ReturnTypes, item.Func->Variants[0].Proto->ArgumentTypes);
+		sfunc->ArgFlags = item.Func->Variants[0].ArgFlags;
+	}
+
+	// NumArgs for the VMFunction must be the amount of stack elements, which can differ from the amount of logical function arguments if vectors are in the list.
+	// For the VM a vector is 2 or 3 args, depending on size.
+	item.NumArgs = 0;
+	auto &funcVariant = item.Func->Variants[0];
+	for (unsigned int i = 0; i < funcVariant.Proto->ArgumentTypes.Size(); i++)
+	{
+		auto argType = funcVariant.Proto->ArgumentTypes[i];
+		auto argFlags = funcVariant.ArgFlags[i];
+		if (argFlags & VARF_Out)
 		{
-			auto type = item.Func->Variants[0].Proto->ArgumentTypes[i];
-			auto name = item.Func->Variants[0].ArgNames[i];
-			auto flags = item.Func->Variants[0].ArgFlags[i];
-			// this won't get resolved and won't get emitted. It is only needed so that the code generator can retrieve the necessary info about this argument to do its work.
-			auto local = new FxLocalVariableDeclaration(type, name, nullptr, flags, FScriptPosition());
-			if (!(flags & VARF_Out)) local->RegNum = buildit.Registers[type->GetRegType()].Get(type->GetRegCount());
-			else local->RegNum = buildit.Registers[REGT_POINTER].Get(1);
-			ctx.FunctionArgs.Push(local);
+			auto argPointer = NewPointer(argType);
+			item.NumArgs += argPointer->GetRegCount();
 		}
-
-		FScriptPosition::StrictErrors = !item.FromDecorate || strictdecorate;
-		item.Code = item.Code->Resolve(ctx);
-		// If we need extra space, load the frame pointer into a register so that we do not have to call the wasteful LFP instruction more than once.
-		if (item.Function->ExtraSpace > 0)
+		else
 		{
-			buildit.FramePointer = ExpEmit(&buildit, REGT_POINTER);
-			buildit.FramePointer.Fixed = true;
-			buildit.Emit(OP_LFP, buildit.FramePointer.RegNum);
+			item.NumArgs += argType->GetRegCount();
 		}
+	}
+	item.Unsafe = ctx.Unsafe;
+	return true;
+}
 
-		// Make sure resolving it didn't obliterate it.
-		if (item.Code != nullptr)
-		{
-			if (!item.Code->CheckReturn())
-			{
-				auto newcmpd = new FxCompoundStatement(item.Code->ScriptPosition);
-				newcmpd->Add(item.Code);
-				newcmpd->Add(new FxReturnStatement(nullptr, item.Code->ScriptPosition));
-				item.Code = newcmpd->Resolve(ctx);
-			}
+//==========================================================================
+//
+// FFunctionBuildList :: Emit
+//
+// Generates the VM code for a resolved function. This only works on data
+// owned by the item, so it may run on any thread. Messages get collected
+// in the item and are printed by the caller.
+//
+//==========================================================================
 
-			item.Proto = ctx.ReturnProto;
-			if (item.Proto == nullptr)
-			{
-				item.Code->ScriptPosition.Message(MSG_ERROR, "Function %s without prototype", item.PrintableName.GetChars());
-				continue;
-			}
+void FFunctionBuildList::Emit(Item &item)
+{
+	VMFunctionBuilder &buildit = *item.Builder;
+	VMScriptFunction *sfunc = item.Function;
 
-			// Generate prototype for anonymous functions.
-			VMScriptFunction *sfunc = item.Function;
-			// create a new prototype from the now known return type and the argument list of the function's template prototype.
-			if (sfunc->Proto == nullptr)
-			{
-				sfunc->Proto = NewPrototype(item.Proto->ReturnTypes, item.Func->Variants[0].Proto->ArgumentTypes);
-				sfunc->ArgFlags = item.Func->Variants[0].ArgFlags;
-			}
+	FScriptPosition::StrictErrors = !item.FromDecorate || strictdecorate;
+	FScriptPosition::MessageBuffer = &item.Messages;
+	try
+	{
+		sfunc->SourceFileName = item.Code->ScriptPosition.FileName.GetChars();	// remember the file name for printing error messages if something goes wrong in the VM.
+		buildit.BeginStatement(item.Code);
+		item.Code->Emit(&buildit);
+		buildit.EndStatement();
+		buildit.MakeFunction(sfunc);
+		sfunc->NumArgs = item.NumArgs;
+		sfunc->Unsafe = item.Unsafe;
+		item.Emitted = true;
+	}
+	catch (CRecoverableError &err)
+	{
+		// catch errors from the code generator and pring something meaningful.
+		item.Code->ScriptPosition.Message(MSG_ERROR, "%s in %s", err.GetMessage(), item.PrintableName.GetChars());
+	}
+	catch (...)
+	{
+		// Anything else must not escape the worker thread. It gets rethrown in order on the main thread.
+		item.Exception = std::current_exception();
+	}
+	FScriptPosition::MessageBuffer = nullptr;
+}
 
-			// Emit code
-			try
-			{
-				sfunc->SourceFileName = item.Code->ScriptPosition.FileName.GetChars();	// remember the file name for printing error messages if something goes wrong in the VM.
-				buildit.BeginStatement(item.Code);
-				item.Code->Emit(&buildit);
-				buildit.EndStatement();
-				buildit.MakeFunction(sfunc);
-				sfunc->NumArgs = 0;
-				// NumArgs for the VMFunction must be the amount of stack elements, which can differ from the amount of logical function arguments if vectors are in the list.
-				// For the VM a vector is 2 or 3 args, depending on size.
-				auto funcVariant = item.Func->Variants[0];
-				for (unsigned int i = 0; i < funcVariant.Proto->ArgumentTypes.Size(); i++)
-				{
-					auto argType = funcVariant.Proto->ArgumentTypes[i];
-					auto argFlags = funcVariant.ArgFlags[i];
-					if (argFlags & VARF_Out)
-					{
-						auto argPointer = NewPointer(argType);
-						sfunc->NumArgs += argPointer->GetRegCount();
-					}
-					else
-					{
-						sfunc->NumArgs += argType->GetRegCount();
-					}
-				}
+//==========================================================================
+//
+// FFunctionBuildList :: Build
+//
+// Resolves all collected functions on the main thread, then generates
+// their code in parallel. The results are merged in the order the
+// functions were added so that output does not depend on scheduling.
+//
+//==========================================================================
 
-				disasmdump.Write(sfunc, item.PrintableName);
+void FFunctionBuildList::Build()
+{
+	VMDisassemblyDumper disasmdump(VMDisassemblyDumper::Overwrite);
+	TArray<Item *> emitlist;
 
-				sfunc->Unsafe = ctx.Unsafe;
-			}
-			catch (CRecoverableError &err)
-			{
-				// catch errors from the code generator and pring something meaningful.
-				item.Code->ScriptPosition.Message(MSG_ERROR, "%s in %s", err.GetMessage(), item.PrintableName.GetChars());
-			}
+	for (auto &item : mItems)
+	{
+		// [Player701] Do not emit code for abstract functions
+		bool isAbstract = item.Func->Variants[0].Implementation->VarFlags & VARF_Abstract;
+		if (isAbstract) continue;
+
+		assert(item.Code != NULL);
+		if (Resolve(item)) emitlist.Push(&item);
+	}
+
+	parallel_for((int)emitlist.Size(), [&](int i)
+	{
+		Emit(*emitlist[i]);
+	});
+
+	for (auto &item : mItems)
+	{
+		if (item.Builder == nullptr) continue;	// abstract
+
+		item.Messages.Flush();
+		if (item.Exception) std::rethrow_exception(item.Exception);
+		if (item.Emitted)
+		{
+			disasmdump.Write(item.Function, item.PrintableName);
 		}
 		delete item.Code;
+		delete item.Builder;
+		item.Builder = nullptr;
 		disasmdump.Flush();
 	}
 	VMFunction::CreateRegUseInfo();
@@ -1072,7 +1145,11 @@ ExpEmit FunctionCallEmitter::EmitCall(VMFunctionBuilder *build, TArray<ExpEmit>
 	{
 		// Pass a hidden type information parameter to vararg functions.
 		// It would really be nicer to actually pass real types but that'd require a far more complex interface on the compiler side than what we have.
-		uint8_t *regbuffer = (uint8_t*)ClassDataAllocator.Alloc(reginfo.Size());	// Allocate in the arena so that the pointer does not need to be maintained.
+		uint8_t *regbuffer;
+		{
+			std::lock_guard<std::mutex> lock(ClassDataAllocatorMutex);
+			regbuffer = (uint8_t*)ClassDataAllocator.Alloc(reginfo.Size());	// Allocate in the arena so that the pointer does not need to be maintained.
+		}
 		memcpy(regbuffer, reginfo.Data(), reginfo.Size());
 		build->Emit(OP_PARAM, REGT_POINTER | REGT_KONST, build->GetConstantAddress(regbuffer));
 		paramcount++;
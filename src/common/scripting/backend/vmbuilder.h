@@ -5,6 +5,8 @@
 #include "vmintern.h"
 #include <vector>
 #include <functional>
+#include <exception>
+#include "sc_man.h"
 
 class VMFunctionBuilder;
 class FxExpression;
@@ -151,10 +153,20 @@ class FFunctionBuildList
 		int Lump;
 		VersionInfo Version;
 		bool FromDecorate;
+
+		// Transient state that is passed from the resolve to the emit pass.
+		VMFunctionBuilder *Builder = nullptr;
+		int NumArgs = 0;
+		bool Unsafe = false;
+		bool Emitted = false;
+		FScriptMessageBuffer Messages;
+		std::exception_ptr Exception;
 	};
 
 	TArray<Item> mItems;
 
+	bool Resolve(Item &item);
+	void Emit(Item &item);
 	void DumpJit();
 
 public:
@@ -2,6 +2,9 @@
 
 #include "vm.h"
 #include "serializer.h"
+#include "c_dispatch.h"
+#include "i_time.h"
+#include "printf.h"
 
 #include <cassert>
 
@@ -216,3 +219,55 @@ DEFINE_ACTION_FUNCTION_NATIVE(_DictionaryIterator, Value, DictIteratorValue)
 	DictIteratorValue(self, &result);
 	ACTION_RETURN_STRING(result);
 }
+
+//=====================================================================================
+//
+// mapbench [count]
+//
+// Compares TMap against TOpenMap with FString keys: inserts
+// count keys, looks each one up, looks up the same number of missing keys
+// and removes everything again.
+//
+//=====================================================================================
+
+template<class MapType>
+static void BenchStringMap(const char *name, const TArray<FString> &keys, const TArray<FString> &missing)
+{
+	MapType map;
+	unsigned found = 0;
+
+	uint64_t t0 = I_nsTime();
+	for (auto &key : keys) map.Insert(key, key);
+	uint64_t t1 = I_nsTime();
+	for (int pass = 0; pass < 10; pass++)
+	{
+		for (auto &key : keys) found += map.CheckKey(key) != nullptr;
+	}
+	uint64_t t2 = I_nsTime();
+	for (int pass = 0; pass < 10; pass++)
+	{
+		for (auto &key : missing) found += map.CheckKey(key) != nullptr;
+	}
+	uint64_t t3 = I_nsTime();
+	for (auto &key : keys) map.Remove(key);
+	uint64_t t4 = I_nsTime();
+
+	double n = keys.Size();
+	Printf("%-8s insert %6.1f  hit %6.1f  miss %6.1f  remove %6.1f ns/op (%u)\n", name,
+		(t1 - t0) / n, (t2 - t1) / (n * 10), (t3 - t2) / (n * 10), (t4 - t3) / n, found);
+}
+
+CCMD(mapbench)
+{
+	int count = argv.argc() > 1 ? (int)strtol(argv[1], nullptr, 0) : 100000;
+	if (count <= 0) return;
+
+	TArray<FString> keys(count, true), missing(count, true);
+	for (int i = 0; i < count; i++)
+	{
+		keys[i].Format("key_%d_%08x", i, i * 2654435761u);
+		missing[i].Format("missing_%d_%08x", i, i * 2246822519u);
+	}
+	BenchStringMap<TMap<FString, FString>>("TMap", keys, missing);
+	BenchStringMap<TOpenMap<FString, FString>>("TOpenMap", keys, missing);
+}
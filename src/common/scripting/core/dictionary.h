@@ -19,6 +19,8 @@ class Dictionary final : public DObject
 
 public:
 
+	// Stays a TMap: DictionaryIterator keeps a Pair pointer between script calls, and TOpenMap moves
+	// entries on every insert and remove.
 	using StringMap = TMap<FString, FString>;
 	using ConstIterator = StringMap::ConstIterator;
 	using ConstPair = StringMap::ConstPair;
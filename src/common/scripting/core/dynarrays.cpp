@@ -33,6 +33,7 @@
 **
 */
 
+#include <algorithm>
 #include "tarray.h"
 #include "dobject.h"
 #include "vm.h"
@@ -143,6 +144,156 @@ template<class T> void ArrayClear(T *self)
 	self->Clear();
 }
 
+//-----------------------------------------------------
+//
+// Sorting and bulk operations
+//
+// Integer arrays are sorted and searched as signed values
+// because the backing types cannot tell int and uint apart.
+//
+//-----------------------------------------------------
+
+// Calls the sorter's virtual compare function for the given element type.
+static int SorterCompare(DObject *sorter, int a, int b)
+{
+	int result = (a > b) - (a < b);
+	IFVIRTUALPTRNAME(sorter, "ArraySorter", CompareInts)
+	{
+		VMValue params[] = { sorter, a, b };
+		VMReturn ret(&result);
+		VMCall(func, params, 3, &ret, 1);
+	}
+	return result;
+}
+
+static int SorterCompare(DObject *sorter, double a, double b)
+{
+	int result = (a > b) - (a < b);
+	IFVIRTUALPTRNAME(sorter, "ArraySorter", CompareDoubles)
+	{
+		VMValue params[] = { sorter, a, b };
+		VMReturn ret(&result);
+		VMCall(func, params, 3, &ret, 1);
+	}
+	return result;
+}
+
+static int SorterCompare(DObject *sorter, const FString &a, const FString &b)
+{
+	int result = a.Compare(b);
+	IFVIRTUALPTRNAME(sorter, "ArraySorter", CompareStrings)
+	{
+		VMValue params[] = { sorter, &a, &b };
+		VMReturn ret(&result);
+		VMCall(func, params, 3, &ret, 1);
+	}
+	return result;
+}
+
+static int SorterCompare(DObject *sorter, DObject *a, DObject *b)
+{
+	int result = 0;
+	IFVIRTUALPTRNAME(sorter, "ArraySorter", CompareObjects)
+	{
+		VMValue params[] = { sorter, a, b };
+		VMReturn ret(&result);
+		VMCall(func, params, 3, &ret, 1);
+	}
+	return result;
+}
+
+// Bottom-up merge sort. Unlike std::sort it cannot run out of bounds if a
+// script comparator is inconsistent, and it keeps equal elements in order.
+template<class T, class Less> static void MergeSort(TArray<T> &array, Less less)
+{
+	unsigned count = array.Size();
+	if (count < 2) return;
+
+	TArray<T> temp(count, true);
+	T *src = array.Data(), *dest = temp.Data();
+	for (unsigned width = 1; width < count; width *= 2)
+	{
+		for (unsigned lo = 0; lo < count; lo += 2 * width)
+		{
+			unsigned mid = std::min(lo + width, count), hi = std::min(lo + 2 * width, count);
+			unsigned i = lo, j = mid, k = lo;
+			while (i < mid && j < hi) dest[k++] = less(src[j], src[i]) ? std::move(src[j++]) : std::move(src[i++]);
+			while (i < mid) dest[k++] = std::move(src[i++]);
+			while (j < hi) dest[k++] = std::move(src[j++]);
+		}
+		std::swap(src, dest);
+	}
+	if (src != array.Data())
+	{
+		array = std::move(temp);
+	}
+}
+
+// K is the type the elements are compared as.
+template<class T, class K> void ArraySort(T *self, DObject *sorter)
+{
+	if (sorter == nullptr)
+	{
+		if constexpr (std::is_pointer<K>::value)
+		{
+			// Objects have no natural order.
+			ThrowAbortException(X_OTHER, "Sorting an object array requires a sorter");
+		}
+		else
+		{
+			std::sort(self->Data(), self->Data() + self->Size(), [](const auto &a, const auto &b) { return static_cast<K>(a) < static_cast<K>(b); });
+		}
+	}
+	else
+	{
+		// The comparator is script code which may change the array, so sort a copy.
+		T work = *self;
+		MergeSort(work, [=](const auto &a, const auto &b) { return SorterCompare(sorter, static_cast<K>(a), static_cast<K>(b)) < 0; });
+		*self = std::move(work);
+	}
+}
+
+template<class T, class K, class U> int ArrayBinarySearch(T *self, U val)
+{
+	typename std::decay<K>::type key = static_cast<K>(static_cast<typename T::value_type>(val));
+	auto first = self->Data(), last = self->Data() + self->Size();
+	auto found = std::lower_bound(first, last, key, [](const auto &a, const auto &b) { return static_cast<K>(a) < b; });
+	return found != last && !(key < static_cast<K>(*found)) ? int(found - first) : int(self->Size());
+}
+
+template<class T, class U> int ArrayRemoveAll(T *self, U val)
+{
+	auto item = static_cast<typename T::value_type>(val);
+	unsigned count = self->Size(), write = 0;
+	for (unsigned read = 0; read < count; read++)
+	{
+		if (!((*self)[read] == item))
+		{
+			if (write != read) (*self)[write] = std::move((*self)[read]);
+			write++;
+		}
+	}
+	self->Resize(write);
+	return int(count - write);
+}
+
+template<class T, class U> void ArrayFill(T *self, U val, unsigned start, int count)
+{
+	auto item = static_cast<typename T::value_type>(val);
+	unsigned first = std::min(start, self->Size());
+	unsigned last = count < 0 ? self->Size() : first + std::min<unsigned>(count, self->Size() - first);
+	for (unsigned i = first; i < last; i++) (*self)[i] = item;
+}
+
+template<class T> void ArrayCopyRange(T *self, T *other, unsigned start, int count)
+{
+	unsigned first = std::min(start, other->Size());
+	unsigned num = count < 0 ? other->Size() - first : std::min<unsigned>(count, other->Size() - first);
+	T range(num, true);
+	for (unsigned i = 0; i < num; i++) range[i] = (*other)[first + i];
+	*self = std::move(range);
+}
+
 // without this the two-argument templates cannot be used in macros.
 #define COMMA ,
 
@@ -257,6 +408,48 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I8, Clear, ArrayClear<FDynArray_I8>)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I8, Sort, ArraySort<FDynArray_I8 COMMA int8_t>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I8);
+	PARAM_OBJECT(sorter, DObject);
+	ArraySort<FDynArray_I8, int8_t>(self, sorter);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I8, BinarySearch, ArrayBinarySearch<FDynArray_I8 COMMA int8_t COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I8);
+	PARAM_INT(val);
+	ACTION_RETURN_INT((ArrayBinarySearch<FDynArray_I8, int8_t>(self, val)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I8, RemoveAll, ArrayRemoveAll<FDynArray_I8 COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I8);
+	PARAM_INT(val);
+	ACTION_RETURN_INT(ArrayRemoveAll(self, val));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I8, Fill, ArrayFill<FDynArray_I8 COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I8);
+	PARAM_INT(val);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayFill(self, val, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I8, CopyRange, ArrayCopyRange<FDynArray_I8>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I8);
+	PARAM_POINTER(other, FDynArray_I8);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayCopyRange(self, other, start, count);
+	return 0;
+}
+
 //-----------------------------------------------------
 //
 // Int16 array
@@ -368,6 +561,48 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I16, Clear, ArrayClear<FDynArray_I16>)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I16, Sort, ArraySort<FDynArray_I16 COMMA int16_t>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I16);
+	PARAM_OBJECT(sorter, DObject);
+	ArraySort<FDynArray_I16, int16_t>(self, sorter);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I16, BinarySearch, ArrayBinarySearch<FDynArray_I16 COMMA int16_t COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I16);
+	PARAM_INT(val);
+	ACTION_RETURN_INT((ArrayBinarySearch<FDynArray_I16, int16_t>(self, val)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I16, RemoveAll, ArrayRemoveAll<FDynArray_I16 COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I16);
+	PARAM_INT(val);
+	ACTION_RETURN_INT(ArrayRemoveAll(self, val));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I16, Fill, ArrayFill<FDynArray_I16 COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I16);
+	PARAM_INT(val);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayFill(self, val, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I16, CopyRange, ArrayCopyRange<FDynArray_I16>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I16);
+	PARAM_POINTER(other, FDynArray_I16);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayCopyRange(self, other, start, count);
+	return 0;
+}
+
 //-----------------------------------------------------
 //
 // Int32 array
@@ -479,6 +714,48 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, Clear, ArrayClear<FDynArray_I32>)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, Sort, ArraySort<FDynArray_I32 COMMA int32_t>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	PARAM_OBJECT(sorter, DObject);
+	ArraySort<FDynArray_I32, int32_t>(self, sorter);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, BinarySearch, ArrayBinarySearch<FDynArray_I32 COMMA int32_t COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	PARAM_INT(val);
+	ACTION_RETURN_INT((ArrayBinarySearch<FDynArray_I32, int32_t>(self, val)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, RemoveAll, ArrayRemoveAll<FDynArray_I32 COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	PARAM_INT(val);
+	ACTION_RETURN_INT(ArrayRemoveAll(self, val));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, Fill, ArrayFill<FDynArray_I32 COMMA int>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	PARAM_INT(val);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayFill(self, val, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_I32, CopyRange, ArrayCopyRange<FDynArray_I32>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_I32);
+	PARAM_POINTER(other, FDynArray_I32);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayCopyRange(self, other, start, count);
+	return 0;
+}
+
 //-----------------------------------------------------
 //
 // Float32 array
@@ -590,6 +867,48 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, Clear, ArrayClear<FDynArray_F32>)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, Sort, ArraySort<FDynArray_F32 COMMA float>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	PARAM_OBJECT(sorter, DObject);
+	ArraySort<FDynArray_F32, float>(self, sorter);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, BinarySearch, ArrayBinarySearch<FDynArray_F32 COMMA float COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	PARAM_FLOAT(val);
+	ACTION_RETURN_INT((ArrayBinarySearch<FDynArray_F32, float>(self, val)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, RemoveAll, ArrayRemoveAll<FDynArray_F32 COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	PARAM_FLOAT(val);
+	ACTION_RETURN_INT(ArrayRemoveAll(self, val));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, Fill, ArrayFill<FDynArray_F32 COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	PARAM_FLOAT(val);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayFill(self, val, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F32, CopyRange, ArrayCopyRange<FDynArray_F32>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F32);
+	PARAM_POINTER(other, FDynArray_F32);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayCopyRange(self, other, start, count);
+	return 0;
+}
+
 //-----------------------------------------------------
 //
 // Float64 array
@@ -701,6 +1020,48 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, Clear, ArrayClear<FDynArray_F64>)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, Sort, ArraySort<FDynArray_F64 COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	PARAM_OBJECT(sorter, DObject);
+	ArraySort<FDynArray_F64, double>(self, sorter);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, BinarySearch, ArrayBinarySearch<FDynArray_F64 COMMA double COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	PARAM_FLOAT(val);
+	ACTION_RETURN_INT((ArrayBinarySearch<FDynArray_F64, double>(self, val)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, RemoveAll, ArrayRemoveAll<FDynArray_F64 COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	PARAM_FLOAT(val);
+	ACTION_RETURN_INT(ArrayRemoveAll(self, val));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, Fill, ArrayFill<FDynArray_F64 COMMA double>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	PARAM_FLOAT(val);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayFill(self, val, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_F64, CopyRange, ArrayCopyRange<FDynArray_F64>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_F64);
+	PARAM_POINTER(other, FDynArray_F64);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayCopyRange(self, other, start, count);
+	return 0;
+}
+
 //-----------------------------------------------------
 //
 // Pointer array
@@ -812,6 +1173,33 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_Ptr, Clear, ArrayClear<FDynArray_Ptr>)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_Ptr, RemoveAll, ArrayRemoveAll<FDynArray_Ptr COMMA void*>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_Ptr);
+	PARAM_POINTER(val, void);
+	ACTION_RETURN_INT(ArrayRemoveAll(self, val));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_Ptr, Fill, ArrayFill<FDynArray_Ptr COMMA void*>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_Ptr);
+	PARAM_POINTER(val, void);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayFill(self, val, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_Ptr, CopyRange, ArrayCopyRange<FDynArray_Ptr>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_Ptr);
+	PARAM_POINTER(other, FDynArray_Ptr);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayCopyRange(self, other, start, count);
+	return 0;
+}
+
 
 //-----------------------------------------------------
 //
@@ -938,6 +1326,47 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_Obj, Clear, ArrayClear<FDynArray_Obj>)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_Obj, Sort, ArraySort<FDynArray_Obj COMMA DObject*>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_Obj);
+	PARAM_OBJECT(sorter, DObject);
+	ArraySort<FDynArray_Obj, DObject*>(self, sorter);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_Obj, RemoveAll, ArrayRemoveAll<FDynArray_Obj COMMA DObject*>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_Obj);
+	PARAM_OBJECT(val, DObject);
+	ACTION_RETURN_INT(ArrayRemoveAll(self, val));
+}
+
+void ObjArrayFill(FDynArray_Obj *self, DObject *obj, unsigned start, int count)
+{
+	GC::WriteBarrier(obj);
+	ArrayFill(self, obj, start, count);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_Obj, Fill, ObjArrayFill)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_Obj);
+	PARAM_OBJECT(val, DObject);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ObjArrayFill(self, val, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_Obj, CopyRange, ArrayCopyRange<FDynArray_Obj>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_Obj);
+	PARAM_POINTER(other, FDynArray_Obj);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayCopyRange(self, other, start, count);
+	return 0;
+}
+
 
 //-----------------------------------------------------
 //
@@ -1050,6 +1479,48 @@ DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_String, Clear, ArrayClear<FDynArray_Stri
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_String, Sort, ArraySort<FDynArray_String COMMA const FString &>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_String);
+	PARAM_OBJECT(sorter, DObject);
+	ArraySort<FDynArray_String, const FString &>(self, sorter);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_String, BinarySearch, ArrayBinarySearch<FDynArray_String COMMA const FString & COMMA const FString &>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_String);
+	PARAM_STRING(val);
+	ACTION_RETURN_INT((ArrayBinarySearch<FDynArray_String, const FString &>(self, val)));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_String, RemoveAll, ArrayRemoveAll<FDynArray_String COMMA const FString &>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_String);
+	PARAM_STRING(val);
+	ACTION_RETURN_INT(ArrayRemoveAll(self, val));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_String, Fill, ArrayFill<FDynArray_String COMMA const FString &>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_String);
+	PARAM_STRING(val);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayFill(self, val, start, count);
+	return 0;
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FDynArray_String, CopyRange, ArrayCopyRange<FDynArray_String>)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FDynArray_String);
+	PARAM_POINTER(other, FDynArray_String);
+	PARAM_UINT(start);
+	PARAM_INT(count);
+	ArrayCopyRange(self, other, start, count);
+	return 0;
+}
+
 DEFINE_FIELD_NAMED_X(DynArray_I8, FArray, Count, Size)		
 DEFINE_FIELD_NAMED_X(DynArray_I16, FArray, Count, Size)		
 DEFINE_FIELD_NAMED_X(DynArray_I32, FArray, Count, Size)		
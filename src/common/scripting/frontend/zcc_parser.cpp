@@ -41,6 +41,9 @@
 #include "zcc_parser.h"
 #include "zcc_compile.h"
 #include "templates.h"
+#include "c_cvars.h"
+#include "md5.h"
+#include "i_specialpaths.h"
 
 TArray<FString> Includes;
 TArray<FScriptPosition> IncludeLocs;
@@ -233,6 +236,299 @@ static void InitTokenMap()
 #undef TOKENDEF
 #undef TOKENDEF2
 
+//**--------------------------------------------------------------------------
+//
+// Token cache
+//
+// Scanning is the part of ZScript parsing that only depends on the text of
+// a lump, so the token stream each lump produced is stored in the cache
+// directory, keyed by an MD5 of the lump's contents and the parse version,
+// and replayed into the parser the next time the lump is unchanged. Names
+// and strings are stored as text and fixed up when loading; everything else
+// is read in one block.
+//
+// This only saves the scanning. Parsing, compiling and building the class
+// tables still run on every start, and DECORATE is not cached at all.
+//
+//**--------------------------------------------------------------------------
+
+CVAR(Bool, zs_tokencache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+enum
+{
+	TOKENCACHE_VERSION = 1,
+
+	TCK_Int = 0,
+	TCK_Float,
+	TCK_String,
+	TCK_Name,
+};
+
+struct FCachedToken
+{
+	int TokenType;
+	int Kind;
+	int SourceLoc;
+	int MessageLine;
+	union
+	{
+		int Int;
+		unsigned Index;		// into FTokenCache::Strings for TCK_String and TCK_Name
+		double Float;
+	};
+};
+
+struct FTokenCache
+{
+	uint8_t Key[16];
+	int EndLine = 0;
+	TArray<FString> Strings;
+	TArray<FCachedToken> Tokens;
+	TMap<FName, unsigned> NameIndices;
+
+	void Add(int tokentype, int kind, const ZCCToken &value, int messageline, const char *text = nullptr, int textlen = 0)
+	{
+		FCachedToken &tok = Tokens[Tokens.Reserve(1)];
+		tok.TokenType = tokentype;
+		tok.Kind = kind;
+		tok.SourceLoc = value.SourceLoc;
+		tok.MessageLine = messageline;
+		switch (kind)
+		{
+		case TCK_Int:
+			tok.Int = value.Int;
+			break;
+
+		case TCK_Float:
+			tok.Float = value.Float;
+			break;
+
+		case TCK_String:
+			tok.Index = Strings.Push(FString(text, textlen));
+			break;
+
+		case TCK_Name:
+		{
+			FName name = ENamedName(value.Int);
+			unsigned *index = NameIndices.CheckKey(name);
+			if (index == nullptr)
+			{
+				index = &NameIndices.Insert(name, Strings.Push(name.GetChars()));
+			}
+			tok.Index = *index;
+			break;
+		}
+		}
+	}
+};
+
+static void GetTokenCacheKey(int lump, const VersionInfo &version, bool baselump, uint8_t key[16])
+{
+	auto data = fileSystem.GetFileData(lump);
+	MD5Context md5;
+	md5.Update(data.Data(), data.Size());
+	md5.Update((const uint8_t *)&version, sizeof(version));
+	md5.Update((const uint8_t *)&baselump, sizeof(baselump));
+	md5.Final(key);
+}
+
+static FString GetTokenCacheName(const uint8_t key[16], bool create)
+{
+	FString path = M_GetCachePath(create);
+	path << "/zscript";
+	if (create) CreatePath(path);
+	path << '/';
+	for (int i = 0; i < 16; i++) path.AppendFormat("%02x", key[i]);
+	path << ".ztc";
+	return path;
+}
+
+// Reads and checks the part of a cache file that must match the running
+// engine. Also used to find stale files when cleaning up the cache.
+static bool ReadTokenCacheHeader(FileReader &fr, uint32_t header[4])
+{
+	char magic[4];
+	FString version = GetVersionString();
+
+	if (fr.Read(magic, 4) != 4 || memcmp(magic, "ZTCH", 4)) return false;
+	if (fr.Read(header, 4 * sizeof(uint32_t)) != (long)(4 * sizeof(uint32_t))) return false;
+	if (header[0] != TOKENCACHE_VERSION || header[1] != version.Len()) return false;
+
+	FString fileversion;
+	bool ok = fr.Read(fileversion.LockNewBuffer(header[1]), (long)header[1]) == (long)header[1];
+	fileversion.UnlockBuffer();
+	return ok && fileversion == version;
+}
+
+// Every count in the file is checked against the bytes that are left before
+// anything gets allocated for it, so a damaged file cannot cause huge allocations.
+static bool ReadTokenCacheData(FileReader &fr, FTokenCache &cache)
+{
+	uint32_t header[4];
+	auto remaining = [&]() { return (size_t)(fr.GetLength() - fr.Tell()); };
+
+	if (!ReadTokenCacheHeader(fr, header)) return false;
+
+	cache.EndLine = header[2];
+	if (header[3] > remaining() / 4) return false;
+	cache.Strings.Resize(header[3]);
+	for (auto &str : cache.Strings)
+	{
+		uint32_t len;
+		if (fr.Read(&len, 4) != 4 || len > remaining()) return false;
+		bool ok = fr.Read(str.LockNewBuffer(len), (long)len) == (long)len;
+		str.UnlockBuffer();
+		if (!ok) return false;
+	}
+
+	uint32_t numtokens;
+	if (fr.Read(&numtokens, 4) != 4) return false;
+	// The token block is the rest of the file.
+	if (numtokens != remaining() / sizeof(FCachedToken) || remaining() % sizeof(FCachedToken) != 0) return false;
+	cache.Tokens.Resize(numtokens);
+	long tokenbytes = (long)remaining();
+	if (fr.Read(cache.Tokens.Data(), tokenbytes) != tokenbytes) return false;
+	for (auto &tok : cache.Tokens)
+	{
+		if ((tok.Kind == TCK_String || tok.Kind == TCK_Name) && tok.Index >= cache.Strings.Size()) return false;
+	}
+	return true;
+}
+
+static bool ReadTokenCache(FTokenCache &cache)
+{
+	FileReader fr;
+	FString path = GetTokenCacheName(cache.Key, false);
+
+	if (!fr.OpenFile(path)) return false;
+	if (!ReadTokenCacheData(fr, cache))
+	{
+		// Whatever is wrong with it, the file is of no further use.
+		fr.Close();
+		remove(path.GetChars());
+		return false;
+	}
+	return true;
+}
+
+//**--------------------------------------------------------------------------
+//
+// Files are named after their key, so a changed lump or engine version
+// writes a new file instead of replacing the old one. Once per session the
+// files that the running engine would reject anyway are deleted.
+//
+//**--------------------------------------------------------------------------
+
+static void CleanTokenCache()
+{
+	static bool cleaned = false;
+	if (cleaned) return;
+	cleaned = true;
+
+	FString dir = M_GetCachePath(false);
+	dir << "/zscript/";
+	TArray<FFileList> files;
+	if (!ScanDirectory(files, dir)) return;
+
+	int removed = 0;
+	for (auto &file : files)
+	{
+		if (file.isDirectory || file.Filename.Right(4).CompareNoCase(".ztc") != 0) continue;
+
+		FileReader fr;
+		uint32_t header[4];
+		if (fr.OpenFile(file.Filename) && !ReadTokenCacheHeader(fr, header))
+		{
+			fr.Close();
+			if (remove(file.Filename.GetChars()) == 0) removed++;
+		}
+	}
+	if (removed > 0)
+	{
+		DPrintf(DMSG_NOTIFY, "Removed %d stale token cache files\n", removed);
+	}
+}
+
+static void WriteTokenCache(FTokenCache &cache)
+{
+	FString path = GetTokenCacheName(cache.Key, true);
+	FileWriter *fw = FileWriter::Open(path);
+	if (fw == nullptr)
+	{
+		DPrintf(DMSG_NOTIFY, "Cannot open token cache file %s for writing\n", path.GetChars());
+		return;
+	}
+
+	FString version = GetVersionString();
+	uint32_t header[4] = { TOKENCACHE_VERSION, (uint32_t)version.Len(), (uint32_t)cache.EndLine, cache.Strings.Size() };
+	bool ok = fw->Write("ZTCH", 4) == 4 &&
+		fw->Write(header, sizeof(header)) == sizeof(header) &&
+		fw->Write(version.GetChars(), version.Len()) == version.Len();
+
+	for (unsigned i = 0; ok && i < cache.Strings.Size(); i++)
+	{
+		uint32_t len = (uint32_t)cache.Strings[i].Len();
+		ok = fw->Write(&len, 4) == 4 && fw->Write(cache.Strings[i].GetChars(), len) == len;
+	}
+	uint32_t numtokens = cache.Tokens.Size();
+	ok = ok && fw->Write(&numtokens, 4) == 4 &&
+		fw->Write(cache.Tokens.Data(), numtokens * sizeof(FCachedToken)) == numtokens * sizeof(FCachedToken);
+	delete fw;
+
+	if (!ok)
+	{
+		DPrintf(DMSG_NOTIFY, "Error saving token cache to %s\n", path.GetChars());
+		remove(path.GetChars());
+	}
+}
+
+static void ReplayTokenCache(FTokenCache &cache, FScanner &sc, void *parser, ZCCParseState &state)
+{
+	ZCCToken value;
+	TArray<int> names(cache.Strings.Size(), true);
+	for (auto &name : names) name = -1;
+
+	// Fixup pass: name indices are only valid for the session that created them.
+	for (auto &tok : cache.Tokens)
+	{
+		if (tok.Kind == TCK_Name && names[tok.Index] < 0)
+		{
+			names[tok.Index] = FName(cache.Strings[tok.Index]).GetIndex();
+		}
+	}
+
+	for (auto &tok : cache.Tokens)
+	{
+		value.Largest = 0;
+		value.SourceLoc = tok.SourceLoc;
+		switch (tok.Kind)
+		{
+		case TCK_Int:
+			value.Int = tok.Int;
+			break;
+
+		case TCK_Float:
+			value.Float = tok.Float;
+			break;
+
+		case TCK_String:
+			// Each string constant gets its own copy, same as when scanning.
+			value.String = state.Strings.Alloc(cache.Strings[tok.Index]);
+			break;
+
+		case TCK_Name:
+			value.Int = names[tok.Index];
+			break;
+		}
+		// The grammar's actions read the current line from the scanner.
+		sc.Line = tok.MessageLine;
+		ZCCParse(parser, tok.TokenType, value, &state);
+	}
+	sc.Line = cache.EndLine;
+	value.Int = -1;
+	ZCCParse(parser, ZCC_EOF, value, &state);
+}
+
 //**--------------------------------------------------------------------------
 
 static void ParseSingleFile(FScanner *pSC, const char *filename, int lump, void *parser, ZCCParseState &state)
@@ -265,15 +561,35 @@ static void ParseSingleFile(FScanner *pSC, const char *filename, int lump, void
 	sc.SetParseVersion(state.ParseVersion);
 	state.sc = &sc;
 
+	FTokenCache cache;
+	bool caching = zs_tokencache && lump >= 0;
+	if (caching)
+	{
+		CleanTokenCache();
+		GetTokenCacheKey(lump, state.ParseVersion, pSC != &lsc, cache.Key);
+		if (ReadTokenCache(cache))
+		{
+			ReplayTokenCache(cache, sc, parser, state);
+			state.sc = nullptr;
+			return;
+		}
+		cache.Strings.Clear();
+		cache.Tokens.Clear();
+	}
+	int errors = FScriptPosition::ErrorCounter, warnings = FScriptPosition::WarnCounter;
+	int kind;
+
 	while (sc.GetToken())
 	{
 		value.Largest = 0;
 		value.SourceLoc = sc.GetMessageLine();
+		kind = TCK_Name;
 		switch (sc.TokenType)
 		{
 		case TK_StringConst:
 			value.String = state.Strings.Alloc(sc.String, sc.StringLen);
 			tokentype = ZCC_STRCONST;
+			kind = TCK_String;
 			break;
 
 		case TK_NameConst:
@@ -284,16 +600,19 @@ static void ParseSingleFile(FScanner *pSC, const char *filename, int lump, void
 		case TK_IntConst:
 			value.Int = sc.Number;
 			tokentype = ZCC_INTCONST;
+			kind = TCK_Int;
 			break;
 
 		case TK_UIntConst:
 			value.Int = sc.Number;
 			tokentype = ZCC_UINTCONST;
+			kind = TCK_Int;
 			break;
 
 		case TK_FloatConst:
 			value.Float = sc.Float;
 			tokentype = ZCC_FLOATCONST;
+			kind = TCK_Float;
 			break;
 
 		case TK_None:	// 'NONE' is a token for SBARINFO but not here.
@@ -336,16 +655,28 @@ static void ParseSingleFile(FScanner *pSC, const char *filename, int lump, void
 			else
 			{
 				sc.ScriptMessage("Unexpected token %s.\n", sc.TokenName(sc.TokenType).GetChars());
+				caching = false;
 				goto parse_end;
 			}
 			break;
 		}
+		if (caching)
+		{
+			cache.Add(tokentype, kind, value, sc.GetMessageLine(), sc.String, sc.StringLen);
+		}
 		ZCCParse(parser, tokentype, value, &state);
 	}
 parse_end:
 	value.Int = -1;
 	ZCCParse(parser, ZCC_EOF, value, &state);
 	state.sc = nullptr;
+
+	// Only clean files get cached, the replay would not repeat the scanner's messages.
+	if (caching && errors == FScriptPosition::ErrorCounter && warnings == FScriptPosition::WarnCounter)
+	{
+		cache.EndLine = sc.Line;
+		WriteTokenCache(cache);
+	}
 }
 
 //**--------------------------------------------------------------------------
@@ -36,6 +36,7 @@
 #ifndef VM_H
 #define VM_H
 
+#include <mutex>
 #include "autosegs.h"
 #include "zstring.h"
 #include "vectors.h"
@@ -50,11 +51,13 @@ union VMOP;
 class VMScriptFunction;
 
 extern FMemArena ClassDataAllocator;
+extern std::mutex ClassDataAllocatorMutex;	// must be held while allocating from ClassDataAllocator during multithreaded code generation.
 
 #define MAX_RETURNS		8	// Maximum number of results a function called by script code can return
 #define MAX_TRY_DEPTH	8	// Maximum number of nested TRYs in a single function
 
 void JitRelease();
+void VMProfileShutdown();
 
 extern void (*VM_CastSpriteIDToString)(FString* a, unsigned int b);
 
@@ -430,6 +433,7 @@ public:
 	void operator delete[](void *block) {}
 	static void DeleteAll()
 	{
+		VMProfileShutdown();
 		for (auto f : AllFunctions)
 		{
 			f->~VMFunction();
@@ -68,6 +68,7 @@ IMPLEMENT_CLASS(VMException, false, false)
 #endif
 
 TArray<VMFunction *> VMFunction::AllFunctions;
+std::mutex ClassDataAllocatorMutex;
 
 // Creates the register type list for a function.
 // Native functions only need this to assert their parameters in debug mode, script functions use this to load their registers from the VMValues.
@@ -160,12 +161,16 @@ void VMScriptFunction::Alloc(int numops, int numkonstd, int numkonstf, int numko
 	assert(numkonsts >= 0 && numkonsts <= 65535);
 	assert(numkonsta >= 0 && numkonsta <= 65535);
 	assert(numlinenumbers >= 0 && numlinenumbers <= 65535);
-	void *mem = ClassDataAllocator.Alloc(numops * sizeof(VMOP) +
+	void *mem;
+	{
+		std::lock_guard<std::mutex> lock(ClassDataAllocatorMutex);
+		mem = ClassDataAllocator.Alloc(numops * sizeof(VMOP) +
 						 numkonstd * sizeof(int) +
 						 numkonstf * sizeof(double) +
 						 numkonsts * sizeof(FString) +
 						 numkonsta * sizeof(FVoidObj) +
 						 numlinenumbers * sizeof(FStatementInfo));
+	}
 	Code = (VMOP *)mem;
 	mem = (void *)((VMOP *)mem + numops);
 
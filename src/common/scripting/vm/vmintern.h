@@ -472,6 +472,7 @@ public:
 	VM_UHALF MaxParam;		// Maximum number of parameters this function has on the stack at once
 	VM_UBYTE NumArgs;		// Number of arguments this function takes
 	TArray<FTypeAndOffset> SpecialInits;	// list of all contents on the extra stack which require construction and destruction
+	int(*ProfiledCall)(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret) = nullptr;	// the real ScriptCall while the profiler is active.
 
 	void InitExtra(void *addr);
 	void DestroyExtra(void *addr);
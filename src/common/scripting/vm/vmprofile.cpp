@@ -0,0 +1,400 @@
+/*
+** vmprofile.cpp
+** Per-function profiler for script code
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 GZDoom contributors
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Every call to a script function, no matter whether it comes from native
+** code, the interpreter or JIT compiled code, goes through the function's
+** ScriptCall pointer. While profiling, this pointer gets redirected to a
+** trampoline that timestamps entry and exit and records the call in a
+** calling context tree. When the profiler is off there is no cost at all.
+**
+*/
+
+#include <algorithm>
+#include "dobject.h"
+#include "v_text.h"
+#include "c_dispatch.h"
+#include "i_time.h"
+#include "vmintern.h"
+#include "types.h"
+#include "printf.h"
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+struct FVMProfileFunction
+{
+	FString Name;
+	uint64_t Calls = 0;
+	uint64_t Inclusive = 0;		// time spent in all outermost activations
+	uint64_t Exclusive = 0;		// time spent in the function itself, excluding called script functions
+	int Active = 0;				// activations currently on the stack, to not count recursion twice for inclusive time
+};
+
+struct FVMProfileEdge
+{
+	int Caller = 0;
+	int Callee = 0;
+	uint64_t Calls = 0;
+	uint64_t Time = 0;
+};
+
+// A node in the calling context tree. The path from the root to a node is the call stack.
+struct FVMProfileNode
+{
+	int Parent;
+	int Function;
+	uint64_t Calls;
+	uint64_t Exclusive;
+};
+
+struct FVMProfileFrame
+{
+	int Node;
+	uint64_t Start;
+	uint64_t ChildTime;
+};
+
+class FVMProfiler
+{
+public:
+	bool Active = false;
+	uint64_t StartTime = 0;
+	uint64_t TotalTime = 0;
+
+	TArray<FVMProfileFunction> Functions;
+	TArray<FVMProfileNode> Nodes;
+	TArray<FVMProfileFrame> Stack;
+	TMap<VMScriptFunction *, int> FunctionIndex;
+	TMap<uint64_t, int> NodeIndex;		// (parent node, function) -> node
+	TMap<uint64_t, FVMProfileEdge> Edges;	// (caller, callee) -> edge
+
+	void Start();
+	void Stop();
+	void Clear();
+
+	int GetFunction(VMScriptFunction *func)
+	{
+		int *pindex = FunctionIndex.CheckKey(func);
+		if (pindex != nullptr) return *pindex;
+		int index = Functions.Reserve(1);
+		Functions[index].Name = func->PrintableName;
+		FunctionIndex.Insert(func, index);
+		return index;
+	}
+
+	int GetNode(int parent, int function)
+	{
+		uint64_t key = (uint64_t(uint32_t(parent)) << 32) | uint32_t(function);
+		int *pindex = NodeIndex.CheckKey(key);
+		if (pindex != nullptr) return *pindex;
+		int index = Nodes.Push({ parent, function, 0, 0 });
+		NodeIndex.Insert(key, index);
+		return index;
+	}
+
+	void Enter(VMScriptFunction *func)
+	{
+		int function = GetFunction(func);
+		int parent = Stack.Size() > 0 ? Stack.Last().Node : -1;
+		int node = GetNode(parent, function);
+		Nodes[node].Calls++;
+		Functions[function].Calls++;
+		Functions[function].Active++;
+		Stack.Push({ node, I_nsTime(), 0 });
+	}
+
+	void Leave()
+	{
+		uint64_t now = I_nsTime();
+		FVMProfileFrame frame;
+		if (!Stack.Pop(frame)) return;	// cleared while running
+
+		uint64_t elapsed = now - frame.Start;
+		uint64_t self = elapsed - std::min(elapsed, frame.ChildTime);
+		auto &node = Nodes[frame.Node];
+		auto &function = Functions[node.Function];
+
+		node.Exclusive += self;
+		function.Exclusive += self;
+		if (--function.Active == 0)
+		{
+			function.Inclusive += elapsed;
+		}
+
+		if (Stack.Size() > 0)
+		{
+			auto &parent = Stack.Last();
+			parent.ChildTime += elapsed;
+
+			int caller = Nodes[parent.Node].Function;
+			uint64_t key = (uint64_t(uint32_t(caller)) << 32) | uint32_t(node.Function);
+			auto &edge = Edges[key];
+			if (edge.Calls == 0)
+			{
+				edge.Caller = caller;
+				edge.Callee = node.Function;
+			}
+			edge.Calls++;
+			edge.Time += elapsed;
+		}
+	}
+
+	void Dump(unsigned limit);
+	bool WriteCollapsed(const char *filename);
+};
+
+static FVMProfiler VMProfiler;
+
+//==========================================================================
+//
+// The trampoline that gets installed as ScriptCall of every script
+// function while the profiler is running.
+//
+//==========================================================================
+
+static int ProfiledScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret)
+{
+	auto sfunc = static_cast<VMScriptFunction *>(func);
+
+	struct FrameGuard
+	{
+		FrameGuard(VMScriptFunction *func) { VMProfiler.Enter(func); }
+		~FrameGuard() { VMProfiler.Leave(); }
+	} guard(sfunc);
+
+	int result = sfunc->ProfiledCall(func, params, numparams, ret, numret);
+
+	// The first call of a function replaces ScriptCall with the interpreter or the JIT entry point.
+	if (VMProfiler.Active && sfunc->ScriptCall != ProfiledScriptCall)
+	{
+		sfunc->ProfiledCall = sfunc->ScriptCall;
+		sfunc->ScriptCall = ProfiledScriptCall;
+	}
+	return result;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FVMProfiler::Start()
+{
+	if (Active) return;
+	for (auto func : VMFunction::AllFunctions)
+	{
+		if (func->VarFlags & VARF_Native) continue;
+		auto sfunc = static_cast<VMScriptFunction *>(func);
+		sfunc->ProfiledCall = sfunc->ScriptCall;
+		sfunc->ScriptCall = ProfiledScriptCall;
+	}
+	StartTime = I_nsTime();
+	Active = true;
+}
+
+void FVMProfiler::Stop()
+{
+	if (!Active) return;
+	for (auto func : VMFunction::AllFunctions)
+	{
+		if (func->VarFlags & VARF_Native) continue;
+		auto sfunc = static_cast<VMScriptFunction *>(func);
+		if (sfunc->ScriptCall == ProfiledScriptCall)
+		{
+			sfunc->ScriptCall = sfunc->ProfiledCall;
+		}
+		sfunc->ProfiledCall = nullptr;
+	}
+	TotalTime += I_nsTime() - StartTime;
+	Active = false;
+}
+
+void FVMProfiler::Clear()
+{
+	bool wasactive = Active;
+	Stop();
+	Functions.Clear();
+	Nodes.Clear();
+	Stack.Clear();
+	FunctionIndex.Clear();
+	NodeIndex.Clear();
+	Edges.Clear();
+	TotalTime = 0;
+	if (wasactive) Start();
+}
+
+//==========================================================================
+//
+// Prints the functions with the highest exclusive time and the most
+// expensive call graph edges.
+//
+//==========================================================================
+
+void FVMProfiler::Dump(unsigned limit)
+{
+	uint64_t total = TotalTime + (Active ? I_nsTime() - StartTime : 0);
+	if (Functions.Size() == 0 || total == 0)
+	{
+		Printf("No profiling data\n");
+		return;
+	}
+
+	TArray<unsigned> order(Functions.Size(), true);
+	for (unsigned i = 0; i < order.Size(); i++) order[i] = i;
+	std::sort(order.begin(), order.end(), [=](unsigned a, unsigned b) { return Functions[a].Exclusive > Functions[b].Exclusive; });
+
+	Printf(TEXTCOLOR_ORANGE "Script functions by exclusive time, %.2f ms profiled:\n", total * 1e-6);
+	Printf(TEXTCOLOR_YELLOW "  Excl ms  Excl %%    Incl ms      Calls  Function\n");
+	Printf(TEXTCOLOR_YELLOW "--------- ------- ---------- ----------  --------\n");
+	for (unsigned i = 0; i < limit && i < order.Size(); i++)
+	{
+		auto &func = Functions[order[i]];
+		Printf("%9.3f %6.2f%% %10.3f %10llu  %s\n", func.Exclusive * 1e-6, func.Exclusive * 100. / total,
+			func.Inclusive * 1e-6, (unsigned long long)func.Calls, func.Name.GetChars());
+	}
+
+	TArray<FVMProfileEdge> edges;
+	TMap<uint64_t, FVMProfileEdge>::Iterator it(Edges);
+	TMap<uint64_t, FVMProfileEdge>::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		edges.Push(pair->Value);
+	}
+	std::sort(edges.begin(), edges.end(), [](const FVMProfileEdge &a, const FVMProfileEdge &b) { return a.Time > b.Time; });
+
+	Printf(TEXTCOLOR_ORANGE "\nMost expensive calls:\n");
+	Printf(TEXTCOLOR_YELLOW "  Time ms      Calls  Caller -> Callee\n");
+	Printf(TEXTCOLOR_YELLOW "--------- ----------  ----------------\n");
+	for (unsigned i = 0; i < limit && i < edges.Size(); i++)
+	{
+		auto &edge = edges[i];
+		Printf("%9.3f %10llu  %s -> %s\n", edge.Time * 1e-6, (unsigned long long)edge.Calls,
+			Functions[edge.Caller].Name.GetChars(), Functions[edge.Callee].Name.GetChars());
+	}
+}
+
+//==========================================================================
+//
+// Writes the calling context tree in the collapsed stack format used by
+// flame graph tools: one line per call path with its exclusive time in
+// microseconds.
+//
+//==========================================================================
+
+bool FVMProfiler::WriteCollapsed(const char *filename)
+{
+	FILE *f = fopen(filename, "w");
+	if (f == nullptr)
+	{
+		return false;
+	}
+
+	TArray<int> path;
+	for (unsigned i = 0; i < Nodes.Size(); i++)
+	{
+		uint64_t usecs = Nodes[i].Exclusive / 1000;
+		if (usecs == 0) continue;
+
+		path.Clear();
+		for (int node = i; node >= 0; node = Nodes[node].Parent)
+		{
+			path.Push(Nodes[node].Function);
+		}
+		for (int j = path.Size() - 1; j >= 0; j--)
+		{
+			fprintf(f, j > 0 ? "%s;" : "%s", Functions[path[j]].Name.GetChars());
+		}
+		fprintf(f, " %llu\n", (unsigned long long)usecs);
+	}
+	fclose(f);
+	return true;
+}
+
+//==========================================================================
+//
+// Needs to be called before the script functions get deleted.
+//
+//==========================================================================
+
+void VMProfileShutdown()
+{
+	VMProfiler.Stop();
+	VMProfiler.Clear();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+CCMD(vmprofile)
+{
+	if (argv.argc() >= 2)
+	{
+		if (stricmp(argv[1], "start") == 0)
+		{
+			VMProfiler.Start();
+			return;
+		}
+		else if (stricmp(argv[1], "stop") == 0)
+		{
+			VMProfiler.Stop();
+			return;
+		}
+		else if (stricmp(argv[1], "clear") == 0)
+		{
+			VMProfiler.Clear();
+			return;
+		}
+		else if (stricmp(argv[1], "dump") == 0)
+		{
+			VMProfiler.Dump(argv.argc() >= 3 ? (unsigned)atoi(argv[2]) : 20);
+			return;
+		}
+		else if (stricmp(argv[1], "collapsed") == 0 && argv.argc() >= 3)
+		{
+			if (!VMProfiler.WriteCollapsed(argv[2]))
+			{
+				Printf("Unable to write %s\n", argv[2]);
+			}
+			return;
+		}
+	}
+	Printf("Usage: vmprofile start|stop|clear\n");
+	Printf("       vmprofile dump [<limit>]\n");
+	Printf("       vmprofile collapsed <filename>\n");
+}
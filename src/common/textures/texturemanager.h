@@ -193,7 +193,7 @@ private:
 	TArray<int> Translation;
 
 	TMap<FName, TextureManipulation> tmanips;
-	TMap<FName, int> aliases;
+	TOpenMap<FName, int> aliases;
 
 public:
 
@@ -116,6 +116,7 @@ void FArgs::SetArgs(int argc, char **argv)
 	for (int i = 0; i < argc; ++i)
 	{
 		Argv[i] = argv[i];
+		Argv[i].MoveToHeap();
 	}
 }
 
@@ -322,6 +323,7 @@ int FArgs::NumArgs() const
 
 void FArgs::AppendArg(FString arg)
 {
+	arg.MoveToHeap();
 	Argv.Push(arg);
 }
 
@@ -341,6 +343,7 @@ void FArgs::AppendArgs(int argc, const FString *argv)
 		for (int i = 0; i < argc; ++i)
 		{
 			Argv.Push(argv[i]);
+			Argv.Last().MoveToHeap();
 		}
 	}
 }
@@ -429,7 +432,7 @@ void FArgs::CollectFiles(const char *finalname, const char **param, const char *
 	// Step 3: Add work back to Argv, as long as it's non-empty.
 	if (work.Size() > 0)
 	{
-		Argv.Push(finalname);
+		AppendArg(finalname);
 		AppendArgs(work.Size(), &work[0]);
 	}
 }
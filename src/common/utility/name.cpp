@@ -33,6 +33,8 @@
 */
 
 #include <string.h>
+#include <mutex>
+#include <new>
 #include "name.h"
 #include "superfasthash.h"
 #include "cmdlib.h"
@@ -45,8 +47,9 @@
 // that is just large enough to hold it.
 #define BLOCK_SIZE			4096
 
-// How many entries to grow the NameArray by when it needs to grow.
-#define NAME_GROW_AMOUNT	256
+// Initial number of hash table slots. Must be a power of 2. The table is
+// replaced by one twice as large when it becomes half full.
+#define INITIAL_HASH_SIZE	4096
 
 // TYPES -------------------------------------------------------------------
 
@@ -60,6 +63,32 @@ struct FName::NameManager::NameBlock
 	NameBlock *NextBlock;
 };
 
+// The hash table is open addressed and only ever has name indices added to
+// it, so readers can probe it while a name is being inserted. When it needs
+// to grow, a new table is built and published, and the old one is kept
+// until shutdown in case some thread is still looking at it.
+
+struct FName::NameManager::HashTable
+{
+	unsigned int Mask;
+	HashTable *Prev;
+
+	std::atomic<int> *Slots() { return (std::atomic<int> *)(this + 1); }
+	const std::atomic<int> *Slots() const { return (const std::atomic<int> *)(this + 1); }
+
+	static HashTable *Alloc(unsigned int size, HashTable *prev)
+	{
+		HashTable *table = (HashTable *)M_Malloc(sizeof(HashTable) + size * sizeof(std::atomic<int>));
+		table->Mask = size - 1;
+		table->Prev = prev;
+		for (unsigned int i = 0; i < size; ++i)
+		{
+			new (&table->Slots()[i]) std::atomic<int>(-1);
+		}
+		return table;
+	}
+};
+
 // PRIVATE FUNCTION PROTOTYPES ---------------------------------------------
 
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
@@ -69,6 +98,10 @@ struct FName::NameManager::NameBlock
 FName::NameManager FName::NameData;
 bool FName::NameManager::Inited;
 
+// Serializes adding names. std::mutex is constant-initialized, so this is
+// usable by FNames constructed during static initialization.
+static std::mutex NameMutex;
+
 // Define the predefined names.
 static const char *PredefinedNames[] =
 {
@@ -93,37 +126,11 @@ static const char *PredefinedNames[] =
 
 int FName::NameManager::FindName (const char *text, bool noCreate)
 {
-	if (!Inited)
-	{
-		InitBuckets ();
-	}
-
 	if (text == NULL)
 	{
 		return 0;
 	}
-
-	unsigned int hash = MakeKey (text);
-	unsigned int bucket = hash % HASH_SIZE;
-	int scanner = Buckets[bucket];
-
-	// See if the name already exists.
-	while (scanner >= 0)
-	{
-		if (NameArray[scanner].Hash == hash && stricmp (NameArray[scanner].Text, text) == 0)
-		{
-			return scanner;
-		}
-		scanner = NameArray[scanner].NextHash;
-	}
-
-	// If we get here, then the name does not exist.
-	if (noCreate)
-	{
-		return 0;
-	}
-
-	return AddName (text, hash, bucket);
+	return FindName (text, strlen (text), noCreate);
 }
 
 //==========================================================================
@@ -135,6 +142,8 @@ int FName::NameManager::FindName (const char *text, bool noCreate)
 
 int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreate)
 {
+	// This is first called during static initialization, before there are
+	// any other threads.
 	if (!Inited)
 	{
 		InitBuckets ();
@@ -146,19 +155,11 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 	}
 
 	unsigned int hash = MakeKey (text, textLen);
-	unsigned int bucket = hash % HASH_SIZE;
-	int scanner = Buckets[bucket];
+	int index = LookupName (text, textLen, hash);
 
-	// See if the name already exists.
-	while (scanner >= 0)
+	if (index >= 0)
 	{
-		if (NameArray[scanner].Hash == hash &&
-			strnicmp (NameArray[scanner].Text, text, textLen) == 0 &&
-			NameArray[scanner].Text[textLen] == '\0')
-		{
-			return scanner;
-		}
-		scanner = NameArray[scanner].NextHash;
+		return index;
 	}
 
 	// If we get here, then the name does not exist.
@@ -167,7 +168,38 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 		return 0;
 	}
 
-	return AddName (text, hash, bucket);
+	return AddName (text, textLen, hash);
+}
+
+//==========================================================================
+//
+// FName :: NameManager :: LookupName
+//
+// Searches the current hash table without locking. Returns -1 if the name
+// is not in it.
+//
+//==========================================================================
+
+int FName::NameManager::LookupName (const char *text, size_t textLen, unsigned int hash) const
+{
+	const HashTable *table = Table.load (std::memory_order_acquire);
+	const std::atomic<int> *slots = table->Slots();
+
+	for (unsigned int i = hash & table->Mask; ; i = (i + 1) & table->Mask)
+	{
+		int index = slots[i].load (std::memory_order_acquire);
+		if (index < 0)
+		{
+			return -1;
+		}
+		const NameEntry &entry = Entry (index);
+		if (entry.Hash == hash &&
+			strnicmp (entry.Text, text, textLen) == 0 &&
+			entry.Text[textLen] == '\0')
+		{
+			return index;
+		}
+	}
 }
 
 //==========================================================================
@@ -181,7 +213,7 @@ int FName::NameManager::FindName (const char *text, size_t textLen, bool noCreat
 void FName::NameManager::InitBuckets ()
 {
 	Inited = true;
-	memset (Buckets, -1, sizeof(Buckets));
+	Table.store (HashTable::Alloc (INITIAL_HASH_SIZE, nullptr), std::memory_order_release);
 
 	// Register built-in names. 'None' must be name 0.
 	for (size_t i = 0; i < countof(PredefinedNames); ++i)
@@ -195,15 +227,26 @@ void FName::NameManager::InitBuckets ()
 //
 // FName :: NameManager :: AddName
 //
-// Adds a new name to the name table.
+// Adds a new name to the name table. The entry is completely set up before
+// its index is stored in the hash table, so other threads never see a
+// partial name.
 //
 //==========================================================================
 
-int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned int bucket)
+int FName::NameManager::AddName (const char *text, size_t textLen, unsigned int hash)
 {
+	std::lock_guard<std::mutex> lock (NameMutex);
+
+	// Somebody else may have added it while we were waiting for the lock.
+	int index = LookupName (text, textLen, hash);
+	if (index >= 0)
+	{
+		return index;
+	}
+
 	char *textstore;
 	NameBlock *block = Blocks;
-	size_t len = strlen (text) + 1;
+	size_t len = textLen + 1;
 
 	// Get a block large enough for the name. Only the first block in the
 	// list is ever considered for name storage.
@@ -214,25 +257,76 @@ int FName::NameManager::AddName (const char *text, unsigned int hash, unsigned i
 
 	// Copy the string into the block.
 	textstore = (char *)block + block->NextAlloc;
-	strcpy (textstore, text);
+	memcpy (textstore, text, textLen);
+	textstore[textLen] = '\0';
 	block->NextAlloc += len;
 
-	// Add an entry for the name to the NameArray
-	if (NumNames >= MaxNames)
+	// Add an entry for the name. Chunks are never reallocated, so entries
+	// stay where they are while other threads read them.
+	index = NumNames.load (std::memory_order_relaxed);
+	int chunk = index >> CHUNK_SHIFT;
+	assert (chunk < MAX_CHUNKS);
+	if (Chunks[chunk] == NULL)
 	{
-		// If no names have been defined yet, make the first allocation
-		// large enough to hold all the predefined names.
-		MaxNames += MaxNames == 0 ? countof(PredefinedNames) + NAME_GROW_AMOUNT : NAME_GROW_AMOUNT;
+		Chunks[chunk] = (NameEntry *)M_Malloc (CHUNK_SIZE * sizeof(NameEntry));
+	}
+	NameEntry &entry = Chunks[chunk][index & (CHUNK_SIZE - 1)];
+	entry.Text = textstore;
+	entry.Hash = hash;
+
+	HashTable *table = Table.load (std::memory_order_relaxed);
+	if ((unsigned)(index + 1) * 2 > table->Mask + 1)
+	{
+		GrowTable ();
+		table = Table.load (std::memory_order_relaxed);
+	}
+	InsertHash (table, index);
+	NumNames.store (index + 1, std::memory_order_release);
+
+	return index;
+}
+
+//==========================================================================
+//
+// FName :: NameManager :: InsertHash
+//
+// Publishes a name's index in a hash table. Must be called with the lock
+// held.
+//
+//==========================================================================
 
-		NameArray = (NameEntry *)M_Realloc (NameArray, MaxNames * sizeof(NameEntry));
+void FName::NameManager::InsertHash (HashTable *table, int index)
+{
+	std::atomic<int> *slots = table->Slots();
+	unsigned int i = Entry (index).Hash & table->Mask;
+
+	while (slots[i].load (std::memory_order_relaxed) >= 0)
+	{
+		i = (i + 1) & table->Mask;
 	}
+	slots[i].store (index, std::memory_order_release);
+}
+
+//==========================================================================
+//
+// FName :: NameManager :: GrowTable
+//
+// Builds a hash table twice the current size and publishes it. Must be
+// called with the lock held.
+//
+//==========================================================================
 
-	NameArray[NumNames].Text = textstore;
-	NameArray[NumNames].Hash = hash;
-	NameArray[NumNames].NextHash = Buckets[bucket];
-	Buckets[bucket] = NumNames;
+void FName::NameManager::GrowTable ()
+{
+	HashTable *old = Table.load (std::memory_order_relaxed);
+	HashTable *table = HashTable::Alloc ((old->Mask + 1) * 2, old);
+	int count = NumNames.load (std::memory_order_relaxed);
 
-	return NumNames++;
+	for (int i = 0; i < count; ++i)
+	{
+		InsertHash (table, i);
+	}
+	Table.store (table, std::memory_order_release);
 }
 
 //==========================================================================
@@ -271,6 +365,7 @@ FName::NameManager::NameBlock *FName::NameManager::AddBlock (size_t len)
 FName::NameManager::~NameManager()
 {
 	NameBlock *block, *next;
+	HashTable *table, *prev;
 
 	//C_ClearTabCommands();
 
@@ -281,11 +376,21 @@ FName::NameManager::~NameManager()
 	}
 	Blocks = NULL;
 
-	if (NameArray != NULL)
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		if (Chunks[i] != NULL)
+		{
+			M_Free (Chunks[i]);
+			Chunks[i] = NULL;
+		}
+	}
+
+	for (table = Table.load(); table != NULL; table = prev)
 	{
-		M_Free (NameArray);
-		NameArray = NULL;
+		prev = table->Prev;
+		M_Free (table);
 	}
-	NumNames = MaxNames = 0;
-	memset (Buckets, -1, sizeof(Buckets));
+	Table = NULL;
+	NumNames = 0;
+	Inited = false;
 }
@@ -34,6 +34,7 @@
 #ifndef NAME_H
 #define NAME_H
 
+#include <atomic>
 #include "tarray.h"
 #include "zstring.h"
 
@@ -62,7 +63,7 @@ public:
  //   ~FName () {}	// Names can be added but never removed.
 
 	int GetIndex() const { return Index; }
-	const char *GetChars() const { return NameData.NameArray[Index].Text; }
+	const char *GetChars() const { return NameData.Entry(Index).Text; }
 
 	FName &operator = (const char *text) { Index = NameData.FindName (text, false); return *this; }
 	FName& operator = (const FString& text) { Index = NameData.FindName(text.GetChars(), text.Len(), false); return *this; }
@@ -71,7 +72,7 @@ public:
 
 	int SetName (const char *text, bool noCreate=false) { return Index = NameData.FindName (text, noCreate); }
 
-	bool IsValidName() const { return (unsigned)Index < (unsigned)NameData.NumNames; }
+	bool IsValidName() const { return (unsigned)Index < (unsigned)NameData.NumNames.load(std::memory_order_acquire); }
 
 	// Note that the comparison operators compare the names' indices, not
 	// their text, so they cannot be used to do a lexicographical sort.
@@ -96,9 +97,11 @@ protected:
 	{
 		char *Text;
 		unsigned int Hash;
-		int NextHash;
 	};
 
+	// Looking up names is lock-free and may be done from any thread. Adding
+	// a name takes a lock. Entries and their text never move once they have
+	// been published, and the hash table is replaced instead of resized.
 	struct NameManager
 	{
 		// No constructor because we can't ensure that it actually gets
@@ -106,18 +109,29 @@ protected:
 		// means this struct must only exist in the program's BSS section.
 		~NameManager();
 
-		enum { HASH_SIZE = 1024 };
+		enum
+		{
+			CHUNK_SHIFT = 12,
+			CHUNK_SIZE = 1 << CHUNK_SHIFT,
+			MAX_CHUNKS = 4096
+		};
 		struct NameBlock;
+		struct HashTable;
 
 		NameBlock *Blocks;
-		NameEntry *NameArray;
-		int NumNames, MaxNames;
-		int Buckets[HASH_SIZE];
+		NameEntry *Chunks[MAX_CHUNKS];
+		std::atomic<int> NumNames;
+		std::atomic<HashTable *> Table;
+
+		const NameEntry &Entry(int index) const { return Chunks[index >> CHUNK_SHIFT][index & (CHUNK_SIZE - 1)]; }
 
 		int FindName (const char *text, bool noCreate);
 		int FindName (const char *text, size_t textlen, bool noCreate);
-		int AddName (const char *text, unsigned int hash, unsigned int bucket);
+		int LookupName (const char *text, size_t textlen, unsigned int hash) const;
+		int AddName (const char *text, size_t textlen, unsigned int hash);
 		NameBlock *AddBlock (size_t len);
+		void InsertHash (HashTable *table, int index);
+		void GrowTable ();
 		void InitBuckets ();
 		static bool Inited;
 	};
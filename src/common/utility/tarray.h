@@ -1367,6 +1367,464 @@ protected:
 	hash_t Position;
 };
 
+// TOpenMap -----------------------------------------------------------------
+// A drop-in alternative to TMap for hot lookup tables.
+//
+// TMap chains colliding nodes through Next pointers and rehashes the key on
+// every probe, so a miss on a string-keyed map can cost several full key
+// comparisons scattered across the node array. TOpenMap instead uses linear
+// probing with Robin Hood ordering: every slot stores the full hash of its
+// key, probe sequences are contiguous in memory, and a lookup stops as soon
+// as it reaches a slot that is closer to its home position than the key
+// being searched for would be. Keys are only compared when the stored hashes
+// match.
+//
+// The interface is the same as TMap's, including iteration with
+// TMapIterator/TMapConstIterator. Like TMap, nodes are relocated with a
+// bit-wise copy, so keys and values must not hold pointers to themselves.
+//
+// Unlike TMap, entries move on every Insert and Remove, not only when the
+// table grows. Pointers returned by CheckKey, operator[] and the iterators
+// are only valid until the next change to the map, and removing entries
+// while iterating may skip or repeat some. Only use it where no such
+// pointer is kept across a change.
+
+template<class KT, class VT, class HashTraits=THashTraits<KT>, class ValueTraits=TValueTraits<VT> >
+class TOpenMap
+{
+	template<class KTa, class VTa, class MTa> friend class TMapIterator;
+	template<class KTb, class VTb, class MTb> friend class TMapConstIterator;
+
+public:
+	typedef class TOpenMap<KT, VT, HashTraits, ValueTraits> MyType;
+	typedef class TMapIterator<KT, VT, MyType> Iterator;
+	typedef class TMapConstIterator<KT, VT, MyType> ConstIterator;
+	typedef struct { const KT Key; VT Value; } Pair;
+	typedef const Pair ConstPair;
+
+	TOpenMap() { NumUsed = 0; SetNodeVector(1); }
+	TOpenMap(hash_t size) { NumUsed = 0; SetNodeVector(size); }
+	~TOpenMap() { ClearNodeVector(); }
+
+	TOpenMap(const TOpenMap &o)
+	{
+		NumUsed = 0;
+		SetNodeVector(o.CountUsed());
+		CopyNodes(o.Nodes, o.Size);
+	}
+
+	TOpenMap &operator= (const TOpenMap &o)
+	{
+		if (&o != this)
+		{
+			ClearNodeVector();
+			SetNodeVector(o.CountUsed());
+			CopyNodes(o.Nodes, o.Size);
+		}
+		return *this;
+	}
+
+	//=======================================================================
+	//
+	// TransferFrom
+	//
+	// Moves the contents from one TOpenMap to another, leaving the map
+	// moved from empty.
+	//
+	//=======================================================================
+
+	void TransferFrom(TOpenMap &o)
+	{
+		ClearNodeVector();
+
+		Nodes = o.Nodes;
+		Size = o.Size;
+		NumUsed = o.NumUsed;
+
+		o.Nodes = NULL;
+		o.Size = 0;
+		o.NumUsed = 0;
+		o.SetNodeVector(1);
+	}
+
+	//=======================================================================
+	//
+	// Clear
+	//
+	// Empties out the table and resizes it with room for count entries.
+	//
+	//=======================================================================
+
+	void Clear(hash_t count=1)
+	{
+		ClearNodeVector();
+		SetNodeVector(count);
+	}
+
+	//=======================================================================
+	//
+	// CountUsed
+	//
+	// Returns the number of entries in use in the table.
+	//
+	//=======================================================================
+
+	hash_t CountUsed() const
+	{
+#ifdef _DEBUG
+		hash_t used = 0;
+		for (hash_t i = 0; i < Size; ++i)
+		{
+			if (!Nodes[i].IsNil())
+			{
+				++used;
+			}
+		}
+		assert (used == NumUsed);
+#endif
+		return NumUsed;
+	}
+
+	//=======================================================================
+	//
+	// operator[]
+	//
+	// Returns a reference to the value associated with a particular key,
+	// creating the pair if the key isn't already in the table.
+	//
+	//=======================================================================
+
+	VT &operator[] (const KT key)
+	{
+		return GetNode(key)->Pair.Value;
+	}
+
+	//=======================================================================
+	//
+	// CheckKey
+	//
+	// Returns a pointer to the value associated with a particular key, or
+	// NULL if the key isn't in the table.
+	//
+	//=======================================================================
+
+	VT *CheckKey (const KT key)
+	{
+		Node *n = FindKey(key, HashKey(key));
+		return n != NULL ? &n->Pair.Value : NULL;
+	}
+
+	const VT *CheckKey (const KT key) const
+	{
+		const Node *n = FindKey(key, HashKey(key));
+		return n != NULL ? &n->Pair.Value : NULL;
+	}
+
+	//=======================================================================
+	//
+	// Insert
+	//
+	// Adds a key/value pair to the table if key isn't in the table, or
+	// replaces the value for the existing pair if the key is in the table.
+	//
+	//=======================================================================
+
+	VT &Insert(const KT key, const VT &value)
+	{
+		hash_t hash = HashKey(key);
+		Node *n = FindKey(key, hash);
+		if (n != NULL)
+		{
+			n->Pair.Value = value;
+		}
+		else
+		{
+			n = NewKey(key, hash);
+			::new(&n->Pair.Value) VT(value);
+		}
+		return n->Pair.Value;
+	}
+
+	VT &Insert(const KT key, VT &&value)
+	{
+		hash_t hash = HashKey(key);
+		Node *n = FindKey(key, hash);
+		if (n != NULL)
+		{
+			n->Pair.Value = std::move(value);
+		}
+		else
+		{
+			n = NewKey(key, hash);
+			::new(&n->Pair.Value) VT(std::move(value));
+		}
+		return n->Pair.Value;
+	}
+
+	VT &InsertNew(const KT key)
+	{
+		hash_t hash = HashKey(key);
+		Node *n = FindKey(key, hash);
+		if (n != NULL)
+		{
+			n->Pair.Value.~VT();
+		}
+		else
+		{
+			n = NewKey(key, hash);
+		}
+		::new(&n->Pair.Value) VT;
+		return n->Pair.Value;
+	}
+
+	//=======================================================================
+	//
+	// Remove
+	//
+	// Removes the key/value pair for a particular key if it is in the table.
+	//
+	//=======================================================================
+
+	void Remove(const KT key)
+	{
+		DelKey(key);
+	}
+
+	void Swap(MyType &other)
+	{
+		std::swap(Nodes, other.Nodes);
+		std::swap(Size, other.Size);
+		std::swap(NumUsed, other.NumUsed);
+	}
+
+protected:
+	struct IPair	// This must be the same as Pair above, but with a
+	{				// non-const Key.
+		KT Key;
+		VT Value;
+	};
+	struct Node
+	{
+		hash_t Hash;	// 0 marks an empty slot; see HashKey.
+		IPair Pair;
+		void SetNil()
+		{
+			Hash = 0;
+		}
+		bool IsNil() const
+		{
+			return Hash == 0;
+		}
+	};
+
+	struct NodeSizedStruct { unsigned char Pads[sizeof(Node)]; };
+
+	Node *Nodes;
+	hash_t Size;		/* must be a power of 2 */
+	hash_t NumUsed;
+
+	/* Hash value 0 is reserved for empty slots. */
+	static hash_t HashKey(const KT key)
+	{
+		HashTraits Traits;
+		hash_t hash = Traits.Hash(key);
+		return hash != 0 ? hash : 1;
+	}
+
+	/* How far a node with this hash sits from its home slot when stored at pos. */
+	hash_t ProbeDistance(hash_t hash, hash_t pos) const
+	{
+		return (pos - hash) & (Size - 1);
+	}
+
+	void SetNodeVector(hash_t size)
+	{
+		// Round size up to nearest power of 2, keeping the load factor at
+		// or below 3/4 for the requested number of entries.
+		size += size / 3;
+		for (Size = 2; Size < size; Size <<= 1)
+		{ }
+		Nodes = (Node *)M_Malloc(Size * sizeof(Node));
+		for (hash_t i = 0; i < Size; ++i)
+		{
+			Nodes[i].SetNil();
+		}
+	}
+
+	void ClearNodeVector()
+	{
+		for (hash_t i = 0; i < Size; ++i)
+		{
+			if (!Nodes[i].IsNil())
+			{
+				Nodes[i].~Node();
+			}
+		}
+		M_Free(Nodes);
+		Nodes = NULL;
+		Size = 0;
+		NumUsed = 0;
+	}
+
+	void Resize(hash_t nhsize)
+	{
+		hash_t oldhsize = Size, oldused = NumUsed;
+		Node *nold = Nodes;
+		Nodes = (Node *)M_Malloc(nhsize * sizeof(Node));
+		Size = nhsize;
+		for (hash_t i = 0; i < Size; ++i)
+		{
+			Nodes[i].SetNil();
+		}
+		/* relocate the old nodes; their stored hashes do not need recomputing */
+		NumUsed = 0;
+		for (hash_t i = 0; i < oldhsize; ++i)
+		{
+			if (!nold[i].IsNil())
+			{
+				Node *n = PlaceNode(nold[i].Hash);
+				CopyNode(n, &nold[i]);
+			}
+		}
+		assert(NumUsed == oldused);
+		M_Free(nold);
+	}
+
+	/*
+	** Finds the slot for a new node with the given hash and marks it as used.
+	** Nodes in a run are kept ordered by their home slot, so if the new node
+	** belongs in front of an existing one, the rest of the run is shifted up
+	** by one slot to make room.
+	*/
+	Node *PlaceNode(hash_t hash)
+	{
+		const hash_t mask = Size - 1;
+		hash_t pos = hash & mask;
+		for (hash_t dist = 0; !Nodes[pos].IsNil(); pos = (pos + 1) & mask, ++dist)
+		{
+			if (ProbeDistance(Nodes[pos].Hash, pos) < dist)
+			{
+				/* find the end of the run and shift everything up to it */
+				hash_t end = pos;
+				while (!Nodes[end].IsNil())
+				{
+					end = (end + 1) & mask;
+				}
+				while (end != pos)
+				{
+					hash_t prev = (end - 1) & mask;
+					CopyNode(&Nodes[end], &Nodes[prev]);
+					end = prev;
+				}
+				break;
+			}
+		}
+		Nodes[pos].Hash = hash;
+		++NumUsed;
+		return &Nodes[pos];
+	}
+
+	/*
+	** Inserts a new key into the hash table. The key must not already be
+	** present. The Value field is left unconstructed.
+	*/
+	Node *NewKey(const KT key, hash_t hash)
+	{
+		if ((NumUsed + 1) * 4 > Size * 3)
+		{
+			Resize(Size << 1);
+		}
+		Node *mp = PlaceNode(hash);
+		::new(&mp->Pair.Key) KT(key);
+		return mp;
+	}
+
+	/*
+	** Removes a key by shifting the rest of its run back by one slot, so
+	** that no tombstones are needed.
+	*/
+	void DelKey(const KT key)
+	{
+		Node *mp = FindKey(key, HashKey(key));
+		if (mp == NULL)
+		{
+			return;
+		}
+		const hash_t mask = Size - 1;
+		hash_t pos = hash_t(mp - Nodes);
+		mp->~Node();
+		for (;;)
+		{
+			hash_t next = (pos + 1) & mask;
+			if (Nodes[next].IsNil() || ProbeDistance(Nodes[next].Hash, next) == 0)
+			{
+				break;
+			}
+			CopyNode(&Nodes[pos], &Nodes[next]);
+			pos = next;
+		}
+		Nodes[pos].SetNil();
+		--NumUsed;
+	}
+
+	Node *FindKey(const KT key, hash_t hash)
+	{
+		return const_cast<Node *>(const_cast<const TOpenMap *>(this)->FindKey(key, hash));
+	}
+
+	const Node *FindKey(const KT key, hash_t hash) const
+	{
+		HashTraits Traits;
+		const hash_t mask = Size - 1;
+		hash_t pos = hash & mask;
+		for (hash_t dist = 0; ; pos = (pos + 1) & mask, ++dist)
+		{
+			const Node *n = &Nodes[pos];
+			if (n->IsNil() || ProbeDistance(n->Hash, pos) < dist)
+			{
+				return NULL;
+			}
+			if (n->Hash == hash && !Traits.Compare(n->Pair.Key, key))
+			{
+				return n;
+			}
+		}
+	}
+
+	Node *GetNode(const KT key)
+	{
+		hash_t hash = HashKey(key);
+		Node *n = FindKey(key, hash);
+		if (n != NULL)
+		{
+			return n;
+		}
+		n = NewKey(key, hash);
+		ValueTraits traits;
+		traits.Init(n->Pair.Value);
+		return n;
+	}
+
+	/* Perform a bit-wise copy of the node. Used when relocating a node in the table. */
+	void CopyNode(Node *dst, const Node *src)
+	{
+		*(NodeSizedStruct *)dst = *(const NodeSizedStruct *)src;
+	}
+
+	/* Copy all nodes in the node vector to this table. */
+	void CopyNodes(const Node *nodes, hash_t numnodes)
+	{
+		for (; numnodes-- > 0; ++nodes)
+		{
+			if (!nodes->IsNil())
+			{
+				Node *n = NewKey(nodes->Pair.Key, nodes->Hash);
+				::new(&n->Pair.Value) VT(nodes->Pair.Value);
+			}
+		}
+	}
+};
+
 
 
 //==========================================================================
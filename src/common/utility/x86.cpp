@@ -70,12 +70,34 @@ FString DumpCPUInfo(const CPUInfo *cpu)
 #define __cpuid(output, func) __asm__ __volatile__("cpuid" : "=a" ((output)[0]),\
 	"=b" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) : "a" (func));
 #endif
+
+#if defined(__i386__) && defined(__PIC__)
+#define __cpuidex(output, func, subfunc) \
+	__asm__ __volatile__("xchgl\t%%ebx, %1\n\t" \
+						 "cpuid\n\t" \
+						 "xchgl\t%%ebx, %1\n\t" \
+		: "=a" ((output)[0]), "=r" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) \
+		: "a" (func), "c" (subfunc));
+#else
+#define __cpuidex(output, func, subfunc) __asm__ __volatile__("cpuid" : "=a" ((output)[0]),\
+	"=b" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) : "a" (func), "c" (subfunc));
+#endif
+
+// The xgetbv mnemonic is unknown to older assemblers, so emit the opcode.
+static inline uint64_t ReadXCR(unsigned int index)
+{
+	uint32_t eax, edx;
+	__asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (index));
+	return ((uint64_t)edx << 32) | eax;
+}
+#else
+#define ReadXCR _xgetbv
 #endif
 
 void CheckCPUID(CPUInfo *cpu)
 {
 	int foo[4];
-	unsigned int maxext;
+	unsigned int maxstd, maxext;
 
 	memset(cpu, 0, sizeof(*cpu));
 
@@ -127,6 +149,7 @@ haveid:
 
 	// Get vendor ID
 	__cpuid(foo, 0);
+	maxstd = (unsigned int)foo[0];
 	cpu->dwVendorID[0] = foo[1];
 	cpu->dwVendorID[1] = foo[3];
 	cpu->dwVendorID[2] = foo[2];
@@ -165,6 +188,19 @@ haveid:
 		cpu->Model |= (foo[0] >> 12) & 0xF0;
 	}
 
+	// AVX needs the OS to save the YMM (and for AVX-512 the ZMM/opmask)
+	// state on context switches, which XGETBV reports.
+	if (cpu->bOSXSAVE && cpu->bAVX && maxstd >= 7)
+	{
+		uint64_t xcr0 = ReadXCR(0);
+		if ((xcr0 & 0x06) == 0x06)
+		{
+			__cpuidex(foo, 7, 0);
+			cpu->bAVX2 = (foo[1] & (1 << 5)) != 0;
+			cpu->bAVX512F = (foo[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+		}
+	}
+
 	// Check for extended functions.
 	__cpuid(foo, 0x80000000);
 	maxext = (unsigned int)foo[0];
@@ -252,6 +288,10 @@ FString DumpCPUInfo(const CPUInfo *cpu)
 		if (cpu->bSSSE3)		out += (" SSSE3");
 		if (cpu->bSSE41)		out += (" SSE4.1");
 		if (cpu->bSSE42)		out += (" SSE4.2");
+		if (cpu->bAVX)			out += (" AVX");
+		if (cpu->bAVX2)			out += (" AVX2");
+		if (cpu->bFMA)			out += (" FMA");
+		if (cpu->bAVX512F)		out += (" AVX-512F");
 		if (cpu->b3DNow)		out += (" 3DNow!");
 		if (cpu->b3DNowPlus)	out += (" 3DNow!+");
 		if (cpu->HyperThreading)	out += (" HyperThreading");
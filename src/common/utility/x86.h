@@ -4,7 +4,7 @@
 #include "basics.h"
 #include "zstring.h"
 
-struct CPUInfo	// 92 bytes
+struct CPUInfo	// 100 bytes
 {
 	union
 	{
@@ -35,10 +35,15 @@ struct CPUInfo	// 92 bytes
 			uint32_t bSSE3:1;
 			uint32_t DontCare1:8;
 			uint32_t bSSSE3:1;
-			uint32_t DontCare1a:9;
+			uint32_t DontCare1a:2;
+			uint32_t bFMA:1;
+			uint32_t DontCare1b:6;
 			uint32_t bSSE41:1;
 			uint32_t bSSE42:1;
-			uint32_t DontCare2a:11;
+			uint32_t DontCare2a:6;
+			uint32_t bOSXSAVE:1;
+			uint32_t bAVX:1;
+			uint32_t DontCare2b:3;
 
 			uint32_t bFPU:1;
 			uint32_t bVME:1;
@@ -99,6 +104,10 @@ struct CPUInfo	// 92 bytes
 		};
 		uint32_t AMD_DataL1Info;
 	};
+
+	// Only set when the OS also saves the extended register state.
+	uint8_t bAVX2;
+	uint8_t bAVX512F;
 };
 
 
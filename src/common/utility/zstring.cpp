@@ -43,22 +43,17 @@
 extern uint16_t lowerforupper[65536];
 extern uint16_t upperforlower[65536];
 
-FNullStringData FString::NullString =
-{
-	0,			// Length of string
-	2,			// Size of character buffer
-	2,			// RefCount; it must never be modified, so keep it above 1 user at all times
-	"\0"
-};
-
 void FString::AttachToOther (const FString &other)
 {
-	assert (other.Chars != NULL);
-
-	if (other.Data()->RefCount < 0)
+	if (other.IsInline())
+	{
+		Chars = other.Chars;
+		Tag() &= ~SSO_LOCKMASK;
+	}
+	else if (other.Data()->RefCount < 0)
 	{
 		AllocBuffer (other.Data()->Len);
-		StrCopy (Chars, other.Chars, other.Data()->Len);
+		StrCopy (Buffer(), other.Chars, other.Data()->Len);
 	}
 	else
 	{
@@ -76,27 +71,23 @@ FString::FString (const char *copyStr)
 	{
 		size_t len = strlen (copyStr);
 		AllocBuffer (len);
-		StrCopy (Chars, copyStr, len);
+		StrCopy (Buffer(), copyStr, len);
 	}
 }
 
 FString::FString (const char *copyStr, size_t len)
 {
 	AllocBuffer (len);
-	StrCopy (Chars, copyStr, len);
+	StrCopy (Buffer(), copyStr, len);
 }
 
 FString::FString (char oneChar)
 {
-	if (oneChar == '\0')
+	ResetToNull();
+	if (oneChar != '\0')
 	{
-		ResetToNull();
-	}
-	else
-	{
-		AllocBuffer (1);
-		Chars[0] = oneChar;
-		Chars[1] = '\0';
+		SetLen(1);
+		InlineChars()[0] = oneChar;
 	}
 }
 
@@ -105,8 +96,8 @@ FString::FString (const FString &head, const FString &tail)
 	size_t len1 = head.Len();
 	size_t len2 = tail.Len();
 	AllocBuffer (len1 + len2);
-	StrCopy (Chars, head);
-	StrCopy (Chars + len1, tail);
+	StrCopy (Buffer(), head);
+	StrCopy (Buffer() + len1, tail);
 }
 
 FString::FString (const FString &head, const char *tail)
@@ -114,17 +105,18 @@ FString::FString (const FString &head, const char *tail)
 	size_t len1 = head.Len();
 	size_t len2 = strlen (tail);
 	AllocBuffer (len1 + len2);
-	StrCopy (Chars, head);
-	StrCopy (Chars + len1, tail, len2);
+	StrCopy (Buffer(), head);
+	StrCopy (Buffer() + len1, tail, len2);
 }
 
 FString::FString (const FString &head, char tail)
 {
 	size_t len1 = head.Len();
 	AllocBuffer (len1 + 1);
-	StrCopy (Chars, head);
-	Chars[len1] = tail;
-	Chars[len1+1] = '\0';
+	char *chars = Buffer();
+	StrCopy (chars, head);
+	chars[len1] = tail;
+	chars[len1+1] = '\0';
 }
 
 FString::FString (const char *head, const FString &tail)
@@ -132,8 +124,8 @@ FString::FString (const char *head, const FString &tail)
 	size_t len1 = strlen (head);
 	size_t len2 = tail.Len();
 	AllocBuffer (len1 + len2);
-	StrCopy (Chars, head, len1);
-	StrCopy (Chars + len1, tail);
+	StrCopy (Buffer(), head, len1);
+	StrCopy (Buffer() + len1, tail);
 }
 
 FString::FString (const char *head, const char *tail)
@@ -141,35 +133,48 @@ FString::FString (const char *head, const char *tail)
 	size_t len1 = strlen (head);
 	size_t len2 = strlen (tail);
 	AllocBuffer (len1 + len2);
-	StrCopy (Chars, head, len1);
-	StrCopy (Chars + len1, tail, len2);
+	StrCopy (Buffer(), head, len1);
+	StrCopy (Buffer() + len1, tail, len2);
 }
 
 FString::FString (char head, const FString &tail)
 {
 	size_t len2 = tail.Len();
 	AllocBuffer (1 + len2);
-	Chars[0] = head;
-	StrCopy (Chars + 1, tail);
+	char *chars = Buffer();
+	chars[0] = head;
+	StrCopy (chars + 1, tail);
 }
 
 FString::~FString ()
 {
-	Data()->Release();
+	ReleaseData();
 }
 
 char *FString::LockNewBuffer(size_t len)
 {
-	Data()->Release();
+	ReleaseData();
 	AllocBuffer(len);
-	assert(Data()->RefCount == 1);
-	Data()->RefCount = -1;
-	return Chars;
+	if (IsInline())
+	{
+		Tag() |= 1 << SSO_LOCKSHIFT;
+	}
+	else
+	{
+		assert(Data()->RefCount == 1);
+		Data()->RefCount = -1;
+	}
+	return Buffer();
 }
 
 char *FString::LockBuffer()
 {
-	if (Data()->RefCount == 1)
+	if (IsInline())
+	{ // Inline strings are never shared, so the lock is only counted.
+		assert((Tag() & SSO_LOCKMASK) != SSO_LOCKMASK);
+		Tag() += 1 << SSO_LOCKSHIFT;
+	}
+	else if (Data()->RefCount == 1)
 	{ // We're the only user, so we can lock it straight away
 		Data()->RefCount = -1;
 	}
@@ -181,15 +186,36 @@ char *FString::LockBuffer()
 	{ // Somebody else is also using this character buffer, so create a copy
 		FStringData *old = Data();
 		AllocBuffer (old->Len);
-		StrCopy (Chars, old->Chars(), old->Len);
+		StrCopy (Buffer(), old->Chars(), old->Len);
 		old->Release();
-		Data()->RefCount = -1;
+		return LockBuffer();
+	}
+	return Buffer();
+}
+
+void FString::MoveToHeap()
+{
+	if (IsInline())
+	{
+		assert((Tag() & SSO_LOCKMASK) == 0);
+		size_t len = InlineLen();
+		char temp[SSO_CAPACITY + 1];
+		memcpy (temp, InlineChars(), sizeof(temp));
+		Chars = (char *)(FStringData::Alloc(len) + 1);
+		Data()->Len = (unsigned int)len;
+		StrCopy (Chars, temp, len);
 	}
-	return Chars;
 }
 
 void FString::UnlockBuffer()
 {
+	if (IsInline())
+	{
+		assert ((Tag() & SSO_LOCKMASK) != 0);
+		Tag() -= 1 << SSO_LOCKSHIFT;
+		return;
+	}
+
 	assert (Data()->RefCount < 0);
 
 	if (++Data()->RefCount == 0)
@@ -200,29 +226,19 @@ void FString::UnlockBuffer()
 
 FString &FString::operator = (const FString &other)
 {
-	assert (Chars != NULL);
-
 	if (&other != this)
 	{
-		int oldrefcount = Data()->RefCount < 0;
-		Data()->Release();
+		ReleaseData();
 		AttachToOther(other);
-		if (oldrefcount < 0)
-		{
-			LockBuffer();
-			Data()->RefCount = oldrefcount;
-		}
 	}
 	return *this;
 }
 
 FString &FString::operator = (FString &&other)
 {
-	assert (Chars != NULL);
-
 	if (&other != this)
 	{
-		Data()->Release();
+		ReleaseData();
 		Chars = other.Chars;
 		other.ResetToNull();
 	}
@@ -232,31 +248,44 @@ FString &FString::operator = (FString &&other)
 
 FString &FString::operator = (const char *copyStr)
 {
-	if (copyStr != Chars)
+	if (copyStr != GetChars())
 	{
 		if (copyStr == NULL || *copyStr == '\0')
 		{
-			Data()->Release();
+			ReleaseData();
 			ResetToNull();
 		}
 		else
 		{
-			// In case copyStr is inside us, we can't release it until
-			// we've finished the copy.
-			FStringData *old = Data();
+			size_t len = strlen (copyStr);
+			char temp[SSO_CAPACITY + 1];
 
-			if (copyStr < Chars || copyStr >= Chars + old->Len)
+			if (IsInline())
+			{
+				// copyStr may be inside us and would be overwritten during the copy.
+				memcpy (temp, InlineChars(), sizeof(temp));
+				if (copyStr >= InlineChars() && copyStr < InlineChars() + sizeof(temp))
+				{
+					copyStr = temp + (copyStr - InlineChars());
+				}
+				AllocBuffer (len);
+				StrCopy (Buffer(), copyStr, len);
+			}
+			else if (copyStr < Chars || copyStr >= Chars + Data()->Len)
 			{
 				// We know the string isn't in our buffer, so release it now
 				// to reduce the potential for needless memory fragmentation.
-				old->Release();
-				old = NULL;
+				Data()->Release();
+				AllocBuffer (len);
+				StrCopy (Buffer(), copyStr, len);
 			}
-			size_t len = strlen (copyStr);
-			AllocBuffer (len);
-			StrCopy (Chars, copyStr, len);
-			if (old != NULL)
+			else
 			{
+				// In case copyStr is inside us, we can't release it until
+				// we've finished the copy.
+				FStringData *old = Data();
+				AllocBuffer (len);
+				StrCopy (Buffer(), copyStr, len);
 				old->Release();
 			}
 		}
@@ -282,8 +311,8 @@ void FString::AppendFormat (const char *fmt, ...)
 
 void FString::VFormat (const char *fmt, va_list arglist)
 {
-	Data()->Release();
-	Chars = (char *)(FStringData::Alloc(128) + 1);
+	ReleaseData();
+	ResetToNull();
 	StringFormat::VWorker (FormatHelper, this, fmt, arglist);
 }
 
@@ -296,12 +325,14 @@ int FString::FormatHelper (void *data, const char *cstr, int len)
 {
 	FString *str = (FString *)data;
 	size_t len1 = str->Len();
-	if (len1 + len > str->Data()->AllocLen || str->Chars == &NullString.Nothing[0])
+	size_t newlen = len1 + len;
+	if (str->IsInline() ? newlen > SSO_CAPACITY : (newlen > str->Data()->AllocLen || str->IsShared()))
 	{
-		str->ReallocBuffer((len1 + len + 127) & ~127);
+		// Grow in bigger steps because formatting appends in small pieces.
+		str->ReallocBuffer((newlen + 127) & ~127);
 	}
-	StrCopy (str->Chars + len1, cstr, len);
-	str->Data()->Len = (unsigned int)(len1 + len);
+	StrCopy (str->Buffer() + len1, cstr, len);
+	str->SetLen(newlen);
 	return len;
 }
 
@@ -334,8 +365,13 @@ FString &FString::operator += (const FString &tail)
 {
 	size_t len1 = Len();
 	size_t len2 = tail.Len();
+	if (&tail == this)
+	{
+		FString copy = tail;
+		return *this += copy;
+	}
 	ReallocBuffer (len1 + len2);
-	StrCopy (Chars + len1, tail);
+	StrCopy (Buffer() + len1, tail);
 	return *this;
 }
 
@@ -344,7 +380,7 @@ FString &FString::operator += (const char *tail)
 	size_t len1 = Len();
 	size_t len2 = strlen(tail);
 	ReallocBuffer (len1 + len2);
-	StrCopy (Chars + len1, tail, len2);
+	StrCopy (Buffer() + len1, tail, len2);
 	return *this;
 }
 
@@ -352,8 +388,9 @@ FString &FString::operator += (char tail)
 {
 	size_t len1 = Len();
 	ReallocBuffer (len1 + 1);
-	Chars[len1] = tail;
-	Chars[len1+1] = '\0';
+	char *chars = Buffer();
+	chars[len1] = tail;
+	chars[len1+1] = '\0';
 	return *this;
 }
 
@@ -363,7 +400,7 @@ FString &FString::AppendCStrPart (const char *tail, size_t tailLen)
 	{
 		size_t len1 = Len();
 		ReallocBuffer(len1 + tailLen);
-		StrCopy(Chars + len1, tail, tailLen);
+		StrCopy(Buffer() + len1, tail, tailLen);
 	}
 	return *this;
 }
@@ -373,11 +410,11 @@ FString &FString::CopyCStrPart(const char *tail, size_t tailLen)
 	if (tailLen > 0)
 	{
 		ReallocBuffer(tailLen);
-		StrCopy(Chars, tail, tailLen);
+		StrCopy(Buffer(), tail, tailLen);
 	}
 	else
 	{
-		Data()->Release();
+		ReleaseData();
 		ResetToNull();
 	}
 	return *this;
@@ -387,7 +424,7 @@ size_t FString::CharacterCount() const
 {
 	// Counts string length in Unicode code points.
 	size_t len = 0;
-	const uint8_t *cp = (const uint8_t*)Chars;
+	const uint8_t *cp = (const uint8_t*)GetChars();
 	while (GetCharFromString(cp)) len++;
 	return len;
 }
@@ -395,7 +432,7 @@ size_t FString::CharacterCount() const
 
 int FString::GetNextCharacter(int &position) const
 {
-	const uint8_t *cp = (const uint8_t*)Chars + position;
+	const uint8_t *cp = (const uint8_t*)GetChars() + position;
 	const uint8_t *cpread = cp;
 	int chr = GetCharFromString(cpread);
 	position += int(cpread - cp);
@@ -406,13 +443,13 @@ void FString::Truncate(size_t newlen)
 {
 	if (newlen == 0)
 	{
-		Data()->Release();
+		ReleaseData();
 		ResetToNull();
 	}
 	else if (newlen < Len())
 	{
 		ReallocBuffer (newlen);
-		Chars[newlen] = '\0';
+		Buffer()[newlen] = '\0';
 	}
 }
 
@@ -426,18 +463,20 @@ void FString::Remove(size_t index, size_t remlen)
 		}
 		else
 		{
-			if (Data()->RefCount == 1)
+			if (!IsShared())
 			{ // Can do this in place
-				memmove(Chars + index, Chars + index + remlen, Len() - index - remlen);
-				memset(Chars + Len() - remlen, 0, remlen);
-				Data()->Len -= (unsigned)remlen;
+				char *chars = Buffer();
+				size_t len = Len();
+				memmove(chars + index, chars + index + remlen, len - index - remlen);
+				memset(chars + len - remlen, 0, remlen);
+				SetLen(len - remlen);
 			}
 			else
 			{ // Must do it in a copy
 				FStringData *old = Data();
 				AllocBuffer(old->Len - remlen);
-				StrCopy(Chars, old->Chars(), index);
-				StrCopy(Chars + index, old->Chars() + index + remlen, old->Len - index - remlen);
+				StrCopy(Buffer(), old->Chars(), index);
+				StrCopy(Buffer() + index, old->Chars() + index + remlen, old->Len - index - remlen);
 				old->Release();
 			}
 		}
@@ -451,7 +490,7 @@ FString FString::Left (size_t numChars) const
 	{
 		numChars = len;
 	}
-	return FString (Chars, numChars);
+	return FString (GetChars(), numChars);
 }
 
 FString FString::Right (size_t numChars) const
@@ -461,7 +500,7 @@ FString FString::Right (size_t numChars) const
 	{
 		numChars = len;
 	}
-	return FString (Chars + len - numChars, numChars);
+	return FString (GetChars() + len - numChars, numChars);
 }
 
 FString FString::Mid (size_t pos, size_t numChars) const
@@ -475,7 +514,7 @@ FString FString::Mid (size_t pos, size_t numChars) const
 	{
 		numChars = len - pos;
 	}
-	return FString (Chars + pos, numChars);
+	return FString (GetChars() + pos, numChars);
 }
 
 void FString::AppendCharacter(int codepoint)
@@ -487,10 +526,10 @@ void FString::DeleteLastCharacter()
 {
 	if (Len() == 0) return;
 	auto pos = Len() - 1;
-	while (pos > 0 && uint8_t(Chars[pos]) >= 0x80 && uint8_t(Chars[pos]) < 0xc0) pos--;
+	while (pos > 0 && uint8_t(GetChars()[pos]) >= 0x80 && uint8_t(GetChars()[pos]) < 0xc0) pos--;
 	if (pos <= 0)
 	{
-		Data()->Release();
+		ReleaseData();
 		ResetToNull();
 	}
 	else
@@ -502,7 +541,7 @@ void FString::DeleteLastCharacter()
 
 long FString::IndexOf (const FString &substr, long startIndex) const
 {
-	return IndexOf (substr.Chars, startIndex);
+	return IndexOf (substr.GetChars(), startIndex);
 }
 
 long FString::IndexOf (const char *substr, long startIndex) const
@@ -511,12 +550,12 @@ long FString::IndexOf (const char *substr, long startIndex) const
 	{
 		return -1;
 	}
-	char *str = strstr (Chars + startIndex, substr);
+	const char *str = strstr (GetChars() + startIndex, substr);
 	if (str == NULL)
 	{
 		return -1;
 	}
-	return long(str - Chars);
+	return long(str - GetChars());
 }
 
 long FString::IndexOf (char subchar, long startIndex) const
@@ -525,17 +564,17 @@ long FString::IndexOf (char subchar, long startIndex) const
 	{
 		return -1;
 	}
-	char *str = strchr (Chars + startIndex, subchar);
+	const char *str = strchr (GetChars() + startIndex, subchar);
 	if (str == NULL)
 	{
 		return -1;
 	}
-	return long(str - Chars);
+	return long(str - GetChars());
 }
 
 long FString::IndexOfAny (const FString &charset, long startIndex) const
 {
-	return IndexOfAny (charset.Chars, startIndex);
+	return IndexOfAny (charset.GetChars(), startIndex);
 }
 
 long FString::IndexOfAny (const char *charset, long startIndex) const
@@ -544,12 +583,12 @@ long FString::IndexOfAny (const char *charset, long startIndex) const
 	{
 		return -1;
 	}
-	char *brk = strpbrk (Chars + startIndex, charset);
+	const char *brk = strpbrk (GetChars() + startIndex, charset);
 	if (brk == NULL)
 	{
 		return -1;
 	}
-	return long(brk - Chars);
+	return long(brk - GetChars());
 }
 
 long FString::LastIndexOf (char subchar) const
@@ -565,7 +604,7 @@ long FString::LastIndexOf (char subchar, long endIndex) const
 	}
 	while (--endIndex >= 0)
 	{
-		if (Chars[endIndex] == subchar)
+		if (GetChars()[endIndex] == subchar)
 		{
 			return endIndex;
 		}
@@ -584,7 +623,7 @@ long FString::LastIndexOfBroken (const FString &_substr, long endIndex) const
 	substrlen--;
 	while (--endIndex >= long(substrlen))
 	{
-		if (strncmp (substr, Chars + endIndex - substrlen, substrlen + 1) == 0)
+		if (strncmp (substr, GetChars() + endIndex - substrlen, substrlen + 1) == 0)
 		{
 			return endIndex;
 		}
@@ -594,7 +633,7 @@ long FString::LastIndexOfBroken (const FString &_substr, long endIndex) const
 
 long FString::LastIndexOfAny (const FString &charset) const
 {
-	return LastIndexOfAny (charset.Chars, long(Len()));
+	return LastIndexOfAny (charset.GetChars(), long(Len()));
 }
 
 long FString::LastIndexOfAny (const char *charset) const
@@ -604,7 +643,7 @@ long FString::LastIndexOfAny (const char *charset) const
 
 long FString::LastIndexOfAny (const FString &charset, long endIndex) const
 {
-	return LastIndexOfAny (charset.Chars, endIndex);
+	return LastIndexOfAny (charset.GetChars(), endIndex);
 }
 
 long FString::LastIndexOfAny (const char *charset, long endIndex) const
@@ -615,7 +654,7 @@ long FString::LastIndexOfAny (const char *charset, long endIndex) const
 	}
 	while (--endIndex >= 0)
 	{
-		if (strchr (charset, Chars[endIndex]) != NULL)
+		if (strchr (charset, GetChars()[endIndex]) != NULL)
 		{
 			return endIndex;
 		}
@@ -625,12 +664,12 @@ long FString::LastIndexOfAny (const char *charset, long endIndex) const
 
 long FString::LastIndexOf (const FString &substr) const
 {
-	return LastIndexOf(substr.Chars, long(Len() - substr.Len()), substr.Len());
+	return LastIndexOf(substr.GetChars(), long(Len() - substr.Len()), substr.Len());
 }
 
 long FString::LastIndexOf (const FString &substr, long endIndex) const
 {
-	return LastIndexOf(substr.Chars, endIndex, substr.Len());
+	return LastIndexOf(substr.GetChars(), endIndex, substr.Len());
 }
 
 long FString::LastIndexOf (const char *substr) const
@@ -651,7 +690,7 @@ long FString::LastIndexOf (const char *substr, long endIndex, size_t substrlen)
 	}
 	while (endIndex >= 0)
 	{
-		if (strncmp (substr, Chars + endIndex, substrlen) == 0)
+		if (strncmp (substr, GetChars() + endIndex, substrlen) == 0)
 		{
 			return endIndex;
 		}
@@ -662,22 +701,22 @@ long FString::LastIndexOf (const char *substr, long endIndex, size_t substrlen)
 
 void FString::ToUpper ()
 {
-	LockBuffer();
+	char *chars = LockBuffer();
 	size_t max = Len();
 	for (size_t i = 0; i < max; ++i)
 	{
-		Chars[i] = (char)toupper(Chars[i]);
+		chars[i] = (char)toupper(chars[i]);
 	}
 	UnlockBuffer();
 }
 
 void FString::ToLower ()
 {
-	LockBuffer();
+	char *chars = LockBuffer();
 	size_t max = Len();
 	for (size_t i = 0; i < max; ++i)
 	{
-		Chars[i] = (char)tolower(Chars[i]);
+		chars[i] = (char)tolower(chars[i]);
 	}
 	UnlockBuffer();
 }
@@ -712,20 +751,22 @@ void FString::StripLeft ()
 {
 	size_t max = Len(), i, j;
 	if (max == 0) return;
+	const char *chars = GetChars();
 	for (i = 0; i < max; ++i)
 	{
-		if (!isspace((unsigned char)Chars[i]))
+		if (!isspace((unsigned char)chars[i]))
 			break;
 	}
 	if (i == 0)
 	{ // Nothing to strip.
 		return;
 	}
-	if (Data()->RefCount <= 1)
+	if (!IsShared())
 	{
+		char *buf = Buffer();
 		for (j = 0; i <= max; ++j, ++i)
 		{
-			Chars[j] = Chars[i];
+			buf[j] = buf[i];
 		}
 		ReallocBuffer (j-1);
 	}
@@ -733,34 +774,36 @@ void FString::StripLeft ()
 	{
 		FStringData *old = Data();
 		AllocBuffer (max - i);
-		StrCopy (Chars, old->Chars() + i, max - i);
+		StrCopy (Buffer(), old->Chars() + i, max - i);
 		old->Release();
 	}
 }
 
 void FString::StripLeft (const FString &charset)
 {
-	return StripLeft (charset.Chars);
+	return StripLeft (charset.GetChars());
 }
 
 void FString::StripLeft (const char *charset)
 {
 	size_t max = Len(), i, j;
 	if (max == 0) return;
+	const char *chars = GetChars();
 	for (i = 0; i < max; ++i)
 	{
-		if (!strchr (charset, Chars[i]))
+		if (!strchr (charset, chars[i]))
 			break;
 	}
 	if (i == 0)
 	{ // Nothing to strip.
 		return;
 	}
-	if (Data()->RefCount <= 1)
+	if (!IsShared())
 	{
+		char *buf = Buffer();
 		for (j = 0; i <= max; ++j, ++i)
 		{
-			Chars[j] = Chars[i];
+			buf[j] = buf[i];
 		}
 		ReallocBuffer (j-1);
 	}
@@ -768,7 +811,7 @@ void FString::StripLeft (const char *charset)
 	{
 		FStringData *old = Data();
 		AllocBuffer (max - i);
-		StrCopy (Chars, old->Chars() + i, max - i);
+		StrCopy (Buffer(), old->Chars() + i, max - i);
 		old->Release();
 	}
 }
@@ -777,57 +820,61 @@ void FString::StripRight ()
 {
 	size_t max = Len(), i;
 	if (max == 0) return;
+	const char *chars = GetChars();
 	for (i = --max; i > 0; i--)
 	{
-		if (!isspace((unsigned char)Chars[i]))
+		if (!isspace((unsigned char)chars[i]))
 			break;
 	}
 	if (i == max)
 	{ // Nothing to strip.
 		return;
 	}
-	if (Data()->RefCount <= 1)
+	if (!IsShared())
 	{
-		Chars[i+1] = '\0';
+		char *buf = Buffer();
+		buf[i+1] = '\0';
 		ReallocBuffer (i+1);
 	}
 	else
 	{
 		FStringData *old = Data();
 		AllocBuffer (i+1);
-		StrCopy (Chars, old->Chars(), i+1);
+		StrCopy (Buffer(), old->Chars(), i+1);
 		old->Release();
 	}
 }
 
 void FString::StripRight (const FString &charset)
 {
-	return StripRight (charset.Chars);
+	return StripRight (charset.GetChars());
 }
 
 void FString::StripRight (const char *charset)
 {
 	size_t max = Len(), i;
 	if (max == 0) return;
+	const char *chars = GetChars();
 	for (i = --max; i > 0; i--)
 	{
-		if (!strchr (charset, Chars[i]))
+		if (!strchr (charset, chars[i]))
 			break;
 	}
 	if (i == max)
 	{ // Nothing to strip.
 		return;
 	}
-	if (Data()->RefCount <= 1)
+	if (!IsShared())
 	{
-		Chars[i+1] = '\0';
+		char *buf = Buffer();
+		buf[i+1] = '\0';
 		ReallocBuffer (i+1);
 	}
 	else
 	{
 		FStringData *old = Data();
 		AllocBuffer (i+1);
-		StrCopy (Chars, old->Chars(), i+1);
+		StrCopy (Buffer(), old->Chars(), i+1);
 		old->Release();
 	}
 }
@@ -836,78 +883,82 @@ void FString::StripLeftRight ()
 {
 	size_t max = Len(), i, j, k;
 	if (max == 0) return;
+	const char *chars = GetChars();
 	for (i = 0; i < max; ++i)
 	{
-		if (Chars[i] < 0 || !isspace((unsigned char)Chars[i]))
+		if (chars[i] < 0 || !isspace((unsigned char)chars[i]))
 			break;
 	}
 	for (j = max - 1; j >= i; --j)
 	{
-		if (Chars[i] < 0 || !isspace((unsigned char)Chars[j]))
+		if (chars[i] < 0 || !isspace((unsigned char)chars[j]))
 			break;
 	}
 	if (i == 0 && j == max - 1)
 	{ // Nothing to strip.
 		return;
 	}
-	if (Data()->RefCount <= 1)
+	if (!IsShared())
 	{
+		char *buf = Buffer();
 		for (k = 0; i <= j; ++i, ++k)
 		{
-			Chars[k] = Chars[i];
+			buf[k] = buf[i];
 		}
-		Chars[k] = '\0';
+		buf[k] = '\0';
 		ReallocBuffer (k);
 	}
 	else
 	{
 		FStringData *old = Data();
 		AllocBuffer(j - i + 1);
-		StrCopy(Chars, old->Chars(), j - i + 1);
+		StrCopy(Buffer(), old->Chars(), j - i + 1);
 		old->Release();
 	}
 }
 
 void FString::StripLeftRight (const FString &charset)
 {
-	return StripLeftRight (charset.Chars);
+	return StripLeftRight (charset.GetChars());
 }
 
 void FString::StripLeftRight (const char *charset)
 {
 	size_t max = Len(), i, j, k;
 	if (max == 0) return;
+	const char *chars = GetChars();
 	for (i = 0; i < max; ++i)
 	{
-		if (!strchr (charset, Chars[i]))
+		if (!strchr (charset, chars[i]))
 			break;
 	}
 	for (j = max - 1; j >= i; --j)
 	{
-		if (!strchr (charset, Chars[j]))
+		if (!strchr (charset, chars[j]))
 			break;
 	}
-	if (Data()->RefCount <= 1)
+	if (!IsShared())
 	{
+		char *buf = Buffer();
 		for (k = 0; i <= j; ++i, ++k)
 		{
-			Chars[k] = Chars[i];
+			buf[k] = buf[i];
 		}
-		Chars[k] = '\0';
+		buf[k] = '\0';
 		ReallocBuffer (k);
 	}
 	else
 	{
 		FStringData *old = Data();
 		AllocBuffer (j - i);
-		StrCopy (Chars, old->Chars(), j - i);
+		StrCopy (Buffer(), old->Chars(), j - i);
 		old->Release();
 	}
 }
 
 void FString::Insert (size_t index, const FString &instr)
 {
-	Insert (index, instr.Chars, instr.Len());
+	Insert (index, instr.GetChars(), instr.Len());
 }
 
 void FString::Insert (size_t index, const char *instr)
@@ -924,19 +975,19 @@ void FString::Insert (size_t index, const char *instr, size_t instrlen)
 		{
 			AppendCStrPart(instr, instrlen);
 		}
-		else if (Data()->RefCount <= 1)
+		else if (!IsShared())
 		{
 			ReallocBuffer(mylen + instrlen);
-			memmove(Chars + index + instrlen, Chars + index, (mylen - index + 1) * sizeof(char));
-			memcpy(Chars + index, instr, instrlen * sizeof(char));
+			memmove(Buffer() + index + instrlen, Buffer() + index, (mylen - index + 1) * sizeof(char));
+			memcpy(Buffer() + index, instr, instrlen * sizeof(char));
 		}
 		else
 		{
 			FStringData *old = Data();
 			AllocBuffer(mylen + instrlen);
-			StrCopy(Chars, old->Chars(), index);
-			StrCopy(Chars + index, instr, instrlen);
-			StrCopy(Chars + index + instrlen, old->Chars() + index, mylen - index);
+			StrCopy(Buffer(), old->Chars(), index);
+			StrCopy(Buffer() + index, instr, instrlen);
+			StrCopy(Buffer() + index + instrlen, old->Chars() + index, mylen - index);
 			old->Release();
 		}
 	}
@@ -983,22 +1034,22 @@ void FString::MergeChars (char merger, char newchar)
 {
 	size_t read, write, mylen;
 
-	LockBuffer();
+	char *chars = LockBuffer();
 	for (read = write = 0, mylen = Len(); read < mylen; )
 	{
-		if (Chars[read] == merger)
+		if (chars[read] == merger)
 		{
-			while (Chars[++read] == merger)
+			while (chars[++read] == merger)
 			{
 			}
-			Chars[write++] = newchar;
+			chars[write++] = newchar;
 		}
 		else
 		{
-			Chars[write++] = Chars[read++];
+			chars[write++] = chars[read++];
 		}
 	}
-	Chars[write] = '\0';
+	chars[write] = '\0';
 	ReallocBuffer (write);
 	UnlockBuffer();
 }
@@ -1007,39 +1058,39 @@ void FString::MergeChars (const char *charset, char newchar)
 {
 	size_t read, write, mylen;
 
-	LockBuffer();
+	char *chars = LockBuffer();
 	for (read = write = 0, mylen = Len(); read < mylen; )
 	{
-		if (strchr (charset, Chars[read]) != NULL)
+		if (strchr (charset, chars[read]) != NULL)
 		{
-			while (strchr (charset, Chars[++read]) != NULL)
+			while (strchr (charset, chars[++read]) != NULL)
 			{
 			}
-			Chars[write++] = newchar;
+			chars[write++] = newchar;
 		}
 		else
 		{
-			Chars[write++] = Chars[read++];
+			chars[write++] = chars[read++];
 		}
 	}
-	Chars[write] = '\0';
+	chars[write] = '\0';
 	ReallocBuffer (write);
 	UnlockBuffer();
 }
 
 void FString::Substitute (const FString &oldstr, const FString &newstr)
 {
-	return Substitute (oldstr.Chars, newstr.Chars, oldstr.Len(), newstr.Len());
+	return Substitute (oldstr.GetChars(), newstr.GetChars(), oldstr.Len(), newstr.Len());
 }
 
 void FString::Substitute (const char *oldstr, const FString &newstr)
 {
-	return Substitute (oldstr, newstr.Chars, strlen(oldstr), newstr.Len());
+	return Substitute (oldstr, newstr.GetChars(), strlen(oldstr), newstr.Len());
 }
 
 void FString::Substitute (const FString &oldstr, const char *newstr)
 {
-	return Substitute (oldstr.Chars, newstr, oldstr.Len(), strlen(newstr));
+	return Substitute (oldstr.GetChars(), newstr, oldstr.Len(), strlen(newstr));
 }
 
 void FString::Substitute (const char *oldstr, const char *newstr)
@@ -1053,17 +1104,17 @@ void FString::Substitute (const char *oldstr, const char *newstr, size_t oldstrl
 	LockBuffer();
 	for (size_t checkpt = 0; checkpt < Len(); )
 	{
-		char *match = strstr (Chars + checkpt, oldstr);
+		const char *match = strstr (GetChars() + checkpt, oldstr);
 		size_t len = Len();
 		if (match != NULL)
 		{
-			size_t matchpt = match - Chars;
+			size_t matchpt = match - GetChars();
 			if (oldstrlen != newstrlen)
 			{
 				ReallocBuffer (len + newstrlen - oldstrlen);
-				memmove (Chars + matchpt + newstrlen, Chars + matchpt + oldstrlen, (len + 1 - matchpt - oldstrlen)*sizeof(char));
+				memmove (Buffer() + matchpt + newstrlen, Buffer() + matchpt + oldstrlen, (len + 1 - matchpt - oldstrlen)*sizeof(char));
 			}
-			memcpy (Chars + matchpt, newstr, newstrlen);
+			memcpy (Buffer() + matchpt, newstr, newstrlen);
 			checkpt = matchpt + newstrlen;
 		}
 		else
@@ -1085,7 +1136,7 @@ octdigits	= [0-7];
 
 ("0" octdigits+ | "0" [xX] hexdigits+ | (digits \ '0') digits*) { return true; }
 [\000-\377] { return false; }*/
-	const char *YYCURSOR = Chars;
+	const char *YYCURSOR = GetChars();
 	char yych;
 
 	yych = *YYCURSOR;
@@ -1142,7 +1193,7 @@ digits		= [0-9];
 (digits+ | digits* "." digits+) ([dDeE] [+-]? digits+)? { return true; }
 [\000-\377] { return false; }
 */
-	const char *YYCURSOR = Chars;
+	const char *YYCURSOR = GetChars();
 	char yych;
 	bool gotdig = false;
 
@@ -1186,17 +1237,17 @@ digits		= [0-9];
 
 int64_t FString::ToLong (int base) const
 {
-	return strtoll (Chars, NULL, base);
+	return strtoll (GetChars(), NULL, base);
 }
 
 uint64_t FString::ToULong (int base) const
 {
-	return strtoull (Chars, NULL, base);
+	return strtoull (GetChars(), NULL, base);
 }
 
 double FString::ToDouble () const
 {
-	return strtod (Chars, NULL);
+	return strtod (GetChars(), NULL);
 }
 
 void FString::StrCopy (char *to, const char *from, size_t len)
@@ -1207,22 +1258,48 @@ void FString::StrCopy (char *to, const char *from, size_t len)
 
 void FString::StrCopy (char *to, const FString &from)
 {
-	StrCopy (to, from.Chars, from.Len());
+	StrCopy (to, from.GetChars(), from.Len());
 }
 
 void FString::AllocBuffer (size_t len)
 {
-	Chars = (char *)(FStringData::Alloc(len) + 1);
-	Data()->Len = (unsigned int)len;
+	if (len <= SSO_CAPACITY)
+	{
+		ResetToNull();
+		SetLen(len);
+	}
+	else
+	{
+		Chars = (char *)(FStringData::Alloc(len) + 1);
+		Data()->Len = (unsigned int)len;
+	}
 }
 
 void FString::ReallocBuffer (size_t newlen)
 {
-	if (Data()->RefCount > 1)
+	if (IsInline())
+	{
+		if (newlen <= SSO_CAPACITY)
+		{
+			SetLen(newlen);
+		}
+		else
+		{ // Move to the heap and keep any locks.
+			FString old(std::move(*this));
+			int locks = (old.Tag() & SSO_LOCKMASK) >> SSO_LOCKSHIFT;
+			AllocBuffer (newlen);
+			StrCopy (Chars, old.InlineChars(), old.InlineLen());
+			if (locks > 0)
+			{
+				Data()->RefCount = -locks;
+			}
+		}
+	}
+	else if (Data()->RefCount > 1)
 	{ // If more than one reference, we must use a new copy
 		FStringData *old = Data();
 		AllocBuffer (newlen);
-		StrCopy (Chars, old->Chars(), newlen < old->Len ? newlen : old->Len);
+		StrCopy (Buffer(), old->Chars(), newlen < old->Len ? newlen : old->Len);
 		old->Release();
 	}
 	else
@@ -1299,8 +1376,8 @@ FString::FString(const wchar_t *copyStr)
 		auto len = wcslen(copyStr);
 		int size_needed = WideCharToMultiByte(CP_UTF8, 0, copyStr, (int)len, nullptr, 0, nullptr, nullptr);
 		AllocBuffer(size_needed);
-		WideCharToMultiByte(CP_UTF8, 0, copyStr, (int)len, Chars, size_needed, nullptr, nullptr);
-		Chars[size_needed] = 0;
+		WideCharToMultiByte(CP_UTF8, 0, copyStr, (int)len, Buffer(), size_needed, nullptr, nullptr);
+		Buffer()[size_needed] = 0;
 	}
 }
 
@@ -1308,7 +1385,7 @@ FString &FString::operator=(const wchar_t *copyStr)
 {
 	if (copyStr == NULL || *copyStr == '\0')
 	{
-		Data()->Release();
+		ReleaseData();
 		ResetToNull();
 	}
 	else
@@ -1316,8 +1393,8 @@ FString &FString::operator=(const wchar_t *copyStr)
 		auto len = wcslen(copyStr);
 		int size_needed = WideCharToMultiByte(CP_UTF8, 0, copyStr, (int)len, nullptr, 0, nullptr, nullptr);
 		ReallocBuffer(size_needed);
-		WideCharToMultiByte(CP_UTF8, 0, copyStr, (int)len, Chars, size_needed, nullptr, nullptr);
-		Chars[size_needed] = 0;
+		WideCharToMultiByte(CP_UTF8, 0, copyStr, (int)len, Buffer(), size_needed, nullptr, nullptr);
+		Buffer()[size_needed] = 0;
 	}
 	return *this;
 }
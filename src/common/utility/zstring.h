@@ -108,14 +108,6 @@ struct FStringData
 	void Dealloc ();
 };
 
-struct FNullStringData
-{
-	unsigned int Len;
-	unsigned int AllocLen;
-	int RefCount;
-	char Nothing[2];
-};
-
 enum ELumpNum
 {
 };
@@ -159,6 +151,12 @@ public:
 	char *LockBuffer();		// Obtain write access to the character buffer
 	void UnlockBuffer();	// Allow shared access to the character buffer
 
+	// Moves a short string out of the FString into a heap buffer. Pointers
+	// from GetChars() then survive the FString being moved (e.g. by a
+	// growing TArray) until the string is changed. For containers that
+	// hand out such pointers.
+	void MoveToHeap();
+
 	void Swap(FString &other)
 	{
 		std::swap(Chars, other.Chars);
@@ -168,22 +166,22 @@ public:
 	explicit operator bool() = delete; // this is needed to render the operator const char * ineffective when used in boolean constructs.
 	bool operator !() = delete;
 
-	operator const char *() const { return Chars; }
+	operator const char *() const { return GetChars(); }
 
-	const char *GetChars() const { return Chars; }
+	const char *GetChars() const { return IsInline() ? InlineChars() : Chars; }
 
-	const char &operator[] (int index) const { return Chars[index]; }
+	const char &operator[] (int index) const { return GetChars()[index]; }
 #if defined(_WIN32) && !defined(_WIN64) && defined(_MSC_VER)
 	// Compiling 32-bit Windows source with MSVC: size_t is typedefed to an
 	// unsigned int with the 64-bit portability warning attribute, so the
 	// prototype cannot substitute unsigned int for size_t, or you get
 	// spurious warnings.
-	const char &operator[] (size_t index) const { return Chars[index]; }
+	const char &operator[] (size_t index) const { return GetChars()[index]; }
 #else
-	const char &operator[] (unsigned int index) const { return Chars[index]; }
+	const char &operator[] (unsigned int index) const { return GetChars()[index]; }
 #endif
-	const char &operator[] (unsigned long index) const { return Chars[index]; }
-	const char &operator[] (unsigned long long index) const { return Chars[index]; }
+	const char &operator[] (unsigned long index) const { return GetChars()[index]; }
+	const char &operator[] (unsigned long long index) const { return GetChars()[index]; }
 
 	FString &operator = (const FString &other);
 	FString &operator = (FString &&other);
@@ -205,8 +203,8 @@ public:
 	FString &operator << (const char *tail) { return *this += tail; }
 	FString &operator << (char tail) { return *this += tail; }
 
-	const char &Front() const { assert(IsNotEmpty()); return Chars[0]; }
-	const char &Back() const { assert(IsNotEmpty()); return Chars[Len() - 1]; }
+	const char &Front() const { assert(IsNotEmpty()); return GetChars()[0]; }
+	const char &Back() const { assert(IsNotEmpty()); return GetChars()[Len() - 1]; }
 
 	FString Left (size_t numChars) const;
 	FString Right (size_t numChars) const;
@@ -264,12 +262,12 @@ public:
 	{
 		size_t i, j;
 
-		LockBuffer();
+		char *chars = LockBuffer();
 		for (i = 0, j = Len(); i < j; ++i)
 		{
-			if (IsOldChar(Chars[i]))
+			if (IsOldChar(chars[i]))
 			{
-				Chars[i] = newchar;
+				chars[i] = newchar;
 			}
 		}
 		UnlockBuffer();
@@ -283,15 +281,15 @@ public:
 	{
 		size_t read, write, mylen;
 
-		LockBuffer();
+		char *chars = LockBuffer();
 		for (read = write = 0, mylen = Len(); read < mylen; ++read)
 		{
-			if (!IsKillChar(Chars[read]))
+			if (!IsKillChar(chars[read]))
 			{
-				Chars[write++] = Chars[read];
+				chars[write++] = chars[read];
 			}
 		}
-		Chars[write] = '\0';
+		chars[write] = '\0';
 		ReallocBuffer (write);
 		UnlockBuffer();
 	}
@@ -320,7 +318,7 @@ public:
 	uint64_t ToULong (int base=0) const;
 	double ToDouble () const;
 
-	size_t Len() const { return Data()->Len; }
+	size_t Len() const { return IsInline() ? InlineLen() : Data()->Len; }
 	size_t CharacterCount() const;
 	int GetNextCharacter(int &position) const;
 	bool IsEmpty() const { return Len() == 0; }
@@ -329,15 +327,15 @@ public:
 	void Truncate (size_t newlen);
 	void Remove(size_t index, size_t remlen);
 
-	int Compare (const FString &other) const { return strcmp (Chars, other.Chars); }
-	int Compare (const char *other) const { return strcmp (Chars, other); }
-	int Compare(const FString &other, int len) const { return strncmp(Chars, other.Chars, len); }
-	int Compare(const char *other, int len) const { return strncmp(Chars, other, len); }
+	int Compare (const FString &other) const { return strcmp (GetChars(), other.GetChars()); }
+	int Compare (const char *other) const { return strcmp (GetChars(), other); }
+	int Compare(const FString &other, int len) const { return strncmp(GetChars(), other.GetChars(), len); }
+	int Compare(const char *other, int len) const { return strncmp(GetChars(), other, len); }
 
-	int CompareNoCase (const FString &other) const { return stricmp (Chars, other.Chars); }
-	int CompareNoCase (const char *other) const { return stricmp (Chars, other); }
-	int CompareNoCase(const FString &other, int len) const { return strnicmp(Chars, other.Chars, len); }
-	int CompareNoCase(const char *other, int len) const { return strnicmp(Chars, other, len); }
+	int CompareNoCase (const FString &other) const { return stricmp (GetChars(), other.GetChars()); }
+	int CompareNoCase (const char *other) const { return stricmp (GetChars(), other); }
+	int CompareNoCase(const FString &other, int len) const { return strnicmp(GetChars(), other.GetChars(), len); }
+	int CompareNoCase(const char *other, int len) const { return strnicmp(GetChars(), other, len); }
 
 	enum EmptyTokenType
 	{
@@ -351,13 +349,59 @@ public:
 	void Split(TArray<FString>& tokens, const char *delimiter, EmptyTokenType keepEmpty = TOK_KEEPEMPTY) const;
 
 protected:
-	const FStringData *Data() const { return (FStringData *)Chars - 1; }
-	FStringData *Data() { return (FStringData *)Chars - 1; }
+	// Strings of up to SSO_CAPACITY characters are stored inside the Chars
+	// pointer itself instead of in an FStringData block. A heap buffer's
+	// address is always even, so the lowest bit of the pointer marks an
+	// inline string. The byte holding that bit also stores the length and
+	// lock count, the remaining bytes hold the characters and the
+	// terminating null. This keeps an FString pointer-sized and free of
+	// pointers into itself, so it can still be moved with memcpy.
+	enum
+	{
+		SSO_INLINE = 1,
+		SSO_LENSHIFT = 1,
+		SSO_LENMASK = 7 << SSO_LENSHIFT,
+		SSO_LOCKSHIFT = 4,
+		SSO_LOCKMASK = 15 << SSO_LOCKSHIFT,
+		SSO_CAPACITY = sizeof(char *) - 2,
+#ifdef __BIG_ENDIAN__
+		SSO_TAG = sizeof(char *) - 1,
+		SSO_CHARS = 0,
+#else
+		SSO_TAG = 0,
+		SSO_CHARS = 1,
+#endif
+	};
+
+	uint8_t Tag() const { return reinterpret_cast<const uint8_t *>(&Chars)[SSO_TAG]; }
+	uint8_t &Tag() { return reinterpret_cast<uint8_t *>(&Chars)[SSO_TAG]; }
+	bool IsInline() const { return !!(Tag() & SSO_INLINE); }
+	size_t InlineLen() const { return (Tag() & SSO_LENMASK) >> SSO_LENSHIFT; }
+	const char *InlineChars() const { return reinterpret_cast<const char *>(&Chars) + SSO_CHARS; }
+	char *InlineChars() { return reinterpret_cast<char *>(&Chars) + SSO_CHARS; }
+
+	// Writable character buffer. Only valid if the string is not shared.
+	char *Buffer() { return IsInline() ? InlineChars() : Chars; }
+	bool IsShared() const { return !IsInline() && Data()->RefCount > 1; }
+
+	const FStringData *Data() const { assert(!IsInline()); return (FStringData *)Chars - 1; }
+	FStringData *Data() { assert(!IsInline()); return (FStringData *)Chars - 1; }
 
 	void ResetToNull()
 	{
-		NullString.RefCount++;
-		Chars = &NullString.Nothing[0];
+		Chars = nullptr;
+		Tag() = SSO_INLINE;
+	}
+
+	void ReleaseData()
+	{
+		if (!IsInline()) Data()->Release();
+	}
+
+	void SetLen(size_t len)
+	{
+		if (IsInline()) Tag() = uint8_t((Tag() & ~SSO_LENMASK) | (len << SSO_LENSHIFT));
+		else Data()->Len = (unsigned int)len;
 	}
 
 	void AttachToOther (const FString &other);
@@ -370,8 +414,6 @@ protected:
 
 	char *Chars;
 
-	static FNullStringData NullString;
-
 	friend struct FStringData;
 
 public:
@@ -908,6 +908,8 @@ static void End2DAndUpdate()
 	DrawRateStuff();
 	twod->End();
 	CheckBench();
+	// Spend the idle time before presenting on garbage collection if gc_budget is set.
+	GC::BudgetStep();
 	screen->Update();
 }
 
@@ -47,6 +47,7 @@ EventManager staticEventManager;
 
 void EventManager::CallOnRegister()
 {
+	InvalidateSubscribers();
 	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
 	{
 		handler->OnRegister();
@@ -119,6 +120,7 @@ bool EventManager::RegisterHandler(DStaticEventHandler* handler)
 		handler->ObjectFlags |= OF_Transient;
 	}
 
+	InvalidateSubscribers();
 	return true;
 }
 
@@ -152,6 +154,8 @@ bool EventManager::UnregisterHandler(DStaticEventHandler* handler)
 		LastEventHandler = handler->prev;
 		GC::WriteBarrier(handler->prev);
 	}
+	RemoveSubscriber(handler);
+	InvalidateSubscribers();
 	if (handler->IsStatic())
 	{
 		handler->ObjectFlags &= ~OF_Transient;
@@ -268,16 +272,17 @@ void EventManager::Shutdown()
 	}
 	for (auto handler : list)
 	{
+		RemoveSubscriber(handler);
 		handler->Destroy();
 	}
 	FirstEventHandler = LastEventHandler = nullptr;
+	InvalidateSubscribers();
 }
 
 #define DEFINE_EVENT_LOOPER(name, play) void EventManager::name() \
 { \
 	if (ShouldCallStatic(play)) staticEventManager.name(); \
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next) \
-		handler->name(); \
+	CallSubscribers(ESUB_##name, [&](DStaticEventHandler* handler) { handler->name(); }); \
 }
 
 
@@ -315,8 +320,7 @@ void EventManager::WorldThingSpawned(AActor* actor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingSpawned(actor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingSpawned(actor);
+	CallSubscribers(ESUB_WorldThingSpawned, [&](DStaticEventHandler* handler) { handler->WorldThingSpawned(actor); });
 }
 
 void EventManager::WorldThingDied(AActor* actor, AActor* inflictor)
@@ -327,8 +331,7 @@ void EventManager::WorldThingDied(AActor* actor, AActor* inflictor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDied(actor, inflictor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingDied(actor, inflictor);
+	CallSubscribers(ESUB_WorldThingDied, [&](DStaticEventHandler* handler) { handler->WorldThingDied(actor, inflictor); });
 }
 
 void EventManager::WorldThingGround(AActor* actor, FState* st)
@@ -339,8 +342,7 @@ void EventManager::WorldThingGround(AActor* actor, FState* st)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingGround(actor, st);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingGround(actor, st);
+	CallSubscribers(ESUB_WorldThingGround, [&](DStaticEventHandler* handler) { handler->WorldThingGround(actor, st); });
 }
 
 void EventManager::WorldThingRevived(AActor* actor)
@@ -351,8 +353,7 @@ void EventManager::WorldThingRevived(AActor* actor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingRevived(actor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingRevived(actor);
+	CallSubscribers(ESUB_WorldThingRevived, [&](DStaticEventHandler* handler) { handler->WorldThingRevived(actor); });
 }
 
 void EventManager::WorldThingDamaged(AActor* actor, AActor* inflictor, AActor* source, int damage, FName mod, int flags, DAngle angle)
@@ -363,8 +364,7 @@ void EventManager::WorldThingDamaged(AActor* actor, AActor* inflictor, AActor* s
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
+	CallSubscribers(ESUB_WorldThingDamaged, [&](DStaticEventHandler* handler) { handler->WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle); });
 }
 
 void EventManager::WorldThingDestroyed(AActor* actor)
@@ -377,8 +377,7 @@ void EventManager::WorldThingDestroyed(AActor* actor)
 	if (!(actor->ObjectFlags & OF_Spawned))
 		return;
 
-	for (DStaticEventHandler* handler = LastEventHandler; handler; handler = handler->prev)
-		handler->WorldThingDestroyed(actor);
+	CallSubscribersReverse(ESUB_WorldThingDestroyed, [&](DStaticEventHandler* handler) { handler->WorldThingDestroyed(actor); });
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDestroyed(actor);
 }
@@ -387,24 +386,21 @@ void EventManager::WorldLinePreActivated(line_t* line, AActor* actor, int activa
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLinePreActivated(line, actor, activationType, shouldactivate);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldLinePreActivated(line, actor, activationType, shouldactivate);
+	CallSubscribers(ESUB_WorldLinePreActivated, [&](DStaticEventHandler* handler) { handler->WorldLinePreActivated(line, actor, activationType, shouldactivate); });
 }
 
 void EventManager::WorldLineActivated(line_t* line, AActor* actor, int activationType)
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLineActivated(line, actor, activationType);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldLineActivated(line, actor, activationType);
+	CallSubscribers(ESUB_WorldLineActivated, [&](DStaticEventHandler* handler) { handler->WorldLineActivated(line, actor, activationType); });
 }
 
 int EventManager::WorldSectorDamaged(sector_t* sector, AActor* source, int damage, FName damagetype, int part, DVector3 position, bool isradius)
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		damage = handler->WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
+	CallSubscribers(ESUB_WorldSectorDamaged, [&](DStaticEventHandler* handler) { damage = handler->WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius); });
 	return damage;
 }
 
@@ -412,8 +408,7 @@ int EventManager::WorldLineDamaged(line_t* line, AActor* source, int damage, FNa
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		damage = handler->WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
+	CallSubscribers(ESUB_WorldLineDamaged, [&](DStaticEventHandler* handler) { damage = handler->WorldLineDamaged(line, source, damage, damagetype, side, position, isradius); });
 	return damage;
 }
 
@@ -528,16 +523,14 @@ void EventManager::RenderOverlay(EHudState state)
 {
 	if (ShouldCallStatic(false)) staticEventManager.RenderOverlay(state);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->RenderOverlay(state);
+	CallSubscribers(ESUB_RenderOverlay, [&](DStaticEventHandler* handler) { handler->RenderOverlay(state); });
 }
 
 void EventManager::RenderUnderlay(EHudState state)
 {
 	if (ShouldCallStatic(false)) staticEventManager.RenderUnderlay(state);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->RenderUnderlay(state);
+	CallSubscribers(ESUB_RenderUnderlay, [&](DStaticEventHandler* handler) { handler->RenderUnderlay(state); });
 }
 
 bool EventManager::CheckUiProcessors()
@@ -575,8 +568,7 @@ bool EventManager::CheckReplacement( PClassActor *replacee, PClassActor **replac
 	// This is play scope but unlike in-game events needs to be handled like UI by static handlers.
 	if (ShouldCallStatic(false)) final = staticEventManager.CheckReplacement(replacee, replacement);
 
-	for (DStaticEventHandler *handler = FirstEventHandler; handler; handler = handler->next)
-		handler->CheckReplacement(replacee,replacement,&final);
+	CallSubscribers(ESUB_CheckReplacement, [&](DStaticEventHandler* handler) { handler->CheckReplacement(replacee,replacement,&final); });
 	return final;
 }
 
@@ -585,8 +577,7 @@ bool EventManager::CheckReplacee(PClassActor **replacee, PClassActor *replacemen
 	bool final = false;
 	if (ShouldCallStatic(false)) final = staticEventManager.CheckReplacee(replacee, replacement);
 
-	for (DStaticEventHandler *handler = FirstEventHandler; handler; handler = handler->next)
-		handler->CheckReplacee(replacee, replacement, &final);
+	CallSubscribers(ESUB_CheckReplacee, [&](DStaticEventHandler* handler) { handler->CheckReplacee(replacee, replacement, &final); });
 	return final;
 }
 
@@ -720,6 +711,79 @@ static bool isEmptyInt(VMFunction *func)
 	return (code == nullptr || code->word == (0x00048000|OP_RET));
 }
 
+//==========================================================================
+//
+// Sorts the registered handlers into per-event lists, keeping only those
+// whose class actually overrides the event's virtual. With many handlers
+// loaded, this keeps the high-frequency events like WorldThingSpawned from
+// calling into every handler just to find an empty function.
+//
+//==========================================================================
+
+static const char *const SubscriptionNames[NUM_EVENTSUBSCRIPTIONS] =
+{
+	"WorldThingSpawned",
+	"WorldThingDied",
+	"WorldThingGround",
+	"WorldThingRevived",
+	"WorldThingDamaged",
+	"WorldThingDestroyed",
+	"WorldLinePreActivated",
+	"WorldLineActivated",
+	"WorldSectorDamaged",
+	"WorldLineDamaged",
+	"WorldLightning",
+	"WorldTick",
+	"RenderFrame",
+	"RenderOverlay",
+	"RenderUnderlay",
+	"UiTick",
+	"PostUiTick",
+	"CheckReplacement",
+	"CheckReplacee",
+};
+
+void EventManager::BuildSubscribers()
+{
+	static unsigned VIndices[NUM_EVENTSUBSCRIPTIONS];
+	static bool indicesSet = false;
+	if (!indicesSet)
+	{
+		for (int i = 0; i < NUM_EVENTSUBSCRIPTIONS; i++)
+		{
+			VIndices[i] = GetVirtualIndex(RUNTIME_CLASS(DStaticEventHandler), SubscriptionNames[i]);
+			assert(VIndices[i] != ~0u);
+		}
+		indicesSet = true;
+	}
+
+	for (auto &list : Subscribers) list.Clear();
+	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+	{
+		auto &virtuals = handler->GetClass()->Virtuals;
+		for (int i = 0; i < NUM_EVENTSUBSCRIPTIONS; i++)
+		{
+			VMFunction *func = virtuals.Size() > VIndices[i] ? virtuals[VIndices[i]] : nullptr;
+			if (func != nullptr && !isEmpty(func))
+			{
+				Subscribers[i].Push(handler);
+			}
+		}
+	}
+	SubscribersValid = true;
+}
+
+void EventManager::RemoveSubscriber(DStaticEventHandler* handler)
+{
+	for (auto &list : Subscribers)
+	{
+		for (auto &subscriber : list)
+		{
+			if (subscriber == handler) subscriber = nullptr;
+		}
+	}
+}
+
 // ===========================================
 //
 //  Event handlers
@@ -203,12 +203,45 @@ struct FReplacedEvent
 	bool IsFinal;
 };
 
+// events that are dispatched through per-event subscriber lists instead of walking all handlers.
+enum EEventSubscription
+{
+	ESUB_WorldThingSpawned,
+	ESUB_WorldThingDied,
+	ESUB_WorldThingGround,
+	ESUB_WorldThingRevived,
+	ESUB_WorldThingDamaged,
+	ESUB_WorldThingDestroyed,
+	ESUB_WorldLinePreActivated,
+	ESUB_WorldLineActivated,
+	ESUB_WorldSectorDamaged,
+	ESUB_WorldLineDamaged,
+	ESUB_WorldLightning,
+	ESUB_WorldTick,
+	ESUB_RenderFrame,
+	ESUB_RenderOverlay,
+	ESUB_RenderUnderlay,
+	ESUB_UiTick,
+	ESUB_PostUiTick,
+	ESUB_CheckReplacement,
+	ESUB_CheckReplacee,
+
+	NUM_EVENTSUBSCRIPTIONS
+};
+
 struct EventManager
 {
 	FLevelLocals *Level = nullptr;
 	DStaticEventHandler* FirstEventHandler = nullptr;
 	DStaticEventHandler* LastEventHandler = nullptr;
 
+	// handlers that override each event, in the same order as the handler list.
+	// These are rebuilt on demand after the handler list changes and are not serialized.
+	TArray<DStaticEventHandler*> Subscribers[NUM_EVENTSUBSCRIPTIONS];
+	bool SubscribersValid = false;
+	// number of CallSubscribers loops currently running. The lists are not rebuilt while this is non-zero.
+	int DispatchDepth = 0;
+
 	EventManager() = default;
 	EventManager(FLevelLocals *l) { Level = l; }
 	~EventManager() { Shutdown(); }
@@ -229,6 +262,48 @@ struct EventManager
 	// shutdown handlers
 	void Shutdown();
 
+	// mark the subscriber lists as stale. must be called whenever the handler list changes.
+	void InvalidateSubscribers() { SubscribersValid = false; }
+	// removed handlers are nulled out right away, as the lists may be in use by a dispatch.
+	void RemoveSubscriber(DStaticEventHandler* handler);
+	// get the handlers that override the given event.
+	// a handler list change during a dispatch only takes effect once the outermost dispatch has returned.
+	const TArray<DStaticEventHandler*>& GetSubscribers(EEventSubscription ev)
+	{
+		if (!SubscribersValid && DispatchDepth == 0) BuildSubscribers();
+		return Subscribers[ev];
+	}
+	void BuildSubscribers();
+
+	struct DispatchScope
+	{
+		EventManager* Manager;
+		DispatchScope(EventManager* manager) : Manager(manager) { Manager->DispatchDepth++; }
+		~DispatchScope() { Manager->DispatchDepth--; }
+	};
+
+	template<class Func> void CallSubscribers(EEventSubscription ev, Func func)
+	{
+		auto& list = GetSubscribers(ev);
+		DispatchScope scope(this);
+		for (unsigned i = 0; i < list.Size(); i++)
+		{
+			DStaticEventHandler* handler = list[i];
+			if (handler != nullptr && !(handler->ObjectFlags & OF_EuthanizeMe)) func(handler);
+		}
+	}
+
+	template<class Func> void CallSubscribersReverse(EEventSubscription ev, Func func)
+	{
+		auto& list = GetSubscribers(ev);
+		DispatchScope scope(this);
+		for (unsigned i = list.Size(); i-- > 0; )
+		{
+			DStaticEventHandler* handler = list[i];
+			if (handler != nullptr && !(handler->ObjectFlags & OF_EuthanizeMe)) func(handler);
+		}
+	}
+
 	// called right after the map has loaded (approximately same time as OPEN ACS scripts)
 	void WorldLoaded();
 	// called when the map is about to unload (approximately same time as UNLOADING ACS scripts)
@@ -308,6 +383,7 @@ struct EventManager
 		{
 			existinghandler->owner = this;
 		}
+		InvalidateSubscribers();
 	}
 
 };
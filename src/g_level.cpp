@@ -1995,16 +1995,20 @@ class DSectorMarker : public DObject
 	{
 		SECTORSTEPSIZE = 32,
 		POLYSTEPSIZE = 120,
-		SIDEDEFSTEPSIZE = 240
+		SIDEDEFSTEPSIZE = 240,
+		PARALLELSCANSIZE = 4096,
+		PARALLELSTEPSIZE = 4096
 	};
 	DECLARE_CLASS(DSectorMarker, DObject)
 public:
-	DSectorMarker(FLevelLocals *l) : Level(l), SecNum(0),PolyNum(0),SideNum(0) {}
+	DSectorMarker(FLevelLocals *l) : Level(l), SecNum(0),PolyNum(0),SideNum(0),ScanNum(-1) {}
 	size_t PropagateMark();
+	size_t PropagateMarkParallel();
 	FLevelLocals *Level;
 	int SecNum;
 	int PolyNum;
 	int SideNum;
+	int ScanNum;	// position of a parallel scan in progress, counting sectors, polyobjects and sidedefs in that order
 };
 
 IMPLEMENT_CLASS(DSectorMarker, true, false)
@@ -2024,6 +2028,12 @@ size_t DSectorMarker::PropagateMark()
 	int marked = 0;
 	bool moretodo = false;
 	int numsectors = Level->sectors.Size();
+
+	if (ScanNum >= 0 || (SecNum == 0 && GC::ParallelMarkAvailable() &&
+		Level->sectors.Size() + Level->sides.Size() >= PARALLELSCANSIZE))
+	{
+		return PropagateMarkParallel();
+	}
 	
 	for (i = 0; i < SECTORSTEPSIZE && SecNum + i < numsectors; ++i)
 	{
@@ -2079,6 +2089,72 @@ size_t DSectorMarker::PropagateMark()
 	return marked;
 }
 
+//==========================================================================
+//
+// DSectorMarker :: PropagateMarkParallel
+//
+// For large maps: Scans the sectors, polyobjects and sidedefs as one range,
+// PARALLELSTEPSIZE of them at a time split between the GC's marking
+// threads, and reinserts itself into the gray list if it didn't do them all.
+//
+//==========================================================================
+
+size_t DSectorMarker::PropagateMarkParallel()
+{
+	size_t numsectors = Level->sectors.Size();
+	size_t numpolys = Level->Polyobjects.Size();
+	size_t numsides = Level->sides.Size();
+	size_t total = numsectors + numpolys + numsides;
+	size_t start = ScanNum >= 0 ? MIN<size_t>(ScanNum, total) : 0;
+	size_t end = MIN<size_t>(start + PARALLELSTEPSIZE, total);
+
+	GC::MarkParallel(end - start, [=](size_t first, size_t last, TArray<DObject **> &out)
+	{
+		for (size_t i = start + first; i < start + last; i++)
+		{
+			if (i < numsectors)
+			{
+				sector_t *sec = &Level->sectors[i];
+				GC::Collect(sec->SoundTarget, out);
+				GC::Collect(sec->SecActTarget, out);
+				GC::Collect(sec->floordata, out);
+				GC::Collect(sec->ceilingdata, out);
+				GC::Collect(sec->lightingdata, out);
+				for (int j = 0; j < 4; j++) GC::Collect(sec->interpolations[j], out);
+			}
+			else if (i < numsectors + numpolys)
+			{
+				GC::Collect(Level->Polyobjects[i - numsectors].interpolation, out);
+			}
+			else
+			{
+				side_t *side = &Level->sides[i - numsectors - numpolys];
+				for (int j = 0; j < 3; j++) GC::Collect(side->textures[j].interpolation, out);
+			}
+		}
+	});
+
+	// Sizes of the parts of each list that were covered by this step.
+	auto covered = [=](size_t from, size_t to) { return MIN(end, to) > MAX(start, from) ? MIN(end, to) - MAX(start, from) : 0; };
+	size_t marked = covered(0, numsectors) * sizeof(sector_t) +
+		covered(numsectors, numsectors + numpolys) * sizeof(FPolyObj) +
+		covered(numsectors + numpolys, total) * sizeof(side_t);
+
+	if (end < total)
+	{
+		ScanNum = (int)end;
+		Black2Gray();
+		GCNext = GC::Gray;
+		GC::Gray = this;
+	}
+	else
+	{
+		ScanNum = -1;
+		SecNum = (int)numsectors;
+	}
+	return marked;
+}
+
 //==========================================================================
 //
 //
@@ -2111,6 +2187,7 @@ void FLevelLocals::Mark()
 	else
 	{
 		SectorMarker->SecNum = 0;
+		SectorMarker->ScanNum = -1;
 	}
 
 	GC::Mark(SectorMarker);
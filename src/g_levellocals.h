@@ -92,6 +92,35 @@ struct FPortalBits
 	}
 };
 
+//============================================================================
+//
+// Recycled instances of one actor class, see FLevelLocals::ReleaseToPool.
+// Parked actors are off the thinker lists and carry OF_EuthanizeMe, so the
+// rest of the engine (including the serializer) treats them as destroyed,
+// while OF_Fixed keeps the collector from freeing them.
+//
+//============================================================================
+
+struct FActorPool
+{
+	struct FResetRange
+	{
+		unsigned Offset;
+		unsigned Length;
+	};
+
+	TArray<AActor *> Actors;			// ready for reuse
+	TArray<FResetRange> ResetRanges;	// parts of the instance that get copied back from the defaults
+	unsigned Count = 0;					// parked actors, including those not yet reusable
+	int Limit = -1;						// < 0 means sv_actorpoolsize
+};
+
+struct FReleasedActor
+{
+	AActor *Actor;
+	int Cycle;							// GC::CycleCount at which no traced reference can still point to it
+};
+
 class DACSThinker;
 class DFraggleThinker;
 class DSpotState;
@@ -140,6 +169,12 @@ struct FLevelLocals
 	int TranslateSectorSpecial(int special);
 	bool IsTIDUsed(int tid);
 	int FindUniqueTID(int start_tid, int limit);
+	AActor *SpawnPooled(PClassActor *type, const DVector3 &pos, replace_t allowreplacement);
+	bool ReleaseToPool(AActor *actor);
+	void SetPoolLimit(PClassActor *type, int limit);
+	void RemovePooledActor(AActor *actor);
+	void RecycleReleasedActors();
+	void ClearActorPools();
 	int GetConversation(int conv_id);
 	int GetConversation(FName classname);
 	void SetConversation(int convid, PClassActor *Class, int dlgindex);
@@ -673,6 +708,8 @@ public:
 
 	// links to global game objects
 	TArray<TObjPtr<AActor *>> CorpseQueue;
+	TMap<PClassActor *, FActorPool> ActorPools;
+	TArray<FReleasedActor> ReleasedActors;	// waiting for the collector to clear references to them
 	TObjPtr<DFraggleThinker *> FraggleScriptThinker = nullptr;
 	TObjPtr<DACSThinker*> ACSThinker = nullptr;
 
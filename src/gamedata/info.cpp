@@ -144,7 +144,7 @@ void FState::CheckCallerType(AActor *self, AActor *stateowner)
 	
 	if (ActionFunc->ImplicitArgs >= 1)
 	{
-		auto argtypes = ActionFunc->Proto->ArgumentTypes;
+		auto &argtypes = ActionFunc->Proto->ArgumentTypes;
 		
 		CheckType(self, argtypes[0]);
 		
@@ -157,21 +157,105 @@ void FState::CheckCallerType(AActor *self, AActor *stateowner)
 
 TArray<VMValue> actionParams;
 
+//==========================================================================
+//
+// Action function call thunks
+//
+//==========================================================================
+
+// Direct natives that take nothing but 'self' and return nothing can be called without any marshalling.
+static void CallActionDirectSelf(FState *state, AActor *self, AActor *stateowner, FStateParamInfo *info, VMReturn *ret, int numret)
+{
+	reinterpret_cast<void(*)(AActor *)>(static_cast<VMNativeFunction *>(state->ActionFunc)->DirectNativeCall)(self);
+}
+
+// Action functions have never any explicit parameters but need to pass the defaults
+// and fill in the implicit arguments of the called function.
+static void FillActionParams(VMFunction *func, VMValue *params, AActor *self, AActor *stateowner, FStateParamInfo *info)
+{
+	auto &defs = func->DefaultArgs;
+	for (unsigned i = 0; i < defs.Size(); i++)
+	{
+		params[i] = defs[i];
+	}
+
+	if (func->ImplicitArgs >= 1)
+	{
+		params[0] = self;
+	}
+	if (func->ImplicitArgs == 3)
+	{
+		params[1] = stateowner;
+		params[2] = VMValue(info);
+	}
+}
+
+static void CallActionVM(FState *state, AActor *self, AActor *stateowner, FStateParamInfo *info, VMReturn *ret, int numret)
+{
+	auto func = state->ActionFunc;
+	unsigned numparams = func->DefaultArgs.Size();
+
+	if (numparams == 0)
+	{
+		VMValue params[3] = { self, stateowner, VMValue(info) };
+		VMCallAction(func, params, func->ImplicitArgs, ret, numret);
+	}
+	else if (numparams <= 16)
+	{
+		VMValue params[16];
+		FillActionParams(func, params, self, stateowner, info);
+		VMCallAction(func, params, numparams, ret, numret);
+	}
+	else
+	{
+		auto index = actionParams.Reserve(numparams);
+		FillActionParams(func, &actionParams[index], self, stateowner, info);
+		VMCallAction(func, &actionParams[index], numparams, ret, numret);
+		actionParams.Clamp(index);
+	}
+}
+
+//==========================================================================
+//
+// FState :: BindAction
+//
+// Picks the cheapest way to call the current action function.
+//
+//==========================================================================
+
+void FState::BindAction()
+{
+	auto func = ActionFunc;
+	BoundAction = func;
+	ActionCall = CallActionVM;
+	ActionReturnsState = false;
+	if (func == nullptr || func->Proto == nullptr) return;
+
+	auto proto = func->Proto;
+	ActionReturnsState = proto->ReturnTypes.Size() > 0 && proto->ReturnTypes[0] == TypeState;
+
+	if ((func->VarFlags & VARF_Native) && static_cast<VMNativeFunction *>(func)->DirectNativeCall != nullptr &&
+		func->ImplicitArgs == 1 && proto->ArgumentTypes.Size() == 1 && proto->ReturnTypes.Size() == 0)
+	{
+		ActionCall = CallActionDirectSelf;
+	}
+}
+
 bool FState::CallAction(AActor *self, AActor *stateowner, FStateParamInfo *info, FState **stateret)
 {
 	if (ActionFunc != nullptr)
 	{
 		ActionCycles.Clock();
 
+		if (BoundAction != ActionFunc) BindAction();
+
 		// If the function returns a state, store it at *stateret.
 		// If it doesn't return a state but stateret is non-nullptr, we need
 		// to set *stateret to nullptr.
 		if (stateret != nullptr)
 		{
 			*stateret = nullptr;
-			if (ActionFunc->Proto == nullptr ||
-				ActionFunc->Proto->ReturnTypes.Size() == 0 ||
-				ActionFunc->Proto->ReturnTypes[0] != TypeState)
+			if (!ActionReturnsState)
 			{
 				stateret = nullptr;
 			}
@@ -182,37 +266,7 @@ bool FState::CallAction(AActor *self, AActor *stateowner, FStateParamInfo *info,
 		try
 		{
 			CheckCallerType(self, stateowner);
-
-			// Build the parameter array. Action functions have never any explicit parameters but need to pass the defaults
-			// and fill in the implicit arguments of the called function.
-
-			if (ActionFunc->DefaultArgs.Size() > 0)
-			{
-				auto defs = ActionFunc->DefaultArgs;
-				auto index = actionParams.Reserve(defs.Size());
-				for (unsigned i = 0; i < defs.Size(); i++)
-				{
-					actionParams[i + index] = defs[i];
-				}
-
-				if (ActionFunc->ImplicitArgs >= 1)
-				{
-					actionParams[index] = self;
-				}
-				if (ActionFunc->ImplicitArgs == 3)
-				{
-					actionParams[index + 1] = stateowner;
-					actionParams[index + 2] = VMValue(info);
-				}
-
-				VMCallAction(ActionFunc, &actionParams[index], ActionFunc->DefaultArgs.Size(), &ret, stateret != nullptr);
-				actionParams.Clamp(index);
-			}
-			else
-			{
-				VMValue params[3] = { self, stateowner, VMValue(info) };
-				VMCallAction(ActionFunc, params, ActionFunc->ImplicitArgs, &ret, stateret != nullptr);
-			}
+			ActionCall(this, self, stateowner, info, &ret, stateret != nullptr);
 		}
 		catch (CVMAbortException &err)
 		{
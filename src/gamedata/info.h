@@ -88,6 +88,9 @@ struct FStateParamInfo
 	int mPSPIndex;
 };
 
+struct VMReturn;
+typedef void (*ActionCallThunk)(FState *state, AActor *self, AActor *stateowner, FStateParamInfo *info, VMReturn *ret, int numret);
+
 
 // Sprites that are fixed in position because they can have special meanings.
 enum
@@ -111,6 +114,12 @@ struct FState
 	uint8_t		DefineFlags;
 	int32_t		Misc1;			// Was changed to int8_t, reverted to long for MBF compat
 	int32_t		Misc2;			// Was changed to uint8_t, reverted to long for MBF compat
+
+	// The way ActionFunc gets called is decided once and cached here. Since ActionFunc gets
+	// changed directly in a few places, the function the thunk was bound for is stored as well.
+	VMFunction	*BoundAction;
+	ActionCallThunk ActionCall;
+	bool		ActionReturnsState;
 public:
 	inline int GetFrame() const
 	{
@@ -168,6 +177,12 @@ public:
 	void ClearAction() { ActionFunc = NULL; }
 	void SetAction(const char *name);
 	bool CallAction(AActor *self, AActor *stateowner, FStateParamInfo *stateinfo, FState **stateret);
+	void InvokeAction(AActor *self, AActor *stateowner, FStateParamInfo *stateinfo, VMReturn *ret, int numret)
+	{
+		if (BoundAction != ActionFunc) BindAction();
+		ActionCall(this, self, stateowner, stateinfo, ret, numret);
+	}
+	void BindAction();
     void CheckCallerType(AActor *self, AActor *stateowner);
 
 	static PClassActor *StaticFindStateOwner (const FState *state);
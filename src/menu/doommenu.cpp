@@ -80,6 +80,7 @@ void I_WaitVBL(int count);
 
 
 FNewGameStartup NewGameStartupInfo;
+static FString NewGamePlayerClass;	// storage for NewGameStartupInfo.PlayerClass
 
 
 bool M_SetSpecialMenu(FName& menu, int param)
@@ -124,7 +125,7 @@ bool M_SetSpecialMenu(FName& menu, int param)
 		NewGameStartupInfo.Episode = -1;
 		NewGameStartupInfo.PlayerClass = 
 			param == -1000? nullptr :
-			param == -1? "Random" : GetPrintableDisplayName(PlayerClasses[param].Type).GetChars();
+			param == -1? "Random" : (NewGamePlayerClass = GetPrintableDisplayName(PlayerClasses[param].Type)).GetChars();
 		M_StartupEpisodeMenu(&NewGameStartupInfo);	// needs player class name from class menu (later)
 		break;
 
@@ -698,11 +699,7 @@ static void BuildPlayerclassMenu()
 			{
 				if (!(PlayerClasses[i].Flags & PCF_NOMENU))
 				{
-					const char *pname = GetPrintableDisplayName(PlayerClasses[i].Type);
-					if (pname != nullptr)
-					{
-						numclassitems++;
-					}
+					numclassitems++;
 				}
 			}
 
@@ -735,15 +732,12 @@ static void BuildPlayerclassMenu()
 				{
 					if (!(PlayerClasses[i].Flags & PCF_NOMENU))
 					{
-						const char *pname = GetPrintableDisplayName(PlayerClasses[i].Type);
-						if (pname != nullptr)
-						{
-							auto it = CreateListMenuItemText(ld->mXpos, ld->mYpos, ld->mLinespacing, *pname,
-								pname, ld->mFont,ld->mFontColor,ld->mFontColor2, NAME_Episodemenu, i);
-							ld->mItems.Push(it);
-							ld->mYpos += ld->mLinespacing;
-							n++;
-						}
+						FString pname = GetPrintableDisplayName(PlayerClasses[i].Type);
+						auto it = CreateListMenuItemText(ld->mXpos, ld->mYpos, ld->mLinespacing, pname[0],
+							pname.GetChars(), ld->mFont,ld->mFontColor,ld->mFontColor2, NAME_Episodemenu, i);
+						ld->mItems.Push(it);
+						ld->mYpos += ld->mLinespacing;
+						n++;
 					}
 				}
 				if (n > 1 && !gameinfo.norandomplayerclass)
@@ -754,13 +748,10 @@ static void BuildPlayerclassMenu()
 				}
 				if (n == 0)
 				{
-					const char *pname = GetPrintableDisplayName(PlayerClasses[0].Type);
-					if (pname != nullptr)
-					{
-						auto it = CreateListMenuItemText(ld->mXpos, ld->mYpos, ld->mLinespacing, *pname,
-							pname, ld->mFont,ld->mFontColor,ld->mFontColor2, NAME_Episodemenu, 0);
-						ld->mItems.Push(it);
-					}
+					FString pname = GetPrintableDisplayName(PlayerClasses[0].Type);
+					auto it = CreateListMenuItemText(ld->mXpos, ld->mYpos, ld->mLinespacing, pname[0],
+						pname.GetChars(), ld->mFont,ld->mFontColor,ld->mFontColor2, NAME_Episodemenu, 0);
+					ld->mItems.Push(it);
 				}
 				success = true;
 				for (auto &p : ld->mItems)
@@ -792,13 +783,10 @@ static void BuildPlayerclassMenu()
 		{
 			if (!(PlayerClasses[i].Flags & PCF_NOMENU))
 			{
-				const char *pname = GetPrintableDisplayName(PlayerClasses[i].Type);
-				if (pname != nullptr)
-				{
-					auto it = CreateOptionMenuItemSubmenu(pname, "Episodemenu", i);
-					od->mItems.Push(it);
-					GC::WriteBarrier(od, it);
-				}
+				FString pname = GetPrintableDisplayName(PlayerClasses[i].Type);
+				auto it = CreateOptionMenuItemSubmenu(pname.GetChars(), "Episodemenu", i);
+				od->mItems.Push(it);
+				GC::WriteBarrier(od, it);
 			}
 		}
 		auto it = CreateOptionMenuItemSubmenu("Random", "Episodemenu", -1);
@@ -134,9 +134,9 @@ DEFINE_ACTION_FUNCTION(DPlayerMenu, ClassChanged)
 	PARAM_POINTER(cls, FPlayerClass);
 	if (DMenu::InMenu)
 	{
-		const char *pclass = sel == -1 ? "Random" : GetPrintableDisplayName(cls->Type).GetChars();
-		players[consoleplayer].userinfo.PlayerClassChanged(pclass);
-		cvar_set("playerclass", pclass);
+		FString pclass = sel == -1 ? FString("Random") : GetPrintableDisplayName(cls->Type);
+		players[consoleplayer].userinfo.PlayerClassChanged(pclass.GetChars());
+		cvar_set("playerclass", pclass.GetChars());
 	}
 	return 0;
 }
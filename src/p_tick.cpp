@@ -171,6 +171,7 @@ void P_Ticker (void)
 		Level->localEventManager->WorldTick();
 		Level->Tick();			// [RH] let the level tick
 		Level->Thinkers.RunThinkers(Level);
+		Level->RecycleReleasedActors();
 
 		//if added by MC: Freeze mode.
 		if (!Level->isFrozen())
@@ -659,6 +659,7 @@ public:
 	~AActor ();
 
 	virtual void OnDestroy() override;
+	void Unspawn();		// Unlinks everything OnDestroy tears down, without the thinker list
 	virtual void Serialize(FSerializer &arc) override;
 	virtual void PostSerialize() override;
 	virtual void PostBeginPlay() override;		// Called immediately before the actor's first tick
@@ -155,7 +155,7 @@ static void add_char(char *tokn, char c)
 
 //==========================================================================
 //
-// get_tokens.
+// tokenize_statement.
 // Take a string, break it into tokens.
 //
 // individual tokens are stored inside the tokens[] array
@@ -175,7 +175,7 @@ static void add_char(char *tokn, char c)
 //
 //==========================================================================
 
-char *FParser::GetTokens(char *s)
+char *FParser::TokenizeStatement(char *s)
 {
 	char *tokn = NULL;
 
@@ -283,6 +283,115 @@ char *FParser::GetTokens(char *s)
 	return Rover;
 }
 
+//==========================================================================
+//
+// ClassifyTokens
+//
+// Looks up what the expression evaluator needs to know about each token:
+// which operator it is and which global function it names. Functions
+// only ever live in the global script, which does not change once the
+// thinker is set up.
+//
+//==========================================================================
+
+void FParser::ClassifyTokens()
+{
+	DFsScript *global = Level->FraggleScriptThinker ? Level->FraggleScriptThinker->GlobalScript.Get() : nullptr;
+
+	for (int i = 0; i < NumTokens; i++)
+	{
+		TokenOperator[i] = -1;
+		TokenFunction[i] = nullptr;
+		if (TokenType[i] == operator_)
+		{
+			for (int op = 0; op < num_operators; op++)
+			{
+				if (!strcmp(Tokens[i], operators[op].string))
+				{
+					TokenOperator[i] = op;
+					break;
+				}
+			}
+		}
+		else if ((TokenType[i] == function || TokenType[i] == name_) && global != nullptr)
+		{
+			DFsVariable *func = global->VariableForName(Tokens[i]);
+			if (func != nullptr && (func->type == svt_function || func->type == svt_linespec))
+			{
+				TokenFunction[i] = func;
+			}
+		}
+	}
+}
+
+//==========================================================================
+//
+// get_tokens.
+//
+// Tokenizes the statement at s, or copies the tokens from the script's
+// statement cache if it was already tokenized before. Statements outside
+// the script's own data (i.e. in included lumps) are not cached.
+//
+//==========================================================================
+
+char *FParser::GetTokens(char *s)
+{
+	char *data = Script->Data.Data();
+	if (data == nullptr || s < data || s >= data + Script->len)
+	{
+		TokenizeStatement(s);
+		ClassifyTokens();
+		return Rover;
+	}
+
+	int start = Script->MakeIndex(s);
+	unsigned *cached = Script->StatementMap.CheckKey(start);
+	if (cached != nullptr)
+	{
+		const DFsScript::FStatement &st = Script->Statements[*cached];
+		if (st.TextLen > 0) memcpy(Tokens[0], &Script->StatementText[st.Text], st.TextLen);
+		Tokens[0][st.TextLen] = 0;
+		NumTokens = st.NumTokens;
+		for (int i = 0; i < NumTokens; i++)
+		{
+			const DFsScript::FStatementToken &tok = Script->StatementTokens[st.FirstToken + i];
+			Tokens[i] = Tokens[0] + tok.Offset;
+			TokenType[i] = tok.Type;
+			TokenOperator[i] = tok.Operator;
+			TokenFunction[i] = tok.Function;
+		}
+		Section = st.Section;
+		if (Section) BraceType = st.BraceType;
+		LineStart = data + st.LineStart;
+		Rover = data + st.Next;
+		return Rover;
+	}
+
+	TokenizeStatement(s);
+	ClassifyTokens();
+
+	DFsScript::FStatement st;
+	st.Next = Script->MakeIndex(Rover);
+	st.LineStart = Script->MakeIndex(LineStart);
+	st.BraceType = BraceType;
+	st.Section = Section;
+	st.FirstToken = Script->StatementTokens.Size();
+	st.NumTokens = NumTokens;
+	st.Text = Script->StatementText.Size();
+	st.TextLen = NumTokens > 0 ? unsigned(Tokens[NumTokens - 1] + strlen(Tokens[NumTokens - 1]) - Tokens[0]) : 0;
+	if (st.TextLen > 0)
+	{
+		Script->StatementText.Resize(st.Text + st.TextLen);
+		memcpy(&Script->StatementText[st.Text], Tokens[0], st.TextLen);
+	}
+	for (int i = 0; i < NumTokens; i++)
+	{
+		Script->StatementTokens.Push({ unsigned(Tokens[i] - Tokens[0]), TokenType[i], TokenOperator[i], TokenFunction[i] });
+	}
+	Script->StatementMap[start] = Script->Statements.Push(st);
+	return Rover;
+}
+
 
 //==========================================================================
 //
@@ -647,25 +756,44 @@ void FParser::EvaluateExpression(svalue_t &result, int start, int stop)
     }
 	
 	// go through each operator in order of precedence
-	for(i=0; i<num_operators; i++)
-    {
-		// check backwards for the token. it has to be
-		// done backwards for left-to-right reading: eg so
-		// 5-3-2 is (5-3)-2 not 5-(3-2)
-		
-		if (operators[i].direction==forward)
+	// Instead of searching for each operator in turn, find the position of
+	// every operator outside brackets in one go and pick the one with the
+	// highest precedence.
+	int found[MAX_OPERATORS];
+	for (i = 0; i < num_operators; i++) found[i] = -1;
+
+	// check backwards for the token. it has to be
+	// done backwards for left-to-right reading: eg so
+	// 5-3-2 is (5-3)-2 not 5-(3-2)
+	int bracketlevel = 0;
+	for (n = stop; n >= start; n--)
+	{
+		if (TokenType[n] != operator_) continue;
+		bracketlevel += Tokens[n][0] == '(' ? -1 : Tokens[n][0] == ')' ? 1 : 0;
+		int op = TokenOperator[n];
+		if (!bracketlevel && op >= 0 && operators[op].direction == forward && found[op] == -1)
 		{
-			n = FindOperatorBackwards(start, stop, operators[i].string);
+			found[op] = n;
 		}
-		else
+	}
+	bracketlevel = 0;
+	for (n = start; n <= stop; n++)
+	{
+		if (TokenType[n] != operator_) continue;
+		bracketlevel += Tokens[n][0] == '(' ? 1 : Tokens[n][0] == ')' ? -1 : 0;
+		int op = TokenOperator[n];
+		if (!bracketlevel && op >= 0 && operators[op].direction == backward && found[op] == -1)
 		{
-			n = FindOperator(start, stop, operators[i].string);
+			found[op] = n;
 		}
+	}
 
-		if( n != -1)
+	for(i=0; i<num_operators; i++)
+    {
+		if(found[i] != -1)
 		{
 			// call the operator function and evaluate this chunk of tokens
-			(this->*operators[i].handler)(result, start, n, stop);
+			(this->*operators[i].handler)(result, start, found[i], stop);
 			return;
 		}
     }
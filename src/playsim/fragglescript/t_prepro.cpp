@@ -133,6 +133,8 @@ void DFsScript::ClearSections()
 		}
 		sections[i] = nullptr;
 	}
+	// The cached statements point to the sections.
+	ClearStatements();
 }
 
 //==========================================================================
@@ -382,6 +384,20 @@ void DFsScript::DryRunScript(FLevelLocals *Level)
 	}
 }
 
+//==========================================================================
+//
+// Discards all tokenized statements
+//
+//==========================================================================
+
+void DFsScript::ClearStatements()
+{
+	StatementMap.Clear();
+	Statements.Clear();
+	StatementTokens.Clear();
+	StatementText.Clear();
+}
+
 //==========================================================================
 //
 // main preprocess function
@@ -390,6 +406,7 @@ void DFsScript::DryRunScript(FLevelLocals *Level)
 
 void DFsScript::Preprocess(FLevelLocals *Level)
 {
+	ClearStatements();
 	len = (int)Data.Size() - 1;
 	ProcessFindChar(Data.Data(), 0);  // fill in everything
 	DryRunScript(Level);
@@ -334,6 +334,35 @@ public:
 	bool lastiftrue;     // haleyjd: whether last "if" statement was 
 	// true or false
 
+	// Statements as split into tokens by FParser, keyed by their offset in
+	// Data. The dry run fills this in, so the text of a statement only gets
+	// tokenized once. This is not serialized and gets rebuilt on demand
+	// after loading a savegame.
+	struct FStatement
+	{
+		int Next;			// offset of the following statement
+		int LineStart;
+		int BraceType;
+		DFsSection *Section;
+		unsigned FirstToken;
+		int NumTokens;
+		unsigned Text;
+		unsigned TextLen;
+	};
+
+	struct FStatementToken
+	{
+		unsigned Offset;	// into the statement's text
+		tokentype_t Type;
+		int Operator;		// index into FParser::operators or -1
+		DFsVariable *Function;
+	};
+
+	TOpenMap<int, unsigned> StatementMap;
+	TArray<FStatement> Statements;
+	TArray<FStatementToken> StatementTokens;
+	TArray<char> StatementText;
+
 	DFsScript();
 	void OnDestroy() override;
 	void Serialize(FSerializer &ar);
@@ -352,6 +381,7 @@ public:
 	char *SectionLoop(const DFsSection *sec);
 	void ClearSections();
 	void ClearChildren();
+	void ClearStatements();
 
 	int MakeIndex(const char *p) { return int(p-Data.Data()); }
 
@@ -389,6 +419,8 @@ struct FParser
 		backward
 	};
 
+	enum { MAX_OPERATORS = 32 };
+
 	static operator_t operators[];
 	static int num_operators;
 
@@ -398,6 +430,8 @@ struct FParser
 
 	char *Tokens[T_MAXTOKENS];
 	tokentype_t TokenType[T_MAXTOKENS];
+	int TokenOperator[T_MAXTOKENS];			// index into operators or -1
+	DFsVariable *TokenFunction[T_MAXTOKENS];	// global function with the token's name
 	int NumTokens;
 	FLevelLocals *Level;
 	DFsScript *Script;       // the current script
@@ -429,6 +463,8 @@ struct FParser
 
 	void NextToken();
 	char *GetTokens(char *s);
+	char *TokenizeStatement(char *s);
+	void ClassifyTokens();
 	void PrintTokens();
 	void ErrorMessage(FString msg);
 
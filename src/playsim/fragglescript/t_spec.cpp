@@ -468,7 +468,9 @@ void FParser::EvaluateFunction(svalue_t &result, int start, int stop)
 	}
 	
 	// all the functions are stored in the global script
-	else if( !(func = Level->FraggleScriptThinker->GlobalScript->VariableForName (Tokens[start]))  )
+	// (usually already looked up when the statement was tokenized)
+	else if( !(func = TokenFunction[start]) &&
+		!(func = Level->FraggleScriptThinker->GlobalScript->VariableForName (Tokens[start]))  )
 	{
 		script_error("no such function: '%s'\n",Tokens[start]);
 	}
@@ -552,7 +554,8 @@ void FParser::OPstructure(svalue_t &result, int start, int n, int stop)
 	svalue_t argv[MAXARGS];
 	
 	// all the functions are stored in the global script
-	if( !(func = Level->FraggleScriptThinker->GlobalScript->VariableForName (Tokens[n+1]))  )
+	if( !(n+1 < NumTokens && (func = TokenFunction[n+1])) &&
+		!(func = Level->FraggleScriptThinker->GlobalScript->VariableForName (Tokens[n+1]))  )
 	{
 		script_error("no such function: '%s'\n",Tokens[n+1]);
 	}
@@ -78,6 +78,14 @@
 #include "s_music.h"
 #include "v_video.h"
 #include "texturemanager.h"
+#include "i_time.h"
+
+#ifdef HAVE_VM_JIT
+#define ASMJIT_BUILD_EMBED
+#define ASMJIT_STATIC
+#include <asmjit/asmjit.h>
+#include <asmjit/x86.h>
+#endif
 
 	// P-codes for ACS scripts
 	enum
@@ -913,27 +921,25 @@ FACSStack::~FACSStack()
 
 ACSStringPool GlobalACSStrings;
 
-void ACSStringPool::PoolEntry::Lock(int levelnum)
-{
-	if (Locks.Find(levelnum) == Locks.Size())
-	{
-		Locks.Push(levelnum);
-	}
-}
+// Time in microseconds that may be spent per tic on freeing unused strings.
+// 0 frees them all at once.
+CVAR(Int, acs_gcbudget, 250, 0)
 
-void ACSStringPool::PoolEntry::Unlock(int levelnum)
+static void SetLockBit(TArray<uint32_t> &bits, unsigned int num)
 {
-	auto ndx = Locks.Find(levelnum);
-	if (ndx < Locks.Size())
+	unsigned int word = num >> 5;
+	if (word >= bits.Size())
 	{
-		Locks.Delete(ndx);
+		unsigned int oldsize = bits.Size();
+		bits.Resize(word + 1);
+		memset(&bits[oldsize], 0, (word + 1 - oldsize) * sizeof(uint32_t));
 	}
+	bits[word] |= 1u << (num & 31);
 }
 
 ACSStringPool::ACSStringPool()
 {
-	memset(PoolBuckets, 0xFF, sizeof(PoolBuckets));
-	FirstFreeEntry = 0;
+	Clear();
 }
 
 //============================================================================
@@ -947,8 +953,13 @@ ACSStringPool::ACSStringPool()
 void ACSStringPool::Clear()
 {
 	Pool.Clear();
-	memset(PoolBuckets, 0xFF, sizeof(PoolBuckets));
-	FirstFreeEntry = 0;
+	FreeEntries.Clear();
+	Locks.Clear();
+	NumUsed = 0;
+	GCThreshold = MIN_GC_SIZE;
+	Sweeping = false;
+	SweepPos = 0;
+	ResizeIndex(MIN_INDEX_SIZE);
 }
 
 //============================================================================
@@ -965,26 +976,24 @@ int ACSStringPool::AddString(const char *str)
 	if (str == nullptr) str = "";
 	size_t len = strlen(str);
 	unsigned int h = SuperFastHash(str, len);
-	unsigned int bucketnum = h % NUM_BUCKETS;
-	int i = FindString(str, len, h, bucketnum);
+	int i = FindString(str, len, h);
 	if (i >= 0)
 	{
 		return i | STRPOOL_LIBRARYID_OR;
 	}
 	FString fstr(str);
-	return InsertString(fstr, h, bucketnum);
+	return InsertString(fstr, h);
 }
 
 int ACSStringPool::AddString(FString &str)
 {
 	unsigned int h = SuperFastHash(str.GetChars(), str.Len());
-	unsigned int bucketnum = h % NUM_BUCKETS;
-	int i = FindString(str, str.Len(), h, bucketnum);
+	int i = FindString(str, str.Len(), h);
 	if (i >= 0)
 	{
 		return i | STRPOOL_LIBRARYID_OR;
 	}
-	return InsertString(str, h, bucketnum);
+	return InsertString(str, h);
 }
 
 //============================================================================
@@ -997,13 +1006,55 @@ const char *ACSStringPool::GetString(int strnum)
 {
 	assert((strnum & LIBRARYID_MASK) == STRPOOL_LIBRARYID_OR);
 	strnum &= ~LIBRARYID_MASK;
-	if ((unsigned)strnum < Pool.Size() && Pool[strnum].Next != FREE_ENTRY)
+	if ((unsigned)strnum < Pool.Size() && Pool[strnum].Used)
 	{
 		return Pool[strnum].Str;
 	}
 	return NULL;
 }
 
+//============================================================================
+//
+// ACSStringPool :: GetLockSet
+//
+// Returns the lock bits for a level, creating them if needed.
+//
+//============================================================================
+
+ACSStringPool::LockSet &ACSStringPool::GetLockSet(int levelnum)
+{
+	for (auto &set : Locks)
+	{
+		if (set.Level == levelnum)
+		{
+			return set;
+		}
+	}
+	auto &set = Locks[Locks.Reserve(1)];
+	set.Level = levelnum;
+	return set;
+}
+
+//============================================================================
+//
+// ACSStringPool :: IsLocked
+//
+//============================================================================
+
+bool ACSStringPool::IsLocked(unsigned int num) const
+{
+	unsigned int word = num >> 5;
+	uint32_t bit = 1u << (num & 31);
+	for (auto &set : Locks)
+	{
+		if (word < set.Bits.Size() && (set.Bits[word] & bit))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 //============================================================================
 //
 // ACSStringPool :: LockString
@@ -1017,7 +1068,10 @@ void ACSStringPool::LockString(int levelnum, int strnum)
 	assert((strnum & LIBRARYID_MASK) == STRPOOL_LIBRARYID_OR);
 	strnum &= ~LIBRARYID_MASK;
 	assert((unsigned)strnum < Pool.Size());
-	Pool[strnum].Lock(levelnum);
+	if (Pool[strnum].Used)
+	{
+		SetLockBit(GetLockSet(levelnum).Bits, strnum);
+	}
 }
 
 //============================================================================
@@ -1051,15 +1105,17 @@ void ACSStringPool::MarkString(int strnum)
 
 void ACSStringPool::LockStringArray(int levelnum, const int *strnum, unsigned int count)
 {
+	TArray<uint32_t> *bits = nullptr;
 	for (unsigned int i = 0; i < count; ++i)
 	{
 		int num = strnum[i];
 		if ((num & LIBRARYID_MASK) == STRPOOL_LIBRARYID_OR)
 		{
 			num &= ~LIBRARYID_MASK;
-			if ((unsigned)num < Pool.Size())
+			if ((unsigned)num < Pool.Size() && Pool[num].Used)
 			{
-				Pool[num].Lock(levelnum);
+				if (bits == nullptr) bits = &GetLockSet(levelnum).Bits;
+				SetLockBit(*bits, num);
 			}
 		}
 	}
@@ -1127,11 +1183,13 @@ void ACSStringPool::MarkStringMap(const FWorldGlobalArray &aray)
 
 void ACSStringPool::UnlockAll()
 {
+	// The sweep in progress was started with these locks in place.
+	FinishSweep();
 	for (unsigned int i = 0; i < Pool.Size(); ++i)
 	{
 		Pool[i].Mark = false;
-		Pool[i].Locks.Clear();
 	}
+	Locks.Clear();
 }
 
 //============================================================================
@@ -1144,39 +1202,94 @@ void ACSStringPool::UnlockAll()
 
 void ACSStringPool::PurgeStrings()
 {
-	// Clear the hash buckets. We'll rebuild them as we decide what strings
-	// to keep and which to toss.
-	memset(PoolBuckets, 0xFF, sizeof(PoolBuckets));
-	size_t usedcount = 0, freedcount = 0;
-	for (unsigned int i = 0; i < Pool.Size(); ++i)
+	// Restart any sweep in progress from the beginning so that everything
+	// is checked against the current marks.
+	Sweeping = true;
+	SweepPos = 0;
+	FinishSweep();
+}
+
+//============================================================================
+//
+// ACSStringPool :: StartSweep
+//
+// Begins freeing all strings that are neither marked nor locked. The caller
+// must have marked everything that is in use. The sweep is then spread over
+// several calls to SweepStep. Strings that get handed out again before the
+// sweep reaches them are kept.
+//
+//============================================================================
+
+void ACSStringPool::StartSweep()
+{
+	Sweeping = true;
+	SweepPos = 0;
+}
+
+//============================================================================
+//
+// ACSStringPool :: SweepStep
+//
+// Continues the sweep until it is done or the deadline (from I_nsTime)
+// has passed. Returns true if the sweep is done.
+//
+//============================================================================
+
+bool ACSStringPool::SweepStep(uint64_t deadline)
+{
+	enum { ENTRIES_PER_CHECK = 128 };
+
+	while (Sweeping && SweepPos < Pool.Size())
 	{
-		PoolEntry *entry = &Pool[i];
-		if (entry->Next != FREE_ENTRY)
+		unsigned int end = std::min(SweepPos + ENTRIES_PER_CHECK, Pool.Size());
+		for (; SweepPos < end; SweepPos++)
 		{
-			if (entry->Locks.Size() == 0 && !entry->Mark)
+			PoolEntry *entry = &Pool[SweepPos];
+			if (entry->Used)
 			{
-				freedcount++;
-				// Mark this entry as free.
-				entry->Next = FREE_ENTRY;
-				if (i < FirstFreeEntry)
+				if (entry->Mark || IsLocked(SweepPos))
 				{
-					FirstFreeEntry = i;
+					entry->Mark = false;
+				}
+				else
+				{
+					FreeEntry(SweepPos);
 				}
-				// And free the string.
-				entry->Str = "";
-			}
-			else
-			{
-				usedcount++;
-				// Rehash this entry.
-				unsigned int h = entry->Hash % NUM_BUCKETS;
-				entry->Next = PoolBuckets[h];
-				PoolBuckets[h] = i;
-				// Remove MarkString's mark.
-				entry->Mark = false;
 			}
 		}
+		if (SweepPos < Pool.Size() && I_nsTime() >= deadline)
+		{
+			return false;
+		}
+	}
+	if (Sweeping)
+	{
+		Sweeping = false;
+		GCThreshold = std::max<unsigned int>(MIN_GC_SIZE, NumUsed * 2);
 	}
+	return true;
+}
+
+void ACSStringPool::FinishSweep()
+{
+	SweepStep(UINT64_MAX);
+}
+
+//============================================================================
+//
+// ACSStringPool :: FreeEntry
+//
+//============================================================================
+
+void ACSStringPool::FreeEntry(unsigned int num)
+{
+	PoolEntry *entry = &Pool[num];
+	RemoveIndex(num);
+	entry->Str = "";
+	entry->Used = false;
+	entry->Mark = false;
+	FreeEntries.Push(num);
+	NumUsed--;
 }
 
 //============================================================================
@@ -1188,77 +1301,165 @@ void ACSStringPool::PurgeStrings()
 //
 //============================================================================
 
-int ACSStringPool::FindString(const char *str, size_t len, unsigned int h, unsigned int bucketnum)
+int ACSStringPool::FindString(const char *str, size_t len, unsigned int h)
 {
-	unsigned int i = PoolBuckets[bucketnum];
-	while (i != NO_ENTRY)
+	unsigned int mask = Index.Size() - 1;
+	for (unsigned int slot = h & mask; ; slot = (slot + 1) & mask)
 	{
-		PoolEntry *entry = &Pool[i];
-		assert(entry->Next != FREE_ENTRY);
-		if (entry->Hash == h && entry->Str.Len() == len &&
-			memcmp(entry->Str.GetChars(), str, len) == 0)
+		unsigned int i = Index[slot];
+		if (i == NO_ENTRY)
+		{
+			return -1;
+		}
+		if (i != DELETED_ENTRY)
 		{
-			return i;
+			PoolEntry *entry = &Pool[i];
+			assert(entry->Used);
+			if (entry->Hash == h && entry->Str.Len() == len &&
+				memcmp(entry->Str.GetChars(), str, len) == 0)
+			{
+				// The string is in use again, so the sweep must not free it.
+				if (Sweeping && i >= SweepPos)
+				{
+					entry->Mark = true;
+				}
+				return i;
+			}
 		}
-		i = entry->Next;
 	}
-	return -1;
 }
 
 //============================================================================
 //
 // ACSStringPool :: InsertString
 //
-// Inserts a new string into the pool.
+// Inserts a new string into the pool. If the pool has no room left, the
+// incremental collection is not given time to catch up: any sweep in
+// progress is finished right away, and if that frees nothing, a full
+// collection is done.
 //
 //============================================================================
 
-int ACSStringPool::InsertString(FString &str, unsigned int h, unsigned int bucketnum)
+int ACSStringPool::InsertString(FString &str, unsigned int h)
 {
-	unsigned int index = FirstFreeEntry;
-	if (index >= MIN_GC_SIZE && index == Pool.Max())
-	{ // We will need to grow the array. Try a garbage collection first.
-		P_CollectACSGlobalStrings();
-		index = FirstFreeEntry;
+	if (FreeEntries.Size() == 0 && Pool.Size() >= MAX_POOL_SIZE)
+	{
+		FinishSweep();
+		if (FreeEntries.Size() == 0 && this == &GlobalACSStrings)
+		{
+			P_CollectACSGlobalStrings();
+		}
 	}
-	if (FirstFreeEntry >= STRPOOL_LIBRARYID_OR)
-	{ // If we go any higher, we'll collide with the library ID marker.
-		return -1;
+
+	unsigned int index;
+	if (FreeEntries.Size() > 0)
+	{
+		FreeEntries.Pop(index);
 	}
-	if (index == Pool.Size())
-	{ // There were no free entries; make a new one.
-		Pool.Reserve(MIN_GC_SIZE);
-		FirstFreeEntry++;
+	else if (Pool.Size() < MAX_POOL_SIZE)
+	{
+		index = Pool.Reserve(1);
 	}
 	else
-	{ // Scan for the next free entry
-		FindFirstFreeEntry(FirstFreeEntry + 1);
+	{ // If we go any higher, we'll collide with the library ID marker.
+		return -1;
 	}
 	PoolEntry *entry = &Pool[index];
 	entry->Str = str;
 	entry->Hash = h;
-	entry->Next = PoolBuckets[bucketnum];
-	entry->Mark = false;
-	entry->Locks.Clear();
-	PoolBuckets[bucketnum] = index;
+	entry->Used = true;
+	entry->Mark = Sweeping && index >= SweepPos;
+	NumUsed++;
+	InsertIndex(index);
 	return index | STRPOOL_LIBRARYID_OR;
 }
 
 //============================================================================
 //
-// ACSStringPool :: FindFirstFreeEntry
+// ACSStringPool :: InsertIndex
+//
+// Adds a pool entry to the hash index, growing it when it gets more than
+// three quarters full. Removed entries count towards this, so a grow also
+// gets rid of them.
+//
+//============================================================================
+
+void ACSStringPool::InsertIndex(unsigned int num)
+{
+	if ((NumUsed + NumDeleted) * 4 > Index.Size() * 3)
+	{
+		unsigned int size = MIN_INDEX_SIZE;
+		while (size < NumUsed * 2)
+		{
+			size <<= 1;
+		}
+		ResizeIndex(size);	// This already includes the new entry.
+		return;
+	}
+	unsigned int mask = Index.Size() - 1;
+	unsigned int slot = Pool[num].Hash & mask;
+	while (Index[slot] != NO_ENTRY && Index[slot] != DELETED_ENTRY)
+	{
+		slot = (slot + 1) & mask;
+	}
+	if (Index[slot] == DELETED_ENTRY)
+	{
+		NumDeleted--;
+	}
+	Index[slot] = num;
+}
+
+//============================================================================
+//
+// ACSStringPool :: RemoveIndex
+//
+//============================================================================
+
+void ACSStringPool::RemoveIndex(unsigned int num)
+{
+	unsigned int mask = Index.Size() - 1;
+	for (unsigned int slot = Pool[num].Hash & mask; Index[slot] != NO_ENTRY; slot = (slot + 1) & mask)
+	{
+		if (Index[slot] == num)
+		{
+			Index[slot] = DELETED_ENTRY;
+			NumDeleted++;
+			return;
+		}
+	}
+	assert(false && "ACS string not in index");
+}
+
+//============================================================================
+//
+// ACSStringPool :: ResizeIndex
 //
-// Finds the first free entry, starting at base.
+// Rebuilds the hash index from all used entries.
 //
 //============================================================================
 
-void ACSStringPool::FindFirstFreeEntry(unsigned base)
+void ACSStringPool::ResizeIndex(unsigned int size)
 {
-	while (base < Pool.Size() && Pool[base].Next != FREE_ENTRY)
+	Index.Resize(size);
+	for (auto &slot : Index)
+	{
+		slot = NO_ENTRY;
+	}
+	NumDeleted = 0;
+
+	unsigned int mask = size - 1;
+	for (unsigned int i = 0; i < Pool.Size(); ++i)
 	{
-		base++;
+		if (Pool[i].Used)
+		{
+			unsigned int slot = Pool[i].Hash & mask;
+			while (Index[slot] != NO_ENTRY)
+			{
+				slot = (slot + 1) & mask;
+			}
+			Index[slot] = i;
+		}
 	}
-	FirstFreeEntry = base;
 }
 
 //============================================================================
@@ -1278,12 +1479,11 @@ void ACSStringPool::ReadStrings(FSerializer &file, const char *key)
 		int poolsize = 0;
 
 		file("poolsize", poolsize);
-		Pool.Resize(poolsize);
+		Pool.Resize(std::min<unsigned int>(std::max(poolsize, 0), MAX_POOL_SIZE));
 		for (auto &p : Pool)
 		{
-			p.Next = FREE_ENTRY;
+			p.Used = false;
 			p.Mark = false;
-			p.Locks.Clear();
 		}
 		if (file.BeginArray("pool"))
 		{
@@ -1293,17 +1493,23 @@ void ACSStringPool::ReadStrings(FSerializer &file, const char *key)
 				if (file.BeginObject(nullptr))
 				{
 					unsigned ii = UINT_MAX;
+					TArray<int> locks;
 					file("index", ii);
 					if (ii < Pool.Size())
 					{
 						file("string", Pool[ii].Str)
-							("locks", Pool[ii].Locks);
+							("locks", locks);
 
-						unsigned h = SuperFastHash(Pool[ii].Str, Pool[ii].Str.Len());
-						unsigned bucketnum = h % NUM_BUCKETS;
-						Pool[ii].Hash = h;
-						Pool[ii].Next = PoolBuckets[bucketnum];
-						PoolBuckets[bucketnum] = ii;
+						Pool[ii].Hash = SuperFastHash(Pool[ii].Str, Pool[ii].Str.Len());
+						if (!Pool[ii].Used)
+						{
+							Pool[ii].Used = true;
+							NumUsed++;
+						}
+						for (int level : locks)
+						{
+							SetLockBit(GetLockSet(level).Bits, ii);
+						}
 					}
 					file.EndObject();
 				}
@@ -1311,7 +1517,21 @@ void ACSStringPool::ReadStrings(FSerializer &file, const char *key)
 		}
 	}
 
-	FindFirstFreeEntry(FirstFreeEntry);
+	// Hand out the lowest free indices first.
+	for (unsigned int i = Pool.Size(); i-- > 0; )
+	{
+		if (!Pool[i].Used)
+		{
+			FreeEntries.Push(i);
+		}
+	}
+	unsigned int size = MIN_INDEX_SIZE;
+	while (size < NumUsed * 2)
+	{
+		size <<= 1;
+	}
+	ResizeIndex(size);
+	GCThreshold = std::max<unsigned int>(MIN_GC_SIZE, NumUsed * 2);
 }
 
 //============================================================================
@@ -1322,7 +1542,7 @@ void ACSStringPool::ReadStrings(FSerializer &file, const char *key)
 //
 //============================================================================
 
-void ACSStringPool::WriteStrings(FSerializer &file, const char *key) const
+void ACSStringPool::WriteStrings(FSerializer &file, const char *key)
 {
 	int32_t i, poolsize = (int32_t)Pool.Size();
 	
@@ -1330,21 +1550,32 @@ void ACSStringPool::WriteStrings(FSerializer &file, const char *key) const
 	{ // No need to write if we don't have anything.
 		return;
 	}
+	// Don't save strings that are already known to be garbage.
+	FinishSweep();
 	if (file.BeginObject(key))
 	{
 		file("poolsize", poolsize);
 		if (file.BeginArray("pool"))
 		{
+			TArray<int> locks;
 			for (i = 0; i < poolsize; ++i)
 			{
 				PoolEntry *entry = &Pool[i];
-				if (entry->Next != FREE_ENTRY)
+				if (entry->Used)
 				{
+					locks.Clear();
+					for (auto &set : Locks)
+					{
+						if ((unsigned)i >> 5 < set.Bits.Size() && (set.Bits[i >> 5] & (1u << (i & 31))))
+						{
+							locks.Push(set.Level);
+						}
+					}
 					if (file.BeginObject(nullptr))
 					{
 						file("index", i)
 							("string", entry->Str)
-							("locks", entry->Locks)
+							("locks", locks)
 							.EndObject();
 					}
 				}
@@ -1367,26 +1598,27 @@ void ACSStringPool::Dump() const
 {
 	for (unsigned int i = 0; i < Pool.Size(); ++i)
 	{
-		if (Pool[i].Next != FREE_ENTRY)
+		if (Pool[i].Used)
 		{
-			Printf("%4u. (%2d) \"%s\"\n", i, Pool[i].Locks.Size(), Pool[i].Str.GetChars());
+			Printf("%4u. (%c) \"%s\"\n", i, IsLocked(i) ? 'L' : ' ', Pool[i].Str.GetChars());
 		}
 	}
-	Printf("First free %u\n", FirstFreeEntry);
+	Printf("%u used, %u free, %u index slots (%u deleted)%s\n", NumUsed, FreeEntries.Size(), Index.Size(), NumDeleted,
+		Sweeping ? ", sweeping" : "");
 }
 
 
 void ACSStringPool::UnlockForLevel(int lnum)
 {
-	for (unsigned int i = 0; i < Pool.Size(); ++i)
+	// The sweep in progress did not look at the level's variables, so it must
+	// be done before their strings lose their locks.
+	FinishSweep();
+	for (unsigned int i = 0; i < Locks.Size(); ++i)
 	{
-		if (Pool[i].Next != FREE_ENTRY)
+		if (Locks[i].Level == lnum)
 		{
-			auto ndx = Pool[i].Locks.Find(lnum);
-			if (ndx < Pool[i].Locks.Size())
-			{
-				Pool[i].Locks.Delete(ndx);
-			}
+			Locks.Delete(i);
+			break;
 		}
 	}
 }
@@ -1423,13 +1655,13 @@ void P_MarkGlobalVarStrings()
 
 //============================================================================
 //
-// P_CollectACSGlobalStrings
+// P_MarkACSGlobalStrings
 //
-// Garbage collect ACS global strings.
+// Marks every string that is referenced by any ACS variable or stack.
 //
 //============================================================================
 
-void P_CollectACSGlobalStrings()
+static void P_MarkACSGlobalStrings()
 {
 	for (FACSStack *stack = FACSStack::head; stack != NULL; stack = stack->next)
 	{
@@ -1454,9 +1686,53 @@ void P_CollectACSGlobalStrings()
 	}
 	P_MarkWorldVarStrings();
 	P_MarkGlobalVarStrings();
+}
+
+//============================================================================
+//
+// P_CollectACSGlobalStrings
+//
+// Garbage collect ACS global strings.
+//
+//============================================================================
+
+void P_CollectACSGlobalStrings()
+{
+	P_MarkACSGlobalStrings();
 	GlobalACSStrings.PurgeStrings();
 }
 
+//============================================================================
+//
+// P_StepACSGlobalStrings
+//
+// Incremental version of P_CollectACSGlobalStrings. Once the pool has
+// doubled in size since the last collection, everything in use is marked
+// and freeing the rest is spread over the following tics, taking at most
+// acs_gcbudget microseconds per call.
+//
+//============================================================================
+
+static void P_StepACSGlobalStrings()
+{
+	if (GlobalACSStrings.NeedsCollection())
+	{
+		P_MarkACSGlobalStrings();
+		GlobalACSStrings.StartSweep();
+	}
+	if (GlobalACSStrings.IsSweeping())
+	{
+		if (acs_gcbudget <= 0)
+		{
+			GlobalACSStrings.FinishSweep();
+		}
+		else
+		{
+			GlobalACSStrings.SweepStep(I_nsTime() + uint64_t(acs_gcbudget) * 1000);
+		}
+	}
+}
+
 #ifdef _DEBUG
 CCMD(acsgc)
 {
@@ -2684,6 +2960,7 @@ bool FBehavior::Init(FLevelLocals *Level, int lumpnum, FileReader * fr, int len,
 
 FBehavior::~FBehavior ()
 {
+	ReleaseCompiledBlocks();
 	if (Scripts != NULL)
 	{
 		delete[] Scripts;
@@ -3425,7 +3702,7 @@ void DACSThinker::Tick ()
 		script = next;
 	}
 
-//	GlobalACSStrings.Clear();
+	P_StepACSGlobalStrings();
 
 	ACSTime.Unclock();
 }
@@ -6767,59 +7044,1033 @@ PClass *DLevelScript::GetClassForIndex(int index) const
 	return PClass::FindActor(Level->Behaviors.LookupString(index));
 }
 
-int DLevelScript::RunScript()
+//==========================================================================
+//
+// ACS block compilers
+//
+// Straight-line runs of p-code that only shuffle the stack, do integer
+// arithmetic and access scalar variables are pre-decoded the first time the
+// interpreter reaches them. The decoded run is then either compiled to
+// native code (acs_jit) or turned into a compact list of operations with
+// their operands already unpacked, with common sequences fused into single
+// operations, which runs in a small dispatch loop.
+//
+// A run ends at the first p-code neither can handle, at a jump, or at a
+// line special whose arguments it has just pushed. Everything that can
+// suspend the script, call out of it or raise an error still goes through
+// the interpreter. Blocks are only entered and left on p-code boundaries,
+// which keeps delays, waits and the runaway and profiling counters working
+// exactly as before.
+//
+//==========================================================================
+
+CVAR(Bool, acs_jit, true, 0)
+
+// A p-code of a run with its operands unpacked. All pushes of constant
+// values are expanded to separate PCD_PUSHNUMBERs.
+struct ACSRunOp
 {
-	DACSThinker *controller = Level->ACSThinker;
-	ACSLocalVariables locals(Localvars);
-	ACSLocalArrays noarrays;
-	ACSLocalArrays *localarrays = &noarrays;
-	ScriptFunction *activeFunction = NULL;
-	FRemapTable *translation = 0;
-	int resultValue = 1;
-	int transi = -1;
+	int Pcd;
+	int32_t Arg;		// pushed value, variable index or line special
+	int *Target;		// jump target
+};
 
-	if (InModuleScriptNumber >= 0)
-	{
-		ScriptPtr *ptr = activeBehavior->GetScriptPtr(InModuleScriptNumber);
-		assert(ptr != NULL);
-		if (ptr != NULL)
-		{
-			localarrays = &ptr->LocalArrays;
-		}
-	}
+enum
+{
+	VAR_Script,
+	VAR_Map,
+	VAR_World,
+	VAR_Global
+};
 
-	// Hexen truncates all special arguments to bytes (only when using an old MAPINFO and old ACS format
-	const int specialargmask = ((Level->flags2 & LEVEL2_HEXENHACK) && activeBehavior->GetFormat() == ACS_Old) ? 255 : ~0;
+enum
+{
+	VOP_Push,
+	VOP_Assign,
+	VOP_Add,
+	VOP_Sub,
+	VOP_Inc,
+	VOP_Dec
+};
 
-	switch (state)
-	{
-	case SCRIPT_Delayed:
-		// Decrement the delay counter and enter state running
-		// if it hits 0
-		if (--statedata == 0)
-			state = SCRIPT_Running;
-		break;
+//==========================================================================
+//
+// Splits a scalar variable p-code into the operation and the kind of
+// variable it works on.
+//
+//==========================================================================
 
-	case SCRIPT_TagWait:
-		// Wait for tagged sector(s) to go inactive, then enter
-		// state running
+static bool DecodeACSVarOp(int pcd, int &op, int &kind)
+{
+	static const struct { int pcd, op, kind; } varops[] =
+	{
+		{ PCD_PUSHSCRIPTVAR, VOP_Push, VAR_Script },		{ PCD_PUSHMAPVAR, VOP_Push, VAR_Map },
+		{ PCD_PUSHWORLDVAR, VOP_Push, VAR_World },			{ PCD_PUSHGLOBALVAR, VOP_Push, VAR_Global },
+		{ PCD_ASSIGNSCRIPTVAR, VOP_Assign, VAR_Script },	{ PCD_ASSIGNMAPVAR, VOP_Assign, VAR_Map },
+		{ PCD_ASSIGNWORLDVAR, VOP_Assign, VAR_World },		{ PCD_ASSIGNGLOBALVAR, VOP_Assign, VAR_Global },
+		{ PCD_ADDSCRIPTVAR, VOP_Add, VAR_Script },			{ PCD_ADDMAPVAR, VOP_Add, VAR_Map },
+		{ PCD_ADDWORLDVAR, VOP_Add, VAR_World },			{ PCD_ADDGLOBALVAR, VOP_Add, VAR_Global },
+		{ PCD_SUBSCRIPTVAR, VOP_Sub, VAR_Script },			{ PCD_SUBMAPVAR, VOP_Sub, VAR_Map },
+		{ PCD_SUBWORLDVAR, VOP_Sub, VAR_World },			{ PCD_SUBGLOBALVAR, VOP_Sub, VAR_Global },
+		{ PCD_INCSCRIPTVAR, VOP_Inc, VAR_Script },			{ PCD_INCMAPVAR, VOP_Inc, VAR_Map },
+		{ PCD_INCWORLDVAR, VOP_Inc, VAR_World },			{ PCD_INCGLOBALVAR, VOP_Inc, VAR_Global },
+		{ PCD_DECSCRIPTVAR, VOP_Dec, VAR_Script },			{ PCD_DECMAPVAR, VOP_Dec, VAR_Map },
+		{ PCD_DECWORLDVAR, VOP_Dec, VAR_World },			{ PCD_DECGLOBALVAR, VOP_Dec, VAR_Global },
+	};
+
+	for (auto &varop : varops)
 	{
-		int secnum;
-		auto it = Level->GetSectorTagIterator(statedata);
-		while ((secnum = it.Next()) >= 0)
+		if (varop.pcd == pcd)
 		{
-			if (Level->sectors[secnum].floordata || Level->sectors[secnum].ceilingdata)
-				return resultValue;
+			op = varop.op;
+			kind = varop.kind;
+			return true;
 		}
-
-		// If we got here, none of the tagged sectors were busy
-		state = SCRIPT_Running;
 	}
-	break;
+	return false;
+}
 
-	case SCRIPT_PolyWait:
-		// Wait for polyobj(s) to stop moving, then enter state running
-		if (!PO_Busy (Level, statedata))
+static bool IsACSBinaryOp(int pcd)
+{
+	switch (pcd)
+	{
+	case PCD_ADD: case PCD_SUBTRACT: case PCD_MULTIPLY:
+	case PCD_ANDBITWISE: case PCD_ORBITWISE: case PCD_EORBITWISE:
+	case PCD_LSHIFT: case PCD_RSHIFT:
+	case PCD_EQ: case PCD_NE: case PCD_LT: case PCD_GT: case PCD_LE: case PCD_GE:
+	case PCD_ANDLOGICAL: case PCD_ORLOGICAL:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool IsACSCompareOp(int pcd)
+{
+	return pcd == PCD_EQ || pcd == PCD_NE || pcd == PCD_LT || pcd == PCD_GT || pcd == PCD_LE || pcd == PCD_GE;
+}
+
+static int32_t FoldACSBinaryOp(int pcd, int32_t a, int32_t b)
+{
+	switch (pcd)
+	{
+	// Wrap around instead of overflowing, and mask shift counts the way the hardware does for the interpreter.
+	case PCD_ADD:			return int32_t(uint32_t(a) + uint32_t(b));
+	case PCD_SUBTRACT:		return int32_t(uint32_t(a) - uint32_t(b));
+	case PCD_MULTIPLY:		return int32_t(uint32_t(a) * uint32_t(b));
+	case PCD_ANDBITWISE:	return a & b;
+	case PCD_ORBITWISE:		return a | b;
+	case PCD_EORBITWISE:	return a ^ b;
+	case PCD_LSHIFT:		return int32_t(uint32_t(a) << (b & 31));
+	case PCD_RSHIFT:		return a >> (b & 31);
+	case PCD_EQ:			return a == b;
+	case PCD_NE:			return a != b;
+	case PCD_LT:			return a < b;
+	case PCD_GT:			return a > b;
+	case PCD_LE:			return a <= b;
+	case PCD_GE:			return a >= b;
+	case PCD_ANDLOGICAL:	return a && b;
+	case PCD_ORLOGICAL:		return a || b;
+	default:				return 0;
+	}
+}
+
+//==========================================================================
+//
+// DecodeACSRun
+//
+// Decodes the p-codes starting at pc for as long as the block compilers
+// can handle them. Returns the number of p-codes in the run and sets end
+// to the first one that was not included.
+//
+//==========================================================================
+
+static unsigned DecodeACSRun(FBehavior *module, int *pc, TArray<ACSRunOp> &ops, int *&end)
+{
+	const ACSFormat fmt = module->GetFormat();
+	auto nextbyte = [&]() { return fmt == ACS_LittleEnhanced ? getbyte(pc) : LittleLong(*pc++); };
+	unsigned count = 0;
+
+	for (;;)
+	{
+		int *start = pc;
+		int pcd, op, kind;
+		if (fmt == ACS_LittleEnhanced)
+		{
+			pcd = getbyte(pc);
+			if (pcd >= 256-16)
+			{
+				pcd = (256-16) + ((pcd - (256-16)) << 8) + getbyte(pc);
+			}
+		}
+		else
+		{
+			pcd = LittleLong(*pc++);
+		}
+
+		switch (pcd)
+		{
+		case PCD_NOP:
+			break;
+
+		case PCD_PUSHNUMBER:
+			ops.Push({ PCD_PUSHNUMBER, uallong(pc[0]), nullptr });
+			pc++;
+			break;
+
+		case PCD_PUSHBYTE:
+			ops.Push({ PCD_PUSHNUMBER, getbyte(pc), nullptr });
+			break;
+
+		case PCD_PUSH2BYTES:
+		case PCD_PUSH3BYTES:
+		case PCD_PUSH4BYTES:
+		case PCD_PUSH5BYTES:
+			for (int i = pcd - PCD_PUSH2BYTES + 2; i > 0; i--)
+			{
+				ops.Push({ PCD_PUSHNUMBER, getbyte(pc), nullptr });
+			}
+			break;
+
+		case PCD_PUSHBYTES:
+			for (int i = getbyte(pc); i > 0; i--)
+			{
+				ops.Push({ PCD_PUSHNUMBER, getbyte(pc), nullptr });
+			}
+			break;
+
+		case PCD_DUP:
+		case PCD_SWAP:
+		case PCD_DROP:
+		case PCD_NEGATELOGICAL:
+		case PCD_NEGATEBINARY:
+		case PCD_UNARYMINUS:
+			ops.Push({ pcd, 0, nullptr });
+			break;
+
+		case PCD_GOTO:
+		case PCD_IFGOTO:
+		case PCD_IFNOTGOTO:
+			ops.Push({ pcd, 0, module->Ofs2PC(LittleLong(*pc)) });
+			pc++;
+			end = pc;
+			return count + 1;
+
+		case PCD_LSPEC1:
+		case PCD_LSPEC2:
+		case PCD_LSPEC3:
+		case PCD_LSPEC4:
+		case PCD_LSPEC5:
+			// The block pushes the arguments and the interpreter executes the special right after it.
+			ops.Push({ pcd, nextbyte(), nullptr });
+			end = pc;
+			return count + 1;
+
+		default:
+			if (IsACSBinaryOp(pcd))
+			{
+				ops.Push({ pcd, 0, nullptr });
+				break;
+			}
+			if (DecodeACSVarOp(pcd, op, kind))
+			{
+				int index = nextbyte();
+				static const int limits[] = { INT_MAX, NUM_MAPVARS, NUM_WORLDVARS, NUM_GLOBALVARS };
+				if (index >= 0 && index < limits[kind])
+				{
+					ops.Push({ pcd, index, nullptr });
+					break;
+				}
+			}
+			end = start;
+			return count;
+		}
+		count++;
+	}
+}
+
+//==========================================================================
+//
+// Pre-decoded operations for running blocks without native code
+//
+//==========================================================================
+
+enum
+{
+	BOP_Push,			// push the operand
+	BOP_Assign,			// pop into a variable
+	BOP_AddVar,
+	BOP_SubVar,
+	BOP_IncVar,
+	BOP_DecVar,
+	BOP_Dup,
+	BOP_Swap,
+	BOP_Drop,
+	BOP_Negate,
+	BOP_Not,
+	BOP_NotLogical,
+	BOP_Binary,			// Sub is the p-code, the operand is the right-hand side
+	BOP_Exit,			// return 0
+	BOP_Branch,			// pop and return whether the value is non-zero, or zero with Invert
+	BOP_CompareBranch,	// compare and branch in one, Sub is the comparison p-code
+};
+
+enum
+{
+	OPND_Stack,			// popped from the stack
+	OPND_Const,			// Arg
+	OPND_Script,		// script variable Arg
+	OPND_Map,			// map variable, Addr points at its pointer
+	OPND_Mem,			// world or global variable at Addr
+};
+
+struct ACSBlockOp
+{
+	uint8_t Code;
+	uint8_t Mode;
+	uint8_t Invert;
+	int Sub;
+	int32_t Arg;
+	void *Addr;
+};
+
+static inline int32_t &ACSBlockVar(const ACSBlockOp *op, int32_t *locals)
+{
+	switch (op->Mode)
+	{
+	case OPND_Script:	return locals[op->Arg];
+	case OPND_Map:		return **(int32_t **)op->Addr;
+	default:			return *(int32_t *)op->Addr;
+	}
+}
+
+static inline int32_t ACSBlockOperand(const ACSBlockOp *op, int32_t *&sp, int32_t *locals)
+{
+	switch (op->Mode)
+	{
+	case OPND_Stack:	return *--sp;
+	case OPND_Const:	return op->Arg;
+	default:			return ACSBlockVar(op, locals);
+	}
+}
+
+static int RunACSBlockOps(const ACSBlockOp *op, int32_t *sp, int32_t *locals)
+{
+	for (;; op++)
+	{
+		switch (op->Code)
+		{
+		case BOP_Push:
+		{
+			int32_t value = ACSBlockOperand(op, sp, locals);
+			*sp++ = value;
+			break;
+		}
+
+		case BOP_Assign:	ACSBlockVar(op, locals) = *--sp; break;
+		case BOP_AddVar:	ACSBlockVar(op, locals) += *--sp; break;
+		case BOP_SubVar:	ACSBlockVar(op, locals) -= *--sp; break;
+		case BOP_IncVar:	ACSBlockVar(op, locals) += 1; break;
+		case BOP_DecVar:	ACSBlockVar(op, locals) -= 1; break;
+		case BOP_Dup:		sp[0] = sp[-1]; sp++; break;
+		case BOP_Swap:		std::swap(sp[-2], sp[-1]); break;
+		case BOP_Drop:		sp--; break;
+		case BOP_Negate:	sp[-1] = int32_t(0u - uint32_t(sp[-1])); break;
+		case BOP_Not:		sp[-1] = ~sp[-1]; break;
+		case BOP_NotLogical: sp[-1] = !sp[-1]; break;
+
+		case BOP_Binary:
+		{
+			int32_t b = ACSBlockOperand(op, sp, locals);
+			switch (op->Sub)
+			{
+			case PCD_ADD:		sp[-1] = int32_t(uint32_t(sp[-1]) + uint32_t(b)); break;
+			case PCD_SUBTRACT:	sp[-1] = int32_t(uint32_t(sp[-1]) - uint32_t(b)); break;
+			case PCD_LT:		sp[-1] = sp[-1] < b; break;
+			case PCD_EQ:		sp[-1] = sp[-1] == b; break;
+			default:			sp[-1] = FoldACSBinaryOp(op->Sub, sp[-1], b); break;
+			}
+			break;
+		}
+
+		case BOP_Exit:
+			return 0;
+
+		case BOP_Branch:
+			return (*--sp != 0) != op->Invert;
+
+		case BOP_CompareBranch:
+		{
+			int32_t b = ACSBlockOperand(op, sp, locals);
+			int32_t a = *--sp;
+			return (FoldACSBinaryOp(op->Sub, a, b) != 0) != op->Invert;
+		}
+		}
+	}
+}
+
+//==========================================================================
+//
+// Turns a decoded run into block operations. A constant or script
+// variable push that feeds straight into a binary operation becomes that
+// operation's operand, binary operations on two constants are folded, and
+// a comparison that feeds straight into a branch is merged with it.
+//
+//==========================================================================
+
+static void BuildACSBlockOps(FBehavior *module, const TArray<ACSRunOp> &run, TArray<ACSBlockOp> &out)
+{
+	for (unsigned i = 0; i < run.Size(); i++)
+	{
+		const ACSRunOp &rop = run[i];
+		ACSBlockOp bop = { BOP_Exit, OPND_Stack, 0, 0, 0, nullptr };
+		int op, kind;
+
+		if (rop.Pcd == PCD_PUSHNUMBER || (DecodeACSVarOp(rop.Pcd, op, kind) && op == VOP_Push && kind == VAR_Script))
+		{
+			bool isconst = rop.Pcd == PCD_PUSHNUMBER;
+			if (i + 1 < run.Size() && IsACSBinaryOp(run[i + 1].Pcd))
+			{
+				// Fold into the binary operation, or fold the whole operation if the left side is a constant as well.
+				ACSBlockOp *prev = out.Size() > 0 ? &out.Last() : nullptr;
+				if (isconst && prev != nullptr && prev->Code == BOP_Push && prev->Mode == OPND_Const)
+				{
+					prev->Arg = FoldACSBinaryOp(run[i + 1].Pcd, prev->Arg, rop.Arg);
+					i++;
+					continue;
+				}
+				bop.Code = BOP_Binary;
+				bop.Sub = run[i + 1].Pcd;
+				bop.Mode = isconst ? OPND_Const : OPND_Script;
+				bop.Arg = rop.Arg;
+				i++;
+				if (IsACSCompareOp(bop.Sub) && i + 1 < run.Size() && (run[i + 1].Pcd == PCD_IFGOTO || run[i + 1].Pcd == PCD_IFNOTGOTO))
+				{
+					bop.Code = BOP_CompareBranch;
+					bop.Invert = run[i + 1].Pcd == PCD_IFNOTGOTO;
+					i++;
+				}
+				out.Push(bop);
+				continue;
+			}
+		}
+
+		if (DecodeACSVarOp(rop.Pcd, op, kind))
+		{
+			static const uint8_t codes[] = { BOP_Push, BOP_Assign, BOP_AddVar, BOP_SubVar, BOP_IncVar, BOP_DecVar };
+			bop.Code = codes[op];
+			bop.Arg = rop.Arg;
+			switch (kind)
+			{
+			case VAR_Script:	bop.Mode = OPND_Script; break;
+			case VAR_Map:		bop.Mode = OPND_Map; bop.Addr = &module->MapVars.Pointer()[rop.Arg]; break;
+			case VAR_World:		bop.Mode = OPND_Mem; bop.Addr = ACS_WorldVars.Pointer() + rop.Arg; break;
+			default:			bop.Mode = OPND_Mem; bop.Addr = ACS_GlobalVars.Pointer() + rop.Arg; break;
+			}
+			out.Push(bop);
+			continue;
+		}
+
+		switch (rop.Pcd)
+		{
+		case PCD_PUSHNUMBER:	bop.Code = BOP_Push; bop.Mode = OPND_Const; bop.Arg = rop.Arg; break;
+		case PCD_DUP:			bop.Code = BOP_Dup; break;
+		case PCD_SWAP:			bop.Code = BOP_Swap; break;
+		case PCD_DROP:			bop.Code = BOP_Drop; break;
+		case PCD_UNARYMINUS:	bop.Code = BOP_Negate; break;
+		case PCD_NEGATEBINARY:	bop.Code = BOP_Not; break;
+		case PCD_NEGATELOGICAL:	bop.Code = BOP_NotLogical; break;
+		case PCD_IFGOTO:		bop.Code = BOP_Branch; break;
+		case PCD_IFNOTGOTO:		bop.Code = BOP_Branch; bop.Invert = 1; break;
+
+		default:
+			if (IsACSBinaryOp(rop.Pcd))
+			{
+				if (IsACSCompareOp(rop.Pcd) && i + 1 < run.Size() && (run[i + 1].Pcd == PCD_IFGOTO || run[i + 1].Pcd == PCD_IFNOTGOTO))
+				{
+					bop.Code = BOP_CompareBranch;
+					bop.Invert = run[i + 1].Pcd == PCD_IFNOTGOTO;
+					i++;
+				}
+				else
+				{
+					bop.Code = BOP_Binary;
+				}
+				bop.Sub = rop.Pcd;
+			}
+			// GOTO and the line specials just end the block.
+			break;
+		}
+		out.Push(bop);
+	}
+	if (out.Size() == 0 || (out.Last().Code != BOP_Exit && out.Last().Code != BOP_Branch && out.Last().Code != BOP_CompareBranch))
+	{
+		out.Push({ BOP_Exit, OPND_Stack, 0, 0, 0, nullptr });
+	}
+}
+
+#ifdef HAVE_VM_JIT
+
+static asmjit::JitRuntime ACSJitRuntime;
+
+class FACSBlockCompiler
+{
+public:
+	FACSBlockCompiler(asmjit::CodeHolder *code, FBehavior *module)
+		: cc(code), Module(module)
+	{
+	}
+
+	bool Compile(const TArray<ACSRunOp> &run);
+
+private:
+	// A value on the stack that has been pushed inside the block and not yet written to memory.
+	struct Slot
+	{
+		asmjit::X86Gp Reg;
+		int32_t Value;
+		bool IsConst;
+	};
+
+	asmjit::X86Compiler cc;
+	FBehavior *Module;
+	asmjit::X86Gp StackPtr;
+	asmjit::X86Gp LocalsPtr;
+	TArray<Slot> VStack;
+	int Depth = 0;
+
+	asmjit::X86Mem StackSlot(int depth)
+	{
+		return asmjit::x86::dword_ptr(StackPtr, depth * (int)sizeof(int32_t));
+	}
+
+	void Push(asmjit::X86Gp reg)
+	{
+		VStack.Push({ reg, 0, false });
+		Depth++;
+	}
+
+	void PushConst(int32_t value)
+	{
+		VStack.Push({ asmjit::X86Gp(), value, true });
+		Depth++;
+	}
+
+	Slot Pop()
+	{
+		Slot slot;
+		Depth--;
+		if (VStack.Size() > 0)
+		{
+			VStack.Pop(slot);
+		}
+		else
+		{
+			// The value was already on the stack when the block was entered.
+			slot.Reg = cc.newInt32();
+			slot.IsConst = false;
+			cc.mov(slot.Reg, StackSlot(Depth));
+		}
+		return slot;
+	}
+
+	void Drop()
+	{
+		Depth--;
+		if (VStack.Size() > 0) VStack.Pop();
+	}
+
+	asmjit::X86Gp ToReg(const Slot &slot)
+	{
+		asmjit::X86Gp reg = cc.newInt32();
+		if (slot.IsConst) cc.mov(reg, asmjit::imm(slot.Value));
+		else cc.mov(reg, slot.Reg);
+		return reg;
+	}
+
+	void ReturnConst(int value)
+	{
+		asmjit::X86Gp reg = cc.newInt32();
+		cc.mov(reg, value);
+		cc.ret(reg);
+	}
+
+	// Writes all pending values to the stack memory.
+	void Flush()
+	{
+		int depth = Depth - (int)VStack.Size();
+		for (auto &slot : VStack)
+		{
+			if (slot.IsConst) cc.mov(StackSlot(depth), asmjit::imm(slot.Value));
+			else cc.mov(StackSlot(depth), slot.Reg);
+			depth++;
+		}
+		VStack.Clear();
+	}
+
+	template<class Emit>
+	void BinaryOp(int pcd, Emit emit)
+	{
+		Slot b = Pop();
+		Slot a = Pop();
+		if (a.IsConst && b.IsConst)
+		{
+			PushConst(FoldACSBinaryOp(pcd, a.Value, b.Value));
+			return;
+		}
+		asmjit::X86Gp reg = ToReg(a);
+		if (b.IsConst) emit(reg, asmjit::imm(b.Value));
+		else emit(reg, b.Reg);
+		Push(reg);
+	}
+
+	void CompareOp(int pcd, uint32_t cond)
+	{
+		Slot b = Pop();
+		Slot a = Pop();
+		if (a.IsConst && b.IsConst)
+		{
+			PushConst(FoldACSBinaryOp(pcd, a.Value, b.Value));
+			return;
+		}
+		asmjit::X86Gp left = a.IsConst ? ToReg(a) : a.Reg;
+		asmjit::X86Gp reg = cc.newInt32();
+		asmjit::X86Gp one = cc.newInt32();
+		cc.mov(reg, 0);
+		cc.mov(one, 1);
+		if (b.IsConst) cc.cmp(left, asmjit::imm(b.Value));
+		else cc.cmp(left, b.Reg);
+		cc.cmov(cond, reg, one);
+		Push(reg);
+	}
+
+	// 1 if the value compares against 0 with the given condition, 0 otherwise.
+	asmjit::X86Gp TestZero(const Slot &slot, uint32_t cond)
+	{
+		asmjit::X86Gp reg = cc.newInt32();
+		asmjit::X86Gp one = cc.newInt32();
+		cc.mov(reg, 0);
+		cc.mov(one, 1);
+		cc.test(slot.Reg, slot.Reg);
+		cc.cmov(cond, reg, one);
+		return reg;
+	}
+
+	asmjit::X86Mem VarAddress(int kind, int index);
+};
+
+asmjit::X86Mem FACSBlockCompiler::VarAddress(int kind, int index)
+{
+	using namespace asmjit;
+
+	if (kind == VAR_Script)
+	{
+		return x86::dword_ptr(LocalsPtr, index * (int)sizeof(int32_t));
+	}
+
+	X86Gp ptr = cc.newIntPtr();
+	if (kind == VAR_Map)
+	{
+		// Load the pointer at run time since imports can redirect it.
+		cc.mov(ptr, imm_ptr(&Module->MapVars.Pointer()[index]));
+		cc.mov(ptr, x86::ptr(ptr));
+	}
+	else
+	{
+		cc.mov(ptr, imm_ptr((kind == VAR_World ? ACS_WorldVars.Pointer() : ACS_GlobalVars.Pointer()) + index));
+	}
+	return x86::dword_ptr(ptr);
+}
+
+bool FACSBlockCompiler::Compile(const TArray<ACSRunOp> &run)
+{
+	using namespace asmjit;
+
+	cc.addFunc(FuncSignature2<int, void *, void *>());
+	StackPtr = cc.newIntPtr("stack");
+	LocalsPtr = cc.newIntPtr("locals");
+	cc.setArg(0, StackPtr);
+	cc.setArg(1, LocalsPtr);
+
+	bool returned = false;
+	for (auto &rop : run)
+	{
+		int pcd = rop.Pcd;
+		int op, kind;
+
+		switch (pcd)
+		{
+		case PCD_PUSHNUMBER:
+			PushConst(rop.Arg);
+			break;
+
+		case PCD_DUP:
+		{
+			Slot top = Pop();
+			VStack.Push(top);
+			VStack.Push(top);
+			Depth += 2;
+			break;
+		}
+
+		case PCD_SWAP:
+		{
+			Slot b = Pop();
+			Slot a = Pop();
+			VStack.Push(b);
+			VStack.Push(a);
+			Depth += 2;
+			break;
+		}
+
+		case PCD_DROP:
+			Drop();
+			break;
+
+		case PCD_ADD:			BinaryOp(pcd, [&](X86Gp r, auto b) { cc.add(r, b); }); break;
+		case PCD_SUBTRACT:		BinaryOp(pcd, [&](X86Gp r, auto b) { cc.sub(r, b); }); break;
+		case PCD_MULTIPLY:		BinaryOp(pcd, [&](X86Gp r, auto b) { cc.imul(r, b); }); break;
+		case PCD_ANDBITWISE:	BinaryOp(pcd, [&](X86Gp r, auto b) { cc.and_(r, b); }); break;
+		case PCD_ORBITWISE:		BinaryOp(pcd, [&](X86Gp r, auto b) { cc.or_(r, b); }); break;
+		case PCD_EORBITWISE:	BinaryOp(pcd, [&](X86Gp r, auto b) { cc.xor_(r, b); }); break;
+		case PCD_LSHIFT:		BinaryOp(pcd, [&](X86Gp r, auto b) { cc.shl(r, b); }); break;
+		case PCD_RSHIFT:		BinaryOp(pcd, [&](X86Gp r, auto b) { cc.sar(r, b); }); break;
+
+		case PCD_EQ:			CompareOp(pcd, x86::kCondE); break;
+		case PCD_NE:			CompareOp(pcd, x86::kCondNE); break;
+		case PCD_LT:			CompareOp(pcd, x86::kCondL); break;
+		case PCD_GT:			CompareOp(pcd, x86::kCondG); break;
+		case PCD_LE:			CompareOp(pcd, x86::kCondLE); break;
+		case PCD_GE:			CompareOp(pcd, x86::kCondGE); break;
+
+		case PCD_ANDLOGICAL:
+		case PCD_ORLOGICAL:
+		{
+			Slot b = Pop();
+			Slot a = Pop();
+			if (a.IsConst && b.IsConst)
+			{
+				PushConst(FoldACSBinaryOp(pcd, a.Value, b.Value));
+				break;
+			}
+			if (a.IsConst) a.Reg = ToReg(a);
+			if (b.IsConst) b.Reg = ToReg(b);
+			X86Gp reg;
+			if (pcd == PCD_ANDLOGICAL)
+			{
+				reg = TestZero(a, x86::kCondNE);
+				cc.and_(reg, TestZero(b, x86::kCondNE));
+			}
+			else
+			{
+				X86Gp either = cc.newInt32();
+				cc.mov(either, a.Reg);
+				cc.or_(either, b.Reg);
+				reg = TestZero({ either, 0, false }, x86::kCondNE);
+			}
+			Push(reg);
+			break;
+		}
+
+		case PCD_NEGATELOGICAL:
+		{
+			Slot a = Pop();
+			if (a.IsConst) PushConst(!a.Value);
+			else Push(TestZero(a, x86::kCondE));
+			break;
+		}
+
+		case PCD_NEGATEBINARY:
+		case PCD_UNARYMINUS:
+		{
+			Slot a = Pop();
+			if (a.IsConst)
+			{
+				PushConst(pcd == PCD_NEGATEBINARY ? ~a.Value : int32_t(0u - uint32_t(a.Value)));
+				break;
+			}
+			X86Gp reg = ToReg(a);
+			if (pcd == PCD_NEGATEBINARY) cc.not_(reg);
+			else cc.neg(reg);
+			Push(reg);
+			break;
+		}
+
+		case PCD_IFGOTO:
+		case PCD_IFNOTGOTO:
+		{
+			Slot cond = Pop();
+			Flush();
+			if (cond.IsConst)
+			{
+				ReturnConst((cond.Value != 0) == (pcd == PCD_IFGOTO));
+			}
+			else
+			{
+				cc.ret(TestZero(cond, pcd == PCD_IFGOTO ? x86::kCondNE : x86::kCondE));
+			}
+			returned = true;
+			break;
+		}
+
+		default:
+			if (DecodeACSVarOp(pcd, op, kind))
+			{
+				X86Mem mem = VarAddress(kind, rop.Arg);
+				if (op == VOP_Push)
+				{
+					X86Gp reg = cc.newInt32();
+					cc.mov(reg, mem);
+					Push(reg);
+				}
+				else if (op == VOP_Inc)
+				{
+					cc.add(mem, 1);
+				}
+				else if (op == VOP_Dec)
+				{
+					cc.sub(mem, 1);
+				}
+				else
+				{
+					Slot value = Pop();
+					if (value.IsConst)
+					{
+						if (op == VOP_Assign) cc.mov(mem, imm(value.Value));
+						else if (op == VOP_Add) cc.add(mem, imm(value.Value));
+						else cc.sub(mem, imm(value.Value));
+					}
+					else
+					{
+						if (op == VOP_Assign) cc.mov(mem, value.Reg);
+						else if (op == VOP_Add) cc.add(mem, value.Reg);
+						else cc.sub(mem, value.Reg);
+					}
+				}
+			}
+			// GOTO and the line specials just end the block.
+			break;
+		}
+	}
+
+	if (!returned)
+	{
+		Flush();
+		ReturnConst(0);
+	}
+	cc.endFunc();
+	return cc.finalize() == kErrorOk;
+}
+
+#endif
+
+//==========================================================================
+//
+// FBehavior :: FindCompiledBlock
+//
+// Returns the block starting at pc, building it on first use. Positions
+// that cannot start a block are remembered in a bit array so the
+// interpreter does not keep asking for them.
+//
+//==========================================================================
+
+const ACSCompiledBlock *FBehavior::FindCompiledBlock(int *pc)
+{
+	uint32_t ofs = PC2Ofs(pc);
+	if (NotCompiled.Size() == 0)
+	{
+		NotCompiled.Resize((DataSize + 7) / 8);
+		memset(NotCompiled.Data(), 0, NotCompiled.Size());
+	}
+	if (ofs >= (uint32_t)DataSize || (NotCompiled[ofs >> 3] & (1 << (ofs & 7))))
+	{
+		return nullptr;
+	}
+	ACSCompiledBlock **found = CompiledBlocks.CheckKey(ofs);
+	if (found != nullptr)
+	{
+		return *found;
+	}
+	ACSCompiledBlock *block = CompileBlock(pc);
+	if (block == nullptr)
+	{
+		NotCompiled[ofs >> 3] |= 1 << (ofs & 7);
+	}
+	else
+	{
+		CompiledBlocks[ofs] = block;
+	}
+	return block;
+}
+
+//==========================================================================
+//
+// FBehavior :: CompileBlock
+//
+//==========================================================================
+
+ACSCompiledBlock *FBehavior::CompileBlock(int *pc)
+{
+	TArray<ACSRunOp> run;
+	int *end;
+	unsigned count = DecodeACSRun(this, pc, run, end);
+
+	// A single p-code is not worth it.
+	if (count < 2)
+	{
+		return nullptr;
+	}
+
+	ACSCompiledBlock block = {};
+	block.InstrCount = count;
+	block.Exit[0] = block.Exit[1] = end;
+
+	// Work out the stack and variable reach of the block and where it exits.
+	int depth = 0;
+	for (auto &rop : run)
+	{
+		int op, kind;
+		int pops = 0, pushes = 0;
+		switch (rop.Pcd)
+		{
+		case PCD_PUSHNUMBER:	pushes = 1; break;
+		case PCD_DUP:			pops = 1; pushes = 2; break;
+		case PCD_SWAP:			pops = 2; pushes = 2; break;
+		case PCD_DROP:			pops = 1; break;
+		case PCD_NEGATELOGICAL:
+		case PCD_NEGATEBINARY:
+		case PCD_UNARYMINUS:	pops = 1; pushes = 1; break;
+		case PCD_GOTO:			block.Exit[0] = block.Exit[1] = rop.Target; break;
+		case PCD_IFGOTO:
+		case PCD_IFNOTGOTO:		pops = 1; block.Exit[1] = rop.Target; break;
+
+		case PCD_LSPEC1:
+		case PCD_LSPEC2:
+		case PCD_LSPEC3:
+		case PCD_LSPEC4:
+		case PCD_LSPEC5:
+			block.Special = rop.Arg;
+			block.SpecialArgs = rop.Pcd - PCD_LSPEC1 + 1;
+			// The arguments must be on the stack when the special runs.
+			block.StackLow = std::min(block.StackLow, depth - block.SpecialArgs);
+			break;
+
+		default:
+			if (IsACSBinaryOp(rop.Pcd))
+			{
+				pops = 2;
+				pushes = 1;
+			}
+			else if (DecodeACSVarOp(rop.Pcd, op, kind))
+			{
+				if (op == VOP_Push) pushes = 1;
+				else if (op != VOP_Inc && op != VOP_Dec) pops = 1;
+				if (kind == VAR_Script) block.LocalsUsed = std::max(block.LocalsUsed, unsigned(rop.Arg + 1));
+			}
+			break;
+		}
+		depth -= pops;
+		block.StackLow = std::min(block.StackLow, depth);
+		depth += pushes;
+		block.StackHigh = std::max(block.StackHigh, depth);
+	}
+	block.StackDelta = depth;
+
+#ifdef HAVE_VM_JIT
+	if (acs_jit)
+	{
+		using namespace asmjit;
+
+		CodeHolder code;
+		code.init(ACSJitRuntime.getCodeInfo());
+		FACSBlockCompiler compiler(&code, this);
+		if (compiler.Compile(run) && ACSJitRuntime.add(&block.Func, &code) == kErrorOk)
+		{
+			return new ACSCompiledBlock(block);
+		}
+		block.Func = nullptr;
+	}
+#endif
+
+	TArray<ACSBlockOp> ops;
+	BuildACSBlockOps(this, run, ops);
+	block.Ops = new ACSBlockOp[ops.Size()];
+	memcpy(block.Ops, ops.Data(), ops.Size() * sizeof(ACSBlockOp));
+	return new ACSCompiledBlock(block);
+}
+
+void FBehavior::ReleaseCompiledBlocks()
+{
+	decltype(CompiledBlocks)::Iterator it(CompiledBlocks);
+	decltype(CompiledBlocks)::Pair *pair;
+	while (it.NextPair(pair))
+	{
+#ifdef HAVE_VM_JIT
+		if (pair->Value->Func != nullptr)
+		{
+			ACSJitRuntime.release(pair->Value->Func);
+		}
+#endif
+		delete[] pair->Value->Ops;
+		delete pair->Value;
+	}
+	CompiledBlocks.Clear();
+	NotCompiled.Clear();
+}
+
+int DLevelScript::RunScript()
+{
+	DACSThinker *controller = Level->ACSThinker;
+	ACSLocalVariables locals(Localvars);
+	ACSLocalArrays noarrays;
+	ACSLocalArrays *localarrays = &noarrays;
+	ScriptFunction *activeFunction = NULL;
+	FRemapTable *translation = 0;
+	int resultValue = 1;
+	int transi = -1;
+
+	if (InModuleScriptNumber >= 0)
+	{
+		ScriptPtr *ptr = activeBehavior->GetScriptPtr(InModuleScriptNumber);
+		assert(ptr != NULL);
+		if (ptr != NULL)
+		{
+			localarrays = &ptr->LocalArrays;
+		}
+	}
+
+	// Hexen truncates all special arguments to bytes (only when using an old MAPINFO and old ACS format
+	const int specialargmask = ((Level->flags2 & LEVEL2_HEXENHACK) && activeBehavior->GetFormat() == ACS_Old) ? 255 : ~0;
+
+	switch (state)
+	{
+	case SCRIPT_Delayed:
+		// Decrement the delay counter and enter state running
+		// if it hits 0
+		if (--statedata == 0)
+			state = SCRIPT_Running;
+		break;
+
+	case SCRIPT_TagWait:
+		// Wait for tagged sector(s) to go inactive, then enter
+		// state running
+	{
+		int secnum;
+		auto it = Level->GetSectorTagIterator(statedata);
+		while ((secnum = it.Next()) >= 0)
+		{
+			if (Level->sectors[secnum].floordata || Level->sectors[secnum].ceilingdata)
+				return resultValue;
+		}
+
+		// If we got here, none of the tagged sectors were busy
+		state = SCRIPT_Running;
+	}
+	break;
+
+	case SCRIPT_PolyWait:
+		// Wait for polyobj(s) to stop moving, then enter state running
+		if (!PO_Busy (Level, statedata))
 		{
 			state = SCRIPT_Running;
 		}
@@ -6867,6 +8118,27 @@ int DLevelScript::RunScript()
 			break;
 		}
 
+		const ACSCompiledBlock *block = activeBehavior->FindCompiledBlock(pc);
+		if (block != nullptr && sp + block->StackLow >= 0 && sp + block->StackHigh <= STACK_SIZE && block->LocalsUsed <= locals.Size())
+		{
+			int32_t *blockstack = Stack.Pointer() + sp;
+			int exit = block->Func != nullptr ? block->Func(blockstack, locals.GetPointer()) : RunACSBlockOps(block->Ops, blockstack, locals.GetPointer());
+			pc = block->Exit[exit];
+			sp += block->StackDelta;
+			runaway += block->InstrCount - 1;
+			if (block->SpecialArgs > 0)
+			{
+				int args[5] = {};
+				for (int i = 0; i < block->SpecialArgs; i++)
+				{
+					args[i] = STACK(block->SpecialArgs - i) & specialargmask;
+				}
+				P_ExecuteSpecial(Level, block->Special, activationline, activator, backSide, args[0], args[1], args[2], args[3], args[4]);
+				sp -= block->SpecialArgs;
+			}
+			continue;
+		}
+
 		if (fmt == ACS_LittleEnhanced)
 		{
 			pcd = getbyte(pc);
@@ -115,31 +115,56 @@ public:
 	void Dump() const;
 	void UnlockForLevel(int level)	;
 	void ReadStrings(FSerializer &file, const char *key);
-	void WriteStrings(FSerializer &file, const char *key) const;
+	void WriteStrings(FSerializer &file, const char *key);
 
-private:
-	int FindString(const char *str, size_t len, unsigned int h, unsigned int bucketnum);
-	int InsertString(FString &str, unsigned int h, unsigned int bucketnum);
-	void FindFirstFreeEntry(unsigned int base);
+	bool NeedsCollection() const { return !Sweeping && NumUsed >= GCThreshold; }
+	void StartSweep();
+	bool SweepStep(uint64_t deadline);
+	void FinishSweep();
+	bool IsSweeping() const { return Sweeping; }
+	unsigned int Size() const { return NumUsed; }
 
-	enum { NUM_BUCKETS = 251 };
-	enum { FREE_ENTRY = 0xFFFFFFFE };	// Stored in PoolEntry's Next field
-	enum { NO_ENTRY = 0xFFFFFFFF };
+private:
+	int FindString(const char *str, size_t len, unsigned int h);
+	int InsertString(FString &str, unsigned int h);
+	void InsertIndex(unsigned int num);
+	void RemoveIndex(unsigned int num);
+	void ResizeIndex(unsigned int size);
+	bool IsLocked(unsigned int num) const;
+	void FreeEntry(unsigned int num);
+
+	enum { NO_ENTRY = 0xFFFFFFFF };		// Empty slot in the hash index
+	enum { DELETED_ENTRY = 0xFFFFFFFE };	// Slot of a removed string in the hash index
+	enum { MIN_INDEX_SIZE = 256 };
 	enum { MIN_GC_SIZE = 100 };			// Don't auto-collect until there are this many strings
+	enum { MAX_POOL_SIZE = 1 << LIBRARYID_SHIFT };	// Larger indices would collide with the library ID
+
 	struct PoolEntry
 	{
 		FString Str;
 		unsigned int Hash;
-		unsigned int Next = FREE_ENTRY;
-		bool Mark;
-		TArray<int> Locks;
+		bool Used = false;
+		bool Mark = false;
+	};
 
-		void Lock(int levelnum);
-		void Unlock(int levelnum);
+	// One bit per pool entry for every level that holds locks.
+	struct LockSet
+	{
+		int Level;
+		TArray<uint32_t> Bits;
 	};
+
 	TArray<PoolEntry> Pool;
-	unsigned int PoolBuckets[NUM_BUCKETS];
-	unsigned int FirstFreeEntry;
+	TArray<unsigned int> Index;			// open addressing with linear probing, power of 2 in size
+	TArray<unsigned int> FreeEntries;
+	TArray<LockSet> Locks;
+	unsigned int NumUsed = 0;
+	unsigned int NumDeleted = 0;		// DELETED_ENTRY slots in the index
+	unsigned int GCThreshold = MIN_GC_SIZE;
+	unsigned int SweepPos = 0;
+	bool Sweeping = false;
+
+	LockSet &GetLockSet(int levelnum);
 };
 extern ACSStringPool GlobalACSStrings;
 
@@ -200,6 +225,16 @@ public:
 		return memory;
 	}
 
+	int32_t *GetPointer()
+	{
+		return memory;
+	}
+
+	size_t Size() const
+	{
+		return count;
+	}
+
 private:
 	int32_t *memory;
 	size_t count;
@@ -344,6 +379,25 @@ enum
 
 enum ACSFormat { ACS_Old, ACS_Enhanced, ACS_LittleEnhanced, ACS_Unknown };
 
+// A run of p-code that is executed as one unit. It is either compiled to
+// native code (Func) or, without the JIT, pre-decoded into Ops. Exactly one
+// of the two is set.
+struct ACSBlockOp;
+
+struct ACSCompiledBlock
+{
+	int (*Func)(int32_t *stack, int32_t *locals);	// returns the index into Exit to continue at
+	ACSBlockOp *Ops;	// pre-decoded operations, used when there is no native code
+	int *Exit[2];
+	int StackDelta;		// change of the stack pointer after the block ran
+	int StackLow;		// lowest stack slot accessed, relative to the stack pointer on entry
+	int StackHigh;		// one past the highest stack slot accessed
+	unsigned LocalsUsed;
+	unsigned InstrCount;
+	int Special;		// line special to execute with the top SpecialArgs stack values after the block
+	int SpecialArgs;
+};
+
 
 class FBehavior
 {
@@ -379,6 +433,7 @@ public:
 	ACSProfileInfo *GetFunctionProfileData(int index) { return index >= 0 && index < NumFunctions ? &FunctionProfileData[index] : NULL; }
 	ACSProfileInfo *GetFunctionProfileData(ScriptFunction *func) { return GetFunctionProfileData((int)(func - (ScriptFunction *)Functions)); }
 	const char *LookupString (uint32_t index, bool forprint = false) const;
+	const ACSCompiledBlock *FindCompiledBlock (int *pc);
 
 	BoundsCheckingArray<int32_t *, NUM_MAPVARS> MapVars;
 
@@ -410,6 +465,11 @@ private:
 	TArray<FBehavior *> Imports;
 	char ModuleName[9];
 	TArray<int> JumpPoints;
+	TOpenMap<uint32_t, ACSCompiledBlock *> CompiledBlocks;
+	TArray<uint8_t> NotCompiled;	// one bit per byte of Data, set where no block could be compiled
+
+	ACSCompiledBlock *CompileBlock (int *pc);
+	void ReleaseCompiledBlocks ();
 
 	void LoadScriptsDirectory ();
 
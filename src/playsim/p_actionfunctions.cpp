@@ -92,7 +92,6 @@ FRandom pr_cajump("CustomJump", false);
 // until there is no next state
 //
 //==========================================================================
-extern TArray<VMValue> actionParams;	// this can use the same storage as CallAction
 
 
 static int CallStateChain (AActor *self, AActor *actor, FState *state)
@@ -168,34 +167,7 @@ static int CallStateChain (AActor *self, AActor *actor, FState *state)
 			try
 			{
                 state->CheckCallerType(actor, self);
-
-				if (state->ActionFunc->DefaultArgs.Size() > 0)
-				{
-					auto defs = state->ActionFunc->DefaultArgs;
-					auto index = actionParams.Reserve(defs.Size());
-					for (unsigned i = 0; i < defs.Size(); i++)
-					{
-						actionParams[i + index] = defs[i];
-					}
-
-					if (state->ActionFunc->ImplicitArgs >= 1)
-					{
-						actionParams[index] = actor;
-					}
-					if (state->ActionFunc->ImplicitArgs == 3)
-					{
-						actionParams[index + 1] = self;
-						actionParams[index + 2] = VMValue(&stp);
-					}
-
-					VMCallAction(state->ActionFunc, &actionParams[index], state->ActionFunc->DefaultArgs.Size(), wantret, numret);
-					actionParams.Clamp(index);
-				}
-				else
-				{
-					VMValue params[3] = { actor, self, VMValue(&stp) };
-					VMCallAction(state->ActionFunc, params, state->ActionFunc->ImplicitArgs, wantret, numret);
-				}
+				state->InvokeAction(actor, self, &stp, wantret, numret);
 			}
 			catch (CVMAbortException &err)
 			{
@@ -99,6 +99,7 @@
 #include "actorinlines.h"
 #include "a_dynlight.h"
 #include "fragglescript/t_fs.h"
+#include "types.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -4665,6 +4666,309 @@ DEFINE_ACTION_FUNCTION(AActor, Spawn)
 	ACTION_RETURN_OBJECT(AActor::StaticSpawn(currentVMLevel, type, DVector3(x, y, z), replace_t(flags)));
 }
 
+//==========================================================================
+//
+// Actor recycling pools
+//
+// Short-lived effect actors (casings, sparks, debris) can be handed back to
+// the level with ReleaseToPool instead of being destroyed. They get torn
+// down like a destroyed actor and leave the thinker lists, but the memory
+// stays allocated, so the next SpawnPooled of that class only has to copy
+// the class defaults back over the instance and run the regular spawn
+// logic.
+//
+// Stale references to a parked actor read as null, like those to a
+// destroyed one, and the collector's mark phase clears every traced one it
+// finds. So a released actor only becomes reusable once a complete
+// collection has started after its release, otherwise a reference that was
+// not read in the meantime would point to the new actor. This also keeps it
+// out of reach for the rest of the tic in which it was released.
+//
+//==========================================================================
+
+CVAR(Int, sv_actorpoolsize, 64, CVAR_SERVERINFO)
+
+static int PoolLimit(const FActorPool &pool)
+{
+	return pool.Limit >= 0 ? pool.Limit : MAX<int>(sv_actorpoolsize, 0);
+}
+
+static void DisposePooledActor(AActor *actor)
+{
+	// It already has OF_EuthanizeMe so the collector will free it without calling Destroy again.
+	actor->ObjectFlags &= ~(OF_Fixed | OF_Pooled);
+}
+
+//==========================================================================
+//
+// Everything past the DThinker header is copied back from the defaults,
+// except for the members that own memory. Native ones are emptied in place,
+// script strings and arrays are rebuilt through their type.
+//
+//==========================================================================
+
+static void BuildResetRanges(PClass *cls, TArray<FActorPool::FResetRange> &ranges)
+{
+	TArray<FActorPool::FResetRange> holes;
+	holes.Push({ (unsigned)myoffsetof(AActor, AttachedLights), (unsigned)sizeof(AActor::AttachedLights) });
+	holes.Push({ (unsigned)myoffsetof(AActor, UserLights), (unsigned)sizeof(AActor::UserLights) });
+	for (PClass *p = cls; p != nullptr && p->bRuntimeClass; p = p->ParentClass)
+	{
+		for (auto &tao : p->SpecialInits)
+		{
+			holes.Push({ tao.second, tao.first->Size });
+		}
+	}
+	std::sort(holes.begin(), holes.end(), [](const FActorPool::FResetRange &a, const FActorPool::FResetRange &b)
+	{
+		return a.Offset < b.Offset;
+	});
+
+	unsigned pos = sizeof(DThinker);
+	for (auto &hole : holes)
+	{
+		if (hole.Offset > pos) ranges.Push({ pos, hole.Offset - pos });
+		pos = MAX(pos, hole.Offset + hole.Length);
+	}
+	if (cls->Size > pos) ranges.Push({ pos, cls->Size - pos });
+}
+
+static void ResetPooledActor(AActor *actor, FActorPool &pool)
+{
+	PClass *cls = actor->GetClass();
+	auto defaults = (uint8_t *)cls->Defaults;
+
+	if (pool.ResetRanges.Size() == 0)
+	{
+		BuildResetRanges(cls, pool.ResetRanges);
+	}
+	cls->DestroySpecials(actor);
+	for (auto &range : pool.ResetRanges)
+	{
+		memcpy((uint8_t *)actor + range.Offset, defaults + range.Offset, range.Length);
+	}
+	cls->InitializeSpecials(actor, defaults, &PClass::SpecialInits);
+	actor->AttachedLights.Clear();
+	actor->UserLights.DeleteAndClear();
+}
+
+//==========================================================================
+//
+// FLevelLocals :: SpawnPooled
+//
+// Falls back to a normal spawn when the pool has nothing to offer.
+//
+//==========================================================================
+
+AActor *FLevelLocals::SpawnPooled(PClassActor *type, const DVector3 &pos, replace_t allowreplacement)
+{
+	if (type == nullptr || type->bAbstract)
+	{
+		// Let StaticSpawn report the error.
+		return AActor::StaticSpawn(this, type, pos, allowreplacement);
+	}
+	if (allowreplacement)
+	{
+		type = type->GetReplacement(this);
+	}
+
+	auto pool = ActorPools.CheckKey(type);
+	AActor *actor;
+	if (pool == nullptr || !pool->Actors.Pop(actor))
+	{
+		return AActor::StaticSpawn(this, type, pos, NO_REPLACE);
+	}
+	pool->Count--;
+
+	ResetPooledActor(actor, *pool);
+	actor->ObjectFlags = (actor->ObjectFlags & ~(OF_EuthanizeMe | OF_Fixed | OF_Pooled | OF_Spawned)) | OF_JustSpawned;
+	Thinkers.Link(actor, STAT_DEFAULT);
+	ConstructActor(actor, pos, false);
+	return actor;
+}
+
+//==========================================================================
+//
+// FLevelLocals :: ReleaseToPool
+//
+// Returns false if the actor got destroyed instead, which happens for
+// anything that is not safe to recycle and when the pool is full.
+//
+//==========================================================================
+
+bool FLevelLocals::ReleaseToPool(AActor *actor)
+{
+	if (actor == nullptr || (actor->ObjectFlags & OF_EuthanizeMe))
+	{
+		return false;
+	}
+
+	auto pool = &ActorPools[actor->GetClass()];
+	if (actor->Level != this || actor->player != nullptr || actor->IsKindOf(NAME_PlayerPawn) ||
+		actor->IsKindOf(NAME_Inventory) || pool->Count >= (unsigned)PoolLimit(*pool))
+	{
+		actor->Destroy();
+		return false;
+	}
+
+	IFVIRTUALPTR(actor, DObject, OnDestroy)
+	{
+		VMValue params[1] = { (DObject*)actor };
+		VMCall(func, params, 1, nullptr, 0);
+	}
+	if (actor->ObjectFlags & OF_EuthanizeMe)
+	{
+		// The script side destroyed it for real.
+		return false;
+	}
+	actor->Unspawn();
+	actor->Remove();
+	actor->ObjectFlags |= OF_EuthanizeMe | OF_Fixed | OF_Pooled;
+	// The script may have released other actors, so the pool may have moved.
+	ActorPools[actor->GetClass()].Count++;
+	// A mark phase that is already under way may have passed the objects referencing it.
+	ReleasedActors.Push({ actor, GC::CycleCount + (GC::State == GC::GCS_Pause ? 1 : 2) });
+	return true;
+}
+
+//==========================================================================
+//
+// FLevelLocals :: SetPoolLimit
+//
+// A negative limit reverts the class to sv_actorpoolsize.
+//
+//==========================================================================
+
+void FLevelLocals::SetPoolLimit(PClassActor *type, int limit)
+{
+	auto &pool = ActorPools[type];
+	pool.Limit = limit;
+
+	AActor *actor;
+	while (pool.Count > (unsigned)PoolLimit(pool) && pool.Actors.Pop(actor))
+	{
+		DisposePooledActor(actor);
+		pool.Count--;
+	}
+}
+
+//==========================================================================
+//
+// FLevelLocals :: RemovePooledActor
+//
+// Called when a parked actor gets destroyed through a stale pointer.
+//
+//==========================================================================
+
+void FLevelLocals::RemovePooledActor(AActor *actor)
+{
+	auto pool = ActorPools.CheckKey(actor->GetClass());
+	unsigned index = ReleasedActors.FindEx([=](const FReleasedActor &released) { return released.Actor == actor; });
+	if (index < ReleasedActors.Size())
+	{
+		ReleasedActors.Delete(index);
+	}
+	else if (pool != nullptr && (index = pool->Actors.Find(actor)) < pool->Actors.Size())
+	{
+		pool->Actors.Delete(index);
+	}
+	else return;
+	if (pool != nullptr) pool->Count--;
+}
+
+//==========================================================================
+//
+// FLevelLocals :: RecycleReleasedActors
+//
+// Called once all thinkers have run. Makes the released actors reusable
+// that the collector has finished clearing references to.
+//
+//==========================================================================
+
+void FLevelLocals::RecycleReleasedActors()
+{
+	unsigned kept = 0;
+	for (auto &released : ReleasedActors)
+	{
+		if (GC::CycleCount >= released.Cycle)
+		{
+			ActorPools[released.Actor->GetClass()].Actors.Push(released.Actor);
+		}
+		else
+		{
+			ReleasedActors[kept++] = released;
+		}
+	}
+	ReleasedActors.Clamp(kept);
+}
+
+//==========================================================================
+//
+// FLevelLocals :: ClearActorPools
+//
+//==========================================================================
+
+void FLevelLocals::ClearActorPools()
+{
+	for (auto &released : ReleasedActors)
+	{
+		DisposePooledActor(released.Actor);
+	}
+	TMap<PClassActor *, FActorPool>::Iterator it(ActorPools);
+	TMap<PClassActor *, FActorPool>::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		for (auto actor : pair->Value.Actors)
+		{
+			DisposePooledActor(actor);
+		}
+	}
+	ReleasedActors.Clear();
+	ActorPools.Clear();
+}
+
+static AActor *SpawnPooled(PClassActor *type, double x, double y, double z, int flags)
+{
+	return currentVMLevel->SpawnPooled(type, DVector3(x, y, z), replace_t(flags));
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(AActor, SpawnPooled, SpawnPooled)
+{
+	PARAM_PROLOGUE;
+	PARAM_CLASS_NOT_NULL(type, AActor);
+	PARAM_FLOAT(x);
+	PARAM_FLOAT(y);
+	PARAM_FLOAT(z);
+	PARAM_INT(flags);
+	ACTION_RETURN_OBJECT(SpawnPooled(type, x, y, z, flags));
+}
+
+static int ReleaseToPool(FLevelLocals *self, AActor *actor)
+{
+	return self->ReleaseToPool(actor);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FLevelLocals, ReleaseToPool, ReleaseToPool)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FLevelLocals);
+	PARAM_OBJECT(actor, AActor);
+	ACTION_RETURN_BOOL(ReleaseToPool(self, actor));
+}
+
+static void SetPoolLimit(FLevelLocals *self, PClassActor *type, int limit)
+{
+	self->SetPoolLimit(type, limit);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FLevelLocals, SetPoolLimit, SetPoolLimit)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FLevelLocals);
+	PARAM_CLASS_NOT_NULL(type, AActor);
+	PARAM_INT(limit);
+	SetPoolLimit(self, type, limit);
+	return 0;
+}
+
 PClassActor *ClassForSpawn(FName classname)
 {
 	PClass *cls = PClass::FindClass(classname);
@@ -4912,6 +5216,21 @@ void AActor::CallDeactivate(AActor *activator)
 //===========================================================================
 
 void AActor::OnDestroy ()
+{
+	if (ObjectFlags & OF_Pooled)
+	{
+		// Everything was already torn down when this was released to the pool.
+		Level->RemovePooledActor(this);
+		ObjectFlags &= ~OF_Pooled;
+	}
+	else
+	{
+		Unspawn();
+	}
+	Super::OnDestroy();
+}
+
+void AActor::Unspawn()
 {
 	// [ZZ] call destroy event hook.
 	//      note that this differs from ThingSpawned in that you can actually override OnDestroy to avoid calling the hook.
@@ -4938,8 +5257,6 @@ void AActor::OnDestroy ()
 
 	// Transform any playing sound into positioned, non-actor sounds.
 	S_RelinkSound (this, NULL);
-
-	Super::OnDestroy();
 }
 
 //===========================================================================
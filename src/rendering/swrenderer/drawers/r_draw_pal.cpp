@@ -34,7 +34,7 @@
 */
 
 #ifndef NO_SSE
-#include <xmmintrin.h>
+#include <emmintrin.h>
 #endif
 #include "templates.h"
 #include "doomtype.h"
@@ -45,6 +45,7 @@
 #include "r_draw_pal.h"
 #include "swrenderer/viewport/r_viewport.h"
 #include "swrenderer/scene/r_light.h"
+#include "x86.h"
 
 // [SP] r_blendmethod - false = rgb555 matching (ZDoom classic), true = rgb666 (refactored)
 CVAR(Bool, r_blendmethod, false, CVAR_GLOBALCONFIG | CVAR_ARCHIVE)
@@ -2088,6 +2089,113 @@ namespace swrenderer
 		return RGB256k.All[((lit_r >> 2) << 12) | ((lit_g >> 2) << 6) | (lit_b >> 2)];
 	}
 
+#ifndef NO_SSE
+	// Low 32 bits of a 32x32 bit multiply per lane (SSE2 lacks _mm_mullo_epi32)
+	static inline __m128i MulLo32SSE2(__m128i a, __m128i b)
+	{
+		__m128i even = _mm_mul_epu32(a, b);
+		__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+		return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	}
+
+	enum class PalSpanBlend { Copy, Translucent, AddClamp };
+
+	// Draws the bulk of a span four pixels at a time, for the rgb555 blend method without
+	// dynamic lights. The texture coordinates and the blend math are done in vector registers,
+	// only the table lookups stay scalar since SSE2 has no gathers. Returns the number of pixels
+	// drawn and advances xfrac and yfrac past them, the remainder is left to the scalar loop.
+	template<PalSpanBlend Blend, bool Masked>
+	static int DrawSpanSSE2(uint8_t *dest, int count, uint32_t &xfrac, uint32_t &yfrac, uint32_t xstep, uint32_t ystep, uint32_t srcwidth, uint32_t srcheight,
+		const uint8_t *source, const uint8_t *colormap, const uint32_t *fg2rgb, const uint32_t *bg2rgb)
+	{
+		int n = count & ~3;
+		if (n == 0)
+			return 0;
+
+		__m128i lane = _mm_setr_epi32(0, 1, 2, 3);
+		__m128i x = _mm_add_epi32(_mm_set1_epi32(xfrac), MulLo32SSE2(_mm_set1_epi32(xstep), lane));
+		__m128i y = _mm_add_epi32(_mm_set1_epi32(yfrac), MulLo32SSE2(_mm_set1_epi32(ystep), lane));
+		__m128i xstep4 = _mm_set1_epi32(xstep * 4);
+		__m128i ystep4 = _mm_set1_epi32(ystep * 4);
+		__m128i width = _mm_set1_epi32(srcwidth);
+		__m128i height = _mm_set1_epi32(srcheight);
+		bool is64x64 = srcwidth == 64 && srcheight == 64;
+
+		alignas(16) uint32_t spots[4];
+		alignas(16) uint32_t blended[4];
+		uint8_t texel[4];
+
+		for (int i = 0; i < n; i += 4)
+		{
+			__m128i spot;
+			if (is64x64)
+			{
+				spot = _mm_and_si128(_mm_srli_epi32(x, 32 - 6 - 6), _mm_set1_epi32(63 * 64));
+				spot = _mm_add_epi32(spot, _mm_srli_epi32(y, 32 - 6));
+			}
+			else
+			{
+				__m128i u = _mm_srli_epi32(MulLo32SSE2(_mm_srli_epi32(x, 16), width), 16);
+				__m128i v = _mm_srli_epi32(MulLo32SSE2(_mm_srli_epi32(y, 16), height), 16);
+				spot = _mm_add_epi32(MulLo32SSE2(u, height), v);
+			}
+			_mm_store_si128((__m128i*)spots, spot);
+			x = _mm_add_epi32(x, xstep4);
+			y = _mm_add_epi32(y, ystep4);
+
+			for (int j = 0; j < 4; j++)
+				texel[j] = source[spots[j]];
+
+			uint8_t *d = dest + i;
+			uint8_t out[4];
+			if (Blend == PalSpanBlend::Copy)
+			{
+				for (int j = 0; j < 4; j++)
+					out[j] = colormap[texel[j]];
+			}
+			else
+			{
+				__m128i a = _mm_setr_epi32(
+					fg2rgb[colormap[texel[0]]] + bg2rgb[d[0]],
+					fg2rgb[colormap[texel[1]]] + bg2rgb[d[1]],
+					fg2rgb[colormap[texel[2]]] + bg2rgb[d[2]],
+					fg2rgb[colormap[texel[3]]] + bg2rgb[d[3]]);
+				if (Blend == PalSpanBlend::Translucent)
+				{
+					a = _mm_or_si128(a, _mm_set1_epi32(0x1f07c1f));
+				}
+				else
+				{
+					__m128i b = _mm_and_si128(a, _mm_set1_epi32(0x40100400));
+					a = _mm_and_si128(_mm_or_si128(a, _mm_set1_epi32(0x01f07c1f)), _mm_set1_epi32(0x3fffffff));
+					a = _mm_or_si128(a, _mm_sub_epi32(b, _mm_srli_epi32(b, 5)));
+				}
+				a = _mm_and_si128(a, _mm_srli_epi32(a, 15));
+				_mm_store_si128((__m128i*)blended, a);
+				for (int j = 0; j < 4; j++)
+					out[j] = RGB32k.All[blended[j]];
+			}
+
+			if (Masked)
+			{
+				for (int j = 0; j < 4; j++)
+				{
+					if (texel[j] != 0)
+						d[j] = out[j];
+				}
+			}
+			else
+			{
+				memcpy(d, out, 4);
+			}
+		}
+
+		xfrac += xstep * n;
+		yfrac += ystep * n;
+		return n;
+	}
+#endif
+
 	void DrawSpanPalCommand::Execute(DrawerThread *thread)
 	{
 		if (thread->line_skipped_by_thread(_y))
@@ -2118,6 +2226,18 @@ namespace swrenderer
 		float viewpos_x = _viewpos_x;
 		float step_viewpos_x = _step_viewpos_x;
 
+
+#ifndef NO_SSE
+		if (num_dynlights == 0 && CPU.bSSE2)
+		{
+			int drawn = DrawSpanSSE2<PalSpanBlend::Copy, false>(dest, count, xfrac, yfrac, xstep, ystep, _srcwidth, _srcheight, source, colormap, nullptr, nullptr);
+			dest += drawn;
+			count -= drawn;
+			if (count == 0)
+				return;
+		}
+#endif
+
 		if (_srcwidth == 64 && _srcheight == 64 && num_dynlights == 0)
 		{
 			// 64x64 is the most common case by far, so special case it.
@@ -2205,6 +2325,18 @@ namespace swrenderer
 		float viewpos_x = _viewpos_x;
 		float step_viewpos_x = _step_viewpos_x;
 
+
+#ifndef NO_SSE
+		if (num_dynlights == 0 && CPU.bSSE2)
+		{
+			int drawn = DrawSpanSSE2<PalSpanBlend::Copy, true>(dest, count, xfrac, yfrac, xstep, ystep, _srcwidth, _srcheight, source, colormap, nullptr, nullptr);
+			dest += drawn;
+			count -= drawn;
+			if (count == 0)
+				return;
+		}
+#endif
+
 		if (_srcwidth == 64 && _srcheight == 64)
 		{
 			// 64x64 is the most common case by far, so special case it.
@@ -2281,6 +2413,18 @@ namespace swrenderer
 		float viewpos_x = _viewpos_x;
 		float step_viewpos_x = _step_viewpos_x;
 
+
+#ifndef NO_SSE
+		if (!r_blendmethod && num_dynlights == 0 && CPU.bSSE2)
+		{
+			int drawn = DrawSpanSSE2<PalSpanBlend::Translucent, false>(dest, count, xfrac, yfrac, xstep, ystep, _srcwidth, _srcheight, source, colormap, fg2rgb, bg2rgb);
+			dest += drawn;
+			count -= drawn;
+			if (count == 0)
+				return;
+		}
+#endif
+
 		if (!r_blendmethod)
 		{
 			if (_srcwidth == 64 && _srcheight == 64)
@@ -2397,6 +2541,18 @@ namespace swrenderer
 		xstep = _xstep;
 		ystep = _ystep;
 
+
+#ifndef NO_SSE
+		if (!r_blendmethod && num_dynlights == 0 && CPU.bSSE2)
+		{
+			int drawn = DrawSpanSSE2<PalSpanBlend::Translucent, true>(dest, count, xfrac, yfrac, xstep, ystep, _srcwidth, _srcheight, source, colormap, fg2rgb, bg2rgb);
+			dest += drawn;
+			count -= drawn;
+			if (count == 0)
+				return;
+		}
+#endif
+
 		if (!r_blendmethod)
 		{
 			if (_srcwidth == 64 && _srcheight == 64)
@@ -2538,6 +2694,18 @@ namespace swrenderer
 		xstep = _xstep;
 		ystep = _ystep;
 
+
+#ifndef NO_SSE
+		if (!r_blendmethod && num_dynlights == 0 && CPU.bSSE2)
+		{
+			int drawn = DrawSpanSSE2<PalSpanBlend::AddClamp, false>(dest, count, xfrac, yfrac, xstep, ystep, _srcwidth, _srcheight, source, colormap, fg2rgb, bg2rgb);
+			dest += drawn;
+			count -= drawn;
+			if (count == 0)
+				return;
+		}
+#endif
+
 		if (!r_blendmethod)
 		{
 			if (_srcwidth == 64 && _srcheight == 64)
@@ -2661,6 +2829,18 @@ namespace swrenderer
 		xstep = _xstep;
 		ystep = _ystep;
 
+
+#ifndef NO_SSE
+		if (!r_blendmethod && num_dynlights == 0 && CPU.bSSE2)
+		{
+			int drawn = DrawSpanSSE2<PalSpanBlend::AddClamp, true>(dest, count, xfrac, yfrac, xstep, ystep, _srcwidth, _srcheight, source, colormap, fg2rgb, bg2rgb);
+			dest += drawn;
+			count -= drawn;
+			if (count == 0)
+				return;
+		}
+#endif
+
 		if (!r_blendmethod)
 		{
 			if (_srcwidth == 64 && _srcheight == 64)
@@ -81,6 +81,29 @@ CVAR(Float, r_lod_bias, -1.5, 0); // To do: add CVAR_ARCHIVE | CVAR_GLOBALCONFIG
 
 namespace swrenderer
 {
+	int TruecolorDrawersGeneration;
+}
+
+// Instruction set used by the truecolor drawers: 0 = best available, 1 = SSE2, 2 = AVX2.
+// The render threads pick up a change before the next scene is drawn.
+CUSTOM_CVAR(Int, r_truecolorsimd, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG | CVAR_NOINITCALL)
+{
+	swrenderer::TruecolorDrawersGeneration++;
+}
+
+namespace swrenderer
+{
+	SWTruecolorDrawers *CreateTruecolorDrawers(DrawerCommandQueuePtr queue)
+	{
+#if defined(ARCH_IA32) && !defined(NO_SSE)
+		if (CPU.bAVX2 && (r_truecolorsimd == 0 || r_truecolorsimd >= 2))
+			return CreateTruecolorDrawersAVX2(queue);
+#endif
+		return new SWTruecolorDrawers(queue);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
 	void SWTruecolorDrawers::DrawWall(const WallDrawerArgs &args)
 	{
 		Queue->Push<DrawWall32Command>(args);
@@ -250,6 +273,26 @@ namespace swrenderer
 		Queue->Push<DrawSkyDouble32Command>(args);
 	}
 
+	void SWTruecolorDrawers::FillSpan(const SpanDrawerArgs &args)
+	{
+		Queue->Push<FillSpanRGBACommand>(args);
+	}
+
+	void SWTruecolorDrawers::DrawTiltedSpan(const SpanDrawerArgs &args, const FVector3 &plane_sz, const FVector3 &plane_su, const FVector3 &plane_sv, bool plane_shade, int planeshade, float planelightfloat, fixed_t pviewx, fixed_t pviewy, FDynamicColormap *basecolormap)
+	{
+		Queue->Push<DrawTiltedSpanRGBACommand>(args, plane_sz, plane_su, plane_sv, plane_shade, planeshade, planelightfloat, pviewx, pviewy);
+	}
+
+	void SWTruecolorDrawers::DrawColoredSpan(const SpanDrawerArgs &args)
+	{
+		Queue->Push<DrawColoredSpanRGBACommand>(args);
+	}
+
+	void SWTruecolorDrawers::DrawFogBoundaryLine(const SpanDrawerArgs &args)
+	{
+		Queue->Push<DrawFogBoundaryLineRGBACommand>(args);
+	}
+
 	/////////////////////////////////////////////////////////////////////////////
 
 	DrawScaledFuzzColumnRGBACommand::DrawScaledFuzzColumnRGBACommand(const SpriteDrawerArgs &drawerargs)
@@ -277,16 +277,22 @@ namespace swrenderer
 		void DrawSpanMaskedTranslucent(const SpanDrawerArgs &args) override;
 		void DrawSpanAddClamp(const SpanDrawerArgs &args) override;
 		void DrawSpanMaskedAddClamp(const SpanDrawerArgs &args) override;
-		void FillSpan(const SpanDrawerArgs &args) override { Queue->Push<FillSpanRGBACommand>(args); }
+		void FillSpan(const SpanDrawerArgs &args) override;
+		void DrawTiltedSpan(const SpanDrawerArgs &args, const FVector3 &plane_sz, const FVector3 &plane_su, const FVector3 &plane_sv, bool plane_shade, int planeshade, float planelightfloat, fixed_t pviewx, fixed_t pviewy, FDynamicColormap *basecolormap) override;
+		void DrawColoredSpan(const SpanDrawerArgs &args) override;
+		void DrawFogBoundaryLine(const SpanDrawerArgs &args) override;
+	};
 
-		void DrawTiltedSpan(const SpanDrawerArgs &args, const FVector3 &plane_sz, const FVector3 &plane_su, const FVector3 &plane_sv, bool plane_shade, int planeshade, float planelightfloat, fixed_t pviewx, fixed_t pviewy, FDynamicColormap *basecolormap) override
-		{
-			Queue->Push<DrawTiltedSpanRGBACommand>(args, plane_sz, plane_su, plane_sv, plane_shade, planeshade, planelightfloat, pviewx, pviewy);
-		}
+	// Picks the SSE2 or AVX2 build of the truecolor drawers (see r_truecolorsimd)
+	SWTruecolorDrawers *CreateTruecolorDrawers(DrawerCommandQueuePtr queue);
 
-		void DrawColoredSpan(const SpanDrawerArgs &args) override { Queue->Push<DrawColoredSpanRGBACommand>(args); }
-		void DrawFogBoundaryLine(const SpanDrawerArgs &args) override { Queue->Push<DrawFogBoundaryLineRGBACommand>(args); }
-	};
+	// Bumped whenever r_truecolorsimd changes so the render threads re-create their drawers
+	extern int TruecolorDrawersGeneration;
+
+#if defined(ARCH_IA32) && !defined(NO_SSE)
+	// Defined in r_draw_rgba_avx2.cpp. Only call this when the CPU has AVX2
+	SWTruecolorDrawers *CreateTruecolorDrawersAVX2(DrawerCommandQueuePtr queue);
+#endif
 
 	/////////////////////////////////////////////////////////////////////////////
 	// Pixel shading inline functions:
@@ -56,6 +56,7 @@
 #include "swrenderer/drawers/r_draw.h"
 #include "swrenderer/segments/r_clipsegment.h"
 #include "swrenderer/segments/r_drawsegment.h"
+#include "swrenderer/segments/r_coveragebuffer.h"
 #include "swrenderer/plane/r_visibleplane.h"
 #include "swrenderer/plane/r_visibleplanelist.h"
 #include "swrenderer/things/r_decal.h"
@@ -432,6 +433,8 @@ namespace swrenderer
 			draw_segment->drawsegclip.SetBottomClip(Thread, start, stop, Thread->OpaquePass->floorclip);
 		}
 
+		Thread->Coverage->AddSegment(draw_segment);
+
 		RenderMiddleTexture(start, stop);
 		RenderTopTexture(start, stop);
 		RenderBottomTexture(start, stop);
@@ -79,6 +79,8 @@ namespace swrenderer
 		int CurrentPortalUniq = 0; // mirror counter, counts all of them
 		int MirrorFlags = 0; // this is not related to CurrentMirror
 
+		unsigned Hash = 0; // hash of the properties that FindPlane matches on
+
 		uint16_t *bottom = nullptr;
 		uint16_t *top = nullptr;
 	};
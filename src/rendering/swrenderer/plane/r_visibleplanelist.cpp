@@ -73,6 +73,72 @@ namespace swrenderer
 		return newplane;
 	}
 
+	static unsigned HashCombine(unsigned hash, uint32_t value)
+	{
+		return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+	}
+
+	static unsigned HashCombine(unsigned hash, double value)
+	{
+		value += 0.0; // -0 and +0 compare equal
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return HashCombine(hash, (uint32_t)(bits ^ (bits >> 32)));
+	}
+
+	static unsigned HashCombine(unsigned hash, const void *ptr)
+	{
+		uintptr_t bits = (uintptr_t)ptr;
+		return HashCombine(hash, (uint32_t)(bits ^ ((uint64_t)bits >> 32)));
+	}
+
+	// Must agree with the comparisons in FindPlane. The view position is left out because
+	// FindPlane compares the current one against the position stacked sectors stored, and
+	// the portal is only compared for sky boxes, which have their own chain.
+	unsigned VisiblePlaneList::CalcHash(const secplane_t &height, FTextureID picnum, int lightlevel, FDynamicColormap *colormap, const FTransform &xform, int sky, int portalUniq, int mirrorFlags, int skybox)
+	{
+		unsigned hash = 0;
+		hash = HashCombine(hash, height.Normal().X);
+		hash = HashCombine(hash, height.Normal().Y);
+		hash = HashCombine(hash, height.Normal().Z);
+		hash = HashCombine(hash, height.fD());
+		hash = HashCombine(hash, (uint32_t)picnum.GetIndex());
+		hash = HashCombine(hash, (uint32_t)lightlevel);
+		hash = HashCombine(hash, colormap);
+		hash = HashCombine(hash, xform.xOffs);
+		hash = HashCombine(hash, xform.yOffs + xform.baseyOffs);
+		hash = HashCombine(hash, xform.xScale);
+		hash = HashCombine(hash, xform.yScale);
+		hash = HashCombine(hash, (xform.Angle + xform.baseAngle).Degrees);
+		hash = HashCombine(hash, (uint32_t)sky);
+		hash = HashCombine(hash, (uint32_t)portalUniq);
+		hash = HashCombine(hash, (uint32_t)mirrorFlags);
+		hash = HashCombine(hash, (uint32_t)skybox);
+		return hash;
+	}
+
+	bool VisiblePlaneList::SameKey(const VisiblePlane *a, const VisiblePlane *b)
+	{
+		return a->Hash == b->Hash &&
+			a->height == b->height &&
+			a->picnum == b->picnum &&
+			a->lightlevel == b->lightlevel &&
+			a->colormap == b->colormap &&
+			a->xform == b->xform &&
+			a->sky == b->sky &&
+			a->portal == b->portal &&
+			a->extralight == b->extralight &&
+			a->visibility == b->visibility &&
+			a->viewpos == b->viewpos &&
+			a->viewangle == b->viewangle &&
+			a->Alpha == b->Alpha &&
+			a->Additive == b->Additive &&
+			a->CurrentPortalUniq == b->CurrentPortalUniq &&
+			a->MirrorFlags == b->MirrorFlags &&
+			a->CurrentSkybox == b->CurrentSkybox &&
+			a->lights == b->lights;
+	}
+
 	void VisiblePlaneList::Clear()
 	{
 		for (int i = 0; i <= MAXVISPLANES; i++)
@@ -149,7 +215,8 @@ namespace swrenderer
 		}
 
 		// New visplane algorithm uses hash table -- killough
-		hash = isskybox ? ((unsigned)MAXVISPLANES) : CalcHash(picnum.GetIndex(), lightlevel, height);
+		unsigned fullhash = CalcHash(plane, picnum, lightlevel, basecolormap, *xform, sky, renderportal->CurrentPortalUniq, renderportal->MirrorFlags, Thread->Clip3D->CurrentSkybox);
+		hash = isskybox ? ((unsigned)MAXVISPLANES) : (fullhash & (MAXVISPLANES - 1));
 		
 		for (check = visplanes[hash]; check; check = check->next)	// killough
 		{
@@ -192,7 +259,8 @@ namespace swrenderer
 				}
 			}
 			else
-				if (plane == check->height &&
+				if (fullhash == check->Hash &&
+					plane == check->height &&
 					picnum == check->picnum &&
 					lightlevel == check->lightlevel &&
 					basecolormap == check->colormap &&	// [RH] Add more checks
@@ -226,10 +294,31 @@ namespace swrenderer
 		check->CurrentPortalUniq = renderportal->CurrentPortalUniq;
 		check->MirrorFlags = renderportal->MirrorFlags;
 		check->CurrentSkybox = Thread->Clip3D->CurrentSkybox;
+		check->Hash = fullhash;
 
 		return check;
 	}
 
+	// Looks for an earlier split of the same plane that does not use any of the columns
+	// in the range yet, so that a range does not always need a plane of its own.
+	VisiblePlane *VisiblePlaneList::FindMergeTarget(VisiblePlane *pl, int start, int stop)
+	{
+		int probes = 0;
+		for (VisiblePlane *check = visplanes[pl->Hash & (MAXVISPLANES - 1)]; check && probes < MaxMergeProbes; check = check->next)
+		{
+			if (check == pl || !SameKey(check, pl))
+				continue;
+			probes++;
+
+			int x = MAX(start, check->left);
+			int x2 = MIN(stop, check->right);
+			while (x < x2 && check->top[x] == 0x7fff) x++;
+			if (x >= x2)
+				return check;
+		}
+		return nullptr;
+	}
+
 	VisiblePlane *VisiblePlaneList::GetRange(VisiblePlane *pl, int start, int stop)
 	{
 		int intrl, intrh;
@@ -281,7 +370,14 @@ namespace swrenderer
 			}
 			else
 			{
-				hash = CalcHash(pl->picnum.GetIndex(), pl->lightlevel, pl->height);
+				VisiblePlane *merge_pl = FindMergeTarget(pl, start, stop);
+				if (merge_pl)
+				{
+					merge_pl->left = MIN(merge_pl->left, start);
+					merge_pl->right = MAX(merge_pl->right, stop);
+					return merge_pl;
+				}
+				hash = pl->Hash & (MAXVISPLANES - 1);
 			}
 			VisiblePlane *new_pl = Add(hash);
 
@@ -302,6 +398,7 @@ namespace swrenderer
 			new_pl->MirrorFlags = pl->MirrorFlags;
 			new_pl->CurrentSkybox = pl->CurrentSkybox;
 			new_pl->lights = pl->lights;
+			new_pl->Hash = pl->Hash;
 			pl = new_pl;
 			pl->left = start;
 			pl->right = stop;
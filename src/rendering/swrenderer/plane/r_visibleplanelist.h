@@ -55,10 +55,13 @@ namespace swrenderer
 	private:
 		VisiblePlaneList();
 		VisiblePlane *Add(unsigned hash);
+		VisiblePlane *FindMergeTarget(VisiblePlane *pl, int start, int stop);
 
-		enum { MAXVISPLANES = 128 }; // must be a power of 2
+		enum { MAXVISPLANES = 512 }; // must be a power of 2
+		enum { MaxMergeProbes = 16 };
 		VisiblePlane *visplanes[MAXVISPLANES + 1];
 
-		static unsigned CalcHash(int picnum, int lightlevel, const secplane_t &height) { return (unsigned)((picnum) * 3 + (lightlevel)+(FLOAT2FIXED((height).fD())) * 7) & (MAXVISPLANES - 1); }
+		static unsigned CalcHash(const secplane_t &height, FTextureID picnum, int lightlevel, FDynamicColormap *colormap, const FTransform &xform, int sky, int portalUniq, int mirrorFlags, int skybox);
+		static bool SameKey(const VisiblePlane *a, const VisiblePlane *b);
 	};
 }
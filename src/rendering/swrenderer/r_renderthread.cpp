@@ -47,6 +47,7 @@
 #include "swrenderer/plane/r_visibleplanelist.h"
 #include "swrenderer/segments/r_drawsegment.h"
 #include "swrenderer/segments/r_clipsegment.h"
+#include "swrenderer/segments/r_coveragebuffer.h"
 #include "r_thread.h"
 #include "swrenderer/drawers/r_draw.h"
 #include "swrenderer/drawers/r_draw_rgba.h"
@@ -73,7 +74,9 @@ namespace swrenderer
 		PlaneList.reset(new VisiblePlaneList(this));
 		DrawSegments.reset(new DrawSegmentList(this));
 		ClipSegments.reset(new RenderClipSegment());
-		tc_drawers.reset(new SWTruecolorDrawers(DrawQueue));
+		Coverage.reset(new CoverageBuffer(this));
+		tc_drawers.reset(CreateTruecolorDrawers(DrawQueue));
+		tc_generation = TruecolorDrawersGeneration;
 		pal_drawers.reset(new SWPalDrawers(DrawQueue));
 	}
 
@@ -81,6 +84,15 @@ namespace swrenderer
 	{
 	}
 	
+	void RenderThread::UpdateDrawers()
+	{
+		if (tc_generation != TruecolorDrawersGeneration)
+		{
+			tc_drawers.reset(CreateTruecolorDrawers(DrawQueue));
+			tc_generation = TruecolorDrawersGeneration;
+		}
+	}
+
 	SWPixelFormatDrawers *RenderThread::Drawers(RenderViewport *viewport)
 	{
 		if (viewport->RenderTarget->IsBgra())
@@ -46,6 +46,7 @@ namespace swrenderer
 	class VisiblePlaneList;
 	class DrawSegmentList;
 	class RenderClipSegment;
+	class CoverageBuffer;
 	class RenderViewport;
 	class LightVisibility;
 	class SWPixelFormatDrawers;
@@ -63,6 +64,9 @@ namespace swrenderer
 		int X2 = MAXWIDTH;
 		bool MainThread = false;
 
+		// Time spent rendering the last slice, in nanoseconds
+		uint64_t SliceTime = 0;
+
 		std::unique_ptr<RenderMemory> FrameMemory;
 		std::unique_ptr<RenderOpaquePass> OpaquePass;
 		std::unique_ptr<RenderTranslucentPass> TranslucentPass;
@@ -73,6 +77,7 @@ namespace swrenderer
 		std::unique_ptr<VisiblePlaneList> PlaneList;
 		std::unique_ptr<DrawSegmentList> DrawSegments;
 		std::unique_ptr<RenderClipSegment> ClipSegments;
+		std::unique_ptr<CoverageBuffer> Coverage;
 		std::unique_ptr<RenderViewport> Viewport;
 		std::unique_ptr<LightVisibility> Light;
 		DrawerCommandQueuePtr DrawQueue;
@@ -91,6 +96,9 @@ namespace swrenderer
 
 		SWPixelFormatDrawers *Drawers(RenderViewport *viewport);
 
+		// Re-create the truecolor drawers if r_truecolorsimd changed. Must not be called while the thread is rendering.
+		void UpdateDrawers();
+
 		// Make sure texture can accessed safely
 		void PrepareTexture(FSoftwareTexture *texture, FRenderStyle style);
 
@@ -99,6 +107,7 @@ namespace swrenderer
 		
 	private:
 		std::unique_ptr<SWTruecolorDrawers> tc_drawers;
+		int tc_generation = 0;
 		std::unique_ptr<SWPalDrawers> pal_drawers;
 	};
 }
@@ -38,6 +38,7 @@
 #include "swrenderer/scene/r_scene.h"
 #include "swrenderer/scene/r_light.h"
 #include "swrenderer/r_swcolormaps.h"
+#include "swrenderer/textures/r_swtexturecache.h"
 #include "v_palette.h"
 #include "v_video.h"
 #include "m_png.h"
@@ -186,6 +187,9 @@ void FSoftwareRenderer::Precache(uint8_t *texhitlist, TMap<PClassActor*, bool> &
 
 void FSoftwareRenderer::RenderView(player_t *player, DCanvas *target, void *videobuffer, int bufferpitch)
 {
+	// The previous frame, including its camera textures, has waited for its drawers
+	FSoftwareTextureCache::Instance()->BeginFrame();
+
 	mScene.MainThread()->Viewport->viewpoint = r_viewpoint;
 	mScene.MainThread()->Viewport->viewwindow = r_viewwindow;
 	mScene.RenderView(player, target, videobuffer, bufferpitch);
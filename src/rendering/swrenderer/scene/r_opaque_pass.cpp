@@ -48,6 +48,7 @@
 #include "swrenderer/things/r_particle.h"
 #include "swrenderer/things/r_model.h"
 #include "swrenderer/segments/r_clipsegment.h"
+#include "swrenderer/segments/r_coveragebuffer.h"
 #include "swrenderer/line/r_wallsetup.h"
 #include "swrenderer/line/r_farclip_line.h"
 #include "swrenderer/scene/r_scene.h"
@@ -834,6 +835,8 @@ namespace swrenderer
 		SeenSpriteSectors.clear();
 		SeenActors.clear();
 
+		Thread->Coverage->Clear();
+
 		InSubsector = nullptr;
 		RenderBSPNode(Level->HeadNode());	// The head node is the last node output.
 
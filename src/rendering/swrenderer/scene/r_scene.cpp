@@ -57,6 +57,7 @@
 #include "r_memory.h"
 #include "swrenderer/r_renderthread.h"
 #include "swrenderer/things/r_playersprite.h"
+#include "i_time.h"
 #include <chrono>
 
 #ifdef WIN32
@@ -67,6 +68,7 @@ EXTERN_CVAR(Int, r_clearbuffer)
 EXTERN_CVAR(Int, r_debug_draw)
 
 CVAR(Int, r_scene_multithreaded, 0, 0);
+CVAR(Bool, r_scene_balance, true, 0);
 CVAR(Bool, r_models, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
 bool r_modelscene = false;
@@ -74,6 +76,14 @@ bool r_modelscene = false;
 namespace swrenderer
 {
 	cycle_t WallCycles, PlaneCycles, MaskedCycles, DrawerWaitCycles;
+
+	struct SceneSliceStats
+	{
+		int X1, X2;
+		uint64_t Busy;
+	};
+	static std::vector<SceneSliceStats> SliceStats;
+	static uint64_t SliceStatsTotal;
 	
 	RenderScene::RenderScene()
 	{
@@ -221,18 +231,26 @@ namespace swrenderer
 			StartThreads(numThreads);
 		}
 
+		// Camera textures get equal slices so they do not disturb the balance of the main view
+		bool balance = !MainThread()->Viewport->RenderingToCanvas;
+		if (balance)
+			UpdateSliceEdges(numThreads);
+
 		// Setup threads:
 		std::unique_lock<std::mutex> start_lock(start_mutex);
 		for (int i = 0; i < numThreads; i++)
 		{
 			*Threads[i]->Viewport = *MainThread()->Viewport;
 			*Threads[i]->Light = *MainThread()->Light;
-			Threads[i]->X1 = viewwidth * i / numThreads;
-			Threads[i]->X2 = viewwidth * (i + 1) / numThreads;
+			Threads[i]->UpdateDrawers();
+			Threads[i]->X1 = balance ? SliceEdges[i] : viewwidth * i / numThreads;
+			Threads[i]->X2 = balance ? SliceEdges[i + 1] : viewwidth * (i + 1) / numThreads;
 		}
 		run_id++;
 		start_lock.unlock();
 
+		uint64_t startTime = I_nsTime();
+
 		// Notify threads to run
 		if (Threads.size() > 1)
 		{
@@ -260,13 +278,79 @@ namespace swrenderer
 			finished_threads = 0;
 		}
 
+		if (balance)
+		{
+			SliceTimes.resize(numThreads);
+			SliceStats.resize(numThreads);
+			for (int i = 0; i < numThreads; i++)
+			{
+				SliceTimes[i] = Threads[i]->SliceTime;
+				SliceStats[i] = { Threads[i]->X1, Threads[i]->X2, Threads[i]->SliceTime };
+			}
+			SliceStatsTotal = I_nsTime() - startTime;
+		}
+
 		// Change main thread back to covering the whole screen for player sprites
 		MainThread()->X1 = 0;
 		MainThread()->X2 = viewwidth;
 	}
 
+	// Moves the slice edges so that each thread gets about the same amount of work.
+	// The time a slice took in the previous frame is assumed to be spread evenly over
+	// its columns, which gives a cost per column that the new edges split into equal
+	// parts. The edges only move halfway there each frame to keep them from jittering.
+	void RenderScene::UpdateSliceEdges(int numThreads)
+	{
+		if (!r_scene_balance || numThreads == 1 || SliceEdges.size() != (size_t)numThreads + 1 || SliceTimes.size() != (size_t)numThreads || SliceEdges.back() != viewwidth)
+		{
+			SliceEdges.resize(numThreads + 1);
+			for (int i = 0; i <= numThreads; i++)
+				SliceEdges[i] = viewwidth * i / numThreads;
+			SliceTimes.assign(numThreads, 0);
+			return;
+		}
+
+		double totalTime = 0.0;
+		for (uint64_t time : SliceTimes)
+			totalTime += (double)time;
+		if (totalTime <= 0.0)
+			return;
+
+		// A small cost for every column stops cheap slices from growing without bound
+		double columnCost = totalTime / viewwidth * 0.05;
+		double totalCost = totalTime + columnCost * viewwidth;
+		int minWidth = MAX(viewwidth / (numThreads * 8), 1);
+
+		std::vector<int> edges(SliceEdges);
+		int slice = 0;
+		double sliceStartCost = 0.0;
+		for (int i = 1; i < numThreads; i++)
+		{
+			double target = totalCost * i / numThreads;
+			double x = 0.0;
+			while (slice < numThreads)
+			{
+				int width = SliceEdges[slice + 1] - SliceEdges[slice];
+				double sliceCost = SliceTimes[slice] + columnCost * width;
+				if (sliceStartCost + sliceCost >= target || slice + 1 == numThreads)
+				{
+					x = SliceEdges[slice] + (sliceCost > 0.0 ? (target - sliceStartCost) / sliceCost * width : 0.0);
+					break;
+				}
+				sliceStartCost += sliceCost;
+				slice++;
+			}
+
+			int edge = (SliceEdges[i] + xs_RoundToInt(x) + 1) / 2;
+			edges[i] = clamp(edge, edges[i - 1] + minWidth, viewwidth - minWidth * (numThreads - i));
+		}
+		SliceEdges = std::move(edges);
+	}
+
 	void RenderScene::RenderThreadSlice(RenderThread *thread)
 	{
+		uint64_t startTime = I_nsTime();
+
 		thread->DrawQueue->Clear();
 		thread->FrameMemory->Clear();
 		thread->Clip3D->Cleanup();
@@ -307,6 +391,8 @@ namespace swrenderer
 		}
 
 		DrawerThreads::Execute(thread->DrawQueue);
+
+		thread->SliceTime = I_nsTime() - startTime;
 	}
 
 	void RenderScene::StartThreads(size_t numThreads)
@@ -441,6 +527,19 @@ namespace swrenderer
 		return out;
 	}
 
+	ADD_STAT(scenethreads)
+	{
+		FString out;
+		out.Format("%d scene threads, slices took %04.1f ms", (int)SliceStats.size(), SliceStatsTotal / 1e6);
+		for (size_t i = 0; i < SliceStats.size(); i++)
+		{
+			const auto &stats = SliceStats[i];
+			out.AppendFormat("\nthread %d: columns %d-%d  busy=%04.1f ms  idle=%04.1f ms", (int)i, stats.X1, stats.X2 - 1,
+				stats.Busy / 1e6, (SliceStatsTotal - MIN(stats.Busy, SliceStatsTotal)) / 1e6);
+		}
+		return out;
+	}
+
 	static double bestwallcycles = HUGE_VAL;
 
 	ADD_STAT(wallcycles)
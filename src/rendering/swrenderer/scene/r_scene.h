@@ -61,6 +61,7 @@ namespace swrenderer
 		void RenderActorView(AActor *actor,bool renderplayersprite, bool dontmaplines);
 		void RenderThreadSlices();
 		void RenderThreadSlice(RenderThread *thread);
+		void UpdateSliceEdges(int numThreads);
 		void RenderPSprites();
 
 		void StartThreads(size_t numThreads);
@@ -71,6 +72,8 @@ namespace swrenderer
 
 		std::unique_ptr<PolyDepthStencil> DepthStencil;
 		std::vector<std::unique_ptr<RenderThread>> Threads;
+		std::vector<int> SliceEdges;
+		std::vector<uint64_t> SliceTimes;
 		std::mutex start_mutex;
 		std::condition_variable start_condition;
 		bool shutdown_flag = false;
@@ -0,0 +1,223 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright 2026 GZDoom contributors
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <float.h>
+#include "templates.h"
+#include "doomdef.h"
+#include "r_defs.h"
+#include "r_state.h"
+#include "c_cvars.h"
+#include "swrenderer/segments/r_drawsegment.h"
+#include "swrenderer/segments/r_coveragebuffer.h"
+#include "swrenderer/r_renderthread.h"
+
+CVAR(Bool, r_coveragecull, true, 0)
+
+namespace swrenderer
+{
+	CoverageBuffer::CoverageBuffer(RenderThread *thread)
+	{
+		Thread = thread;
+	}
+
+	void CoverageBuffer::Clear()
+	{
+		Enabled = r_coveragecull;
+		if (!Enabled)
+			return;
+
+		Width = viewwidth;
+		Height = viewheight;
+		TilesX = (Width + (1 << TileShift) - 1) >> TileShift;
+		TilesY = (Height + (1 << TileShift) - 1) >> TileShift;
+		BlocksX = (TilesX + BlockTiles - 1) >> BlockShift;
+		BlocksY = (TilesY + BlockTiles - 1) >> BlockShift;
+
+		ColumnTop.Resize(Width);
+		ColumnBottom.Resize(Width);
+		ColumnDepth.Resize(Width);
+		for (int x = 0; x < Width; x++)
+		{
+			ColumnTop[x] = 0;
+			ColumnBottom[x] = Height;
+			ColumnDepth[x] = 0.0f;
+		}
+
+		TileDepth.Resize(TilesX * TilesY);
+		for (unsigned int i = 0; i < TileDepth.Size(); i++)
+			TileDepth[i] = FLT_MAX;
+
+		BlockDepth.Resize(BlocksX * BlocksY);
+		for (unsigned int i = 0; i < BlockDepth.Size(); i++)
+			BlockDepth[i] = FLT_MAX;
+	}
+
+	void CoverageBuffer::AddSegment(const DrawSegment *ds)
+	{
+		if (!Enabled)
+			return;
+
+		// Segments with translucent parts can have their top clip restored to the
+		// lower value from before the segment was drawn (see SetRangeUndrawn).
+		const DrawSegmentClipInfo &clip = ds->drawsegclip;
+		bool top = (clip.silhouette & SIL_TOP) && clip.sprtopclip && !ds->HasFogBoundary() && !ds->HasTranslucentMidTexture() && !ds->Has3DFloorWalls();
+		bool bottom = (clip.silhouette & SIL_BOTTOM) && clip.sprbottomclip;
+		if (!top && !bottom)
+			return;
+
+		int x1 = MAX<int>(ds->x1, 0);
+		int x2 = MIN<int>(ds->x2, Width);
+		float depth = MAX(ds->WallC.sz1, ds->WallC.sz2);
+
+		bool changed = false;
+		for (int x = x1; x < x2; x++)
+		{
+			bool covered = false;
+			if (top && clip.sprtopclip[x] > ColumnTop[x])
+			{
+				ColumnTop[x] = clip.sprtopclip[x];
+				covered = true;
+			}
+			if (bottom && clip.sprbottomclip[x] < ColumnBottom[x])
+			{
+				ColumnBottom[x] = clip.sprbottomclip[x];
+				covered = true;
+			}
+			if (covered)
+			{
+				ColumnDepth[x] = MAX(ColumnDepth[x], depth);
+				changed = true;
+			}
+		}
+
+		if (changed)
+			UpdateTiles(x1, x2);
+	}
+
+	void CoverageBuffer::UpdateTiles(int x1, int x2)
+	{
+		int tx1 = x1 >> TileShift;
+		int tx2 = ((x2 - 1) >> TileShift) + 1;
+		for (int tx = tx1; tx < tx2; tx++)
+		{
+			int cx1 = tx << TileShift;
+			int cx2 = MIN(cx1 + (1 << TileShift), Width);
+
+			// Find the rows covered in all columns of the tile. A closed column covers every row.
+			int top = Height;
+			int bottom = 0;
+			float depth = 0.0f;
+			for (int x = cx1; x < cx2; x++)
+			{
+				if (ColumnTop[x] < ColumnBottom[x])
+				{
+					top = MIN<int>(top, ColumnTop[x]);
+					bottom = MAX<int>(bottom, ColumnBottom[x]);
+				}
+				depth = MAX(depth, ColumnDepth[x]);
+			}
+
+			int coveredTop = (top >= Height) ? TilesY : (top >> TileShift);
+			int coveredBottom = MAX(coveredTop, (bottom + (1 << TileShift) - 1) >> TileShift);
+			for (int ty = 0; ty < coveredTop; ty++)
+			{
+				float &tile = TileDepth[ty * TilesX + tx];
+				tile = MIN(tile, depth);
+			}
+			for (int ty = coveredBottom; ty < TilesY; ty++)
+			{
+				float &tile = TileDepth[ty * TilesX + tx];
+				tile = MIN(tile, depth);
+			}
+		}
+
+		UpdateBlocks(tx1, tx2);
+	}
+
+	void CoverageBuffer::UpdateBlocks(int tx1, int tx2)
+	{
+		int bx1 = tx1 >> BlockShift;
+		int bx2 = ((tx2 - 1) >> BlockShift) + 1;
+		for (int by = 0; by < BlocksY; by++)
+		{
+			int ty1 = by << BlockShift;
+			int ty2 = MIN(ty1 + BlockTiles, TilesY);
+			for (int bx = bx1; bx < bx2; bx++)
+			{
+				int btx1 = bx << BlockShift;
+				int btx2 = MIN(btx1 + BlockTiles, TilesX);
+				float depth = 0.0f;
+				for (int ty = ty1; ty < ty2; ty++)
+				{
+					for (int tx = btx1; tx < btx2; tx++)
+						depth = MAX(depth, TileDepth[ty * TilesX + tx]);
+				}
+				BlockDepth[by * BlocksX + bx] = depth;
+			}
+		}
+	}
+
+	bool CoverageBuffer::IsOccluded(int x1, int x2, int y1, int y2, float depth) const
+	{
+		if (!Enabled)
+			return false;
+
+		x1 = MAX(x1, 0);
+		x2 = MIN(x2, Width);
+		y1 = MAX(y1, 0);
+		y2 = MIN(y2, Height);
+		if (x1 >= x2 || y1 >= y2)
+			return false;
+
+		int tx1 = x1 >> TileShift;
+		int tx2 = ((x2 - 1) >> TileShift) + 1;
+		int ty1 = y1 >> TileShift;
+		int ty2 = ((y2 - 1) >> TileShift) + 1;
+
+		int bx1 = tx1 >> BlockShift;
+		int bx2 = ((tx2 - 1) >> BlockShift) + 1;
+		int by1 = ty1 >> BlockShift;
+		int by2 = ((ty2 - 1) >> BlockShift) + 1;
+
+		for (int by = by1; by < by2; by++)
+		{
+			for (int bx = bx1; bx < bx2; bx++)
+			{
+				// Every tile in the block is covered by something nearer
+				if (BlockDepth[by * BlocksX + bx] < depth)
+					continue;
+
+				int btx1 = MAX(tx1, bx << BlockShift);
+				int btx2 = MIN(tx2, (bx + 1) << BlockShift);
+				int bty1 = MAX(ty1, by << BlockShift);
+				int bty2 = MIN(ty2, (by + 1) << BlockShift);
+				for (int ty = bty1; ty < bty2; ty++)
+				{
+					for (int tx = btx1; tx < btx2; tx++)
+					{
+						if (TileDepth[ty * TilesX + tx] >= depth)
+							return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright 2026 GZDoom contributors
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "tarray.h"
+
+namespace swrenderer
+{
+	class RenderThread;
+	struct DrawSegment;
+
+	// Low resolution map of the screen areas that draw segments will clip sprites against.
+	// Each tile stores a depth that every covering wall is in front of, so anything that
+	// lies entirely behind that depth in all the tiles it touches is known to be clipped
+	// away when it gets drawn and does not need to be projected at all.
+	class CoverageBuffer
+	{
+	public:
+		CoverageBuffer(RenderThread *thread);
+
+		void Clear();
+		void AddSegment(const DrawSegment *ds);
+		bool IsOccluded(int x1, int x2, int y1, int y2, float depth) const;
+
+	private:
+		enum
+		{
+			TileShift = 3,				// Tiles are 8x8 pixels
+			BlockShift = 3,				// Blocks are 8x8 tiles
+			BlockTiles = 1 << BlockShift
+		};
+
+		void UpdateTiles(int x1, int x2);
+		void UpdateBlocks(int tx1, int tx2);
+
+		RenderThread *Thread = nullptr;
+		bool Enabled = false;
+		int Width = 0;
+		int Height = 0;
+		int TilesX = 0;
+		int TilesY = 0;
+		int BlocksX = 0;
+		int BlocksY = 0;
+
+		// Sprites are clipped above ColumnTop and at or below ColumnBottom, by segments no further away than ColumnDepth
+		TArray<short> ColumnTop;
+		TArray<short> ColumnBottom;
+		TArray<float> ColumnDepth;
+
+		// Depth that all segments covering the whole tile are in front of, or FLT_MAX if it is not covered
+		TArray<float> TileDepth;
+
+		// Largest tile depth in each block
+		TArray<float> BlockDepth;
+	};
+}
@@ -35,6 +35,7 @@
 */
 
 #include "r_swtexture.h"
+#include "r_swtexturecache.h"
 #include "bitmap.h"
 #include "m_alloc.h"
 #include "imagehelpers.h"
@@ -80,6 +81,35 @@ FSoftwareTexture::FSoftwareTexture(FGameTexture *tex)
 	CalcBitSize();
 }
 
+FSoftwareTexture::~FSoftwareTexture()
+{
+	FSoftwareTextureCache::Instance()->Remove(this);
+	FreeAllSpans();
+}
+
+//==========================================================================
+//
+// Camera textures are render targets and are never unloaded by the cache
+//
+//==========================================================================
+
+void FSoftwareTexture::MarkUsed(bool loaded)
+{
+	auto cache = FSoftwareTextureCache::Instance();
+	if (LastUseFrame.load(std::memory_order_relaxed) != cache->GetFrame())
+		cache->MarkUsed(this, loaded);
+}
+
+void FSoftwareTexture::UpdateCacheSize()
+{
+	if (mTexture->isSoftwareCanvas())
+		return;
+
+	size_t bytes = Pixels.Size() + PixelsBgra.Size() * sizeof(uint32_t) + SpanBytes[0] + SpanBytes[1] + SpanBytes[2] + ExtraCacheBytes();
+	if (bytes != CacheBytes)
+		FSoftwareTextureCache::Instance()->UpdateSize(this, bytes);
+}
+
 //==========================================================================
 //
 //
@@ -121,6 +151,7 @@ void FSoftwareTexture::CalcBitSize ()
 
 const uint8_t *FSoftwareTexture::GetPixels(int style)
 {
+	MarkUsed(Pixels.Size() != 0);
 	if (Pixels.Size() == 0 || CheckModified(style))
 	{
 		if (mPhysicalScale == 1)
@@ -154,6 +185,7 @@ const uint8_t *FSoftwareTexture::GetPixels(int style)
 				}
 			}
 		}
+		UpdateCacheSize();
 	}
 	return Pixels.Data();
 }
@@ -166,6 +198,7 @@ const uint8_t *FSoftwareTexture::GetPixels(int style)
 
 const uint32_t *FSoftwareTexture::GetPixelsBgra()
 {
+	MarkUsed(PixelsBgra.Size() != 0);
 	if (PixelsBgra.Size() == 0 || CheckModified(2))
 	{
 		if (mPhysicalScale == 1)
@@ -187,6 +220,7 @@ const uint32_t *FSoftwareTexture::GetPixelsBgra()
 			}
 			GenerateBgraMipmaps();
 		}
+		UpdateCacheSize();
 	}
 	return PixelsBgra.Data();
 }
@@ -215,7 +249,8 @@ const uint8_t *FSoftwareTexture::GetColumn(int index, unsigned int column, const
 	{
 		if (Spandata[index] == nullptr)
 		{
-			Spandata[index] = CreateSpans(Pixeldata);
+			Spandata[index] = CreateSpans(Pixeldata, SpanBytes[index]);
+			UpdateCacheSize();
 		}
 		*spans_out = Spandata[index][column];
 	}
@@ -246,7 +281,8 @@ const uint32_t *FSoftwareTexture::GetColumnBgra(unsigned int column, const FSoft
 	{
 		if (Spandata[2] == nullptr)
 		{
-			Spandata[2] = CreateSpans(Pixeldata);
+			Spandata[2] = CreateSpans(Pixeldata, SpanBytes[2]);
+			UpdateCacheSize();
 		}
 		*spans_out = Spandata[2][column];
 	}
@@ -270,13 +306,14 @@ static bool isTranslucent(uint32_t val)
 }
 
 template<class T>
-FSoftwareTextureSpan **FSoftwareTexture::CreateSpans (const T *pixels)
+FSoftwareTextureSpan **FSoftwareTexture::CreateSpans (const T *pixels, size_t &bytes)
 {
 	FSoftwareTextureSpan **spans, *span;
 
 	if (!mTexture->isMasked())
 	{ // Texture does not have holes, so it can use a simpler span structure
-		spans = (FSoftwareTextureSpan **)M_Malloc (sizeof(FSoftwareTextureSpan*)*GetPhysicalWidth() + sizeof(FSoftwareTextureSpan)*2);
+		bytes = sizeof(FSoftwareTextureSpan*)*GetPhysicalWidth() + sizeof(FSoftwareTextureSpan)*2;
+		spans = (FSoftwareTextureSpan **)M_Malloc (bytes);
 		span = (FSoftwareTextureSpan *)&spans[GetPhysicalWidth()];
 		for (int x = 0; x < GetPhysicalWidth(); ++x)
 		{
@@ -321,7 +358,8 @@ FSoftwareTextureSpan **FSoftwareTexture::CreateSpans (const T *pixels)
 		}
 
 		// Allocate space for the spans
-		spans = (FSoftwareTextureSpan **)M_Malloc (sizeof(FSoftwareTextureSpan*)*numcols + sizeof(FSoftwareTextureSpan)*numspans);
+		bytes = sizeof(FSoftwareTextureSpan*)*numcols + sizeof(FSoftwareTextureSpan)*numspans;
+		spans = (FSoftwareTextureSpan **)M_Malloc (bytes);
 
 		// Fill in the spans
 		for (x = 0, span = (FSoftwareTextureSpan *)&spans[numcols], data_p = pixels; x < numcols; ++x)
@@ -424,6 +462,16 @@ int FSoftwareTexture::MipmapLevels()
 //==========================================================================
 
 void FSoftwareTexture::GenerateBgraMipmaps()
+{
+	// Animated textures are regenerated before a worker thread could finish
+	MipmapGeneration++;
+	if (!CheckModified(2) && FSoftwareTextureCache::Instance()->QueueMipmaps(this))
+		GenerateBgraMipmapsFast();
+	else
+		GenerateBgraMipmaps(PixelsBgra.Data(), GetPhysicalWidth(), GetPhysicalHeight(), MipmapLevels());
+}
+
+void FSoftwareTexture::GenerateBgraMipmaps(uint32_t *pixels, int width, int height, int levels)
 {
 	struct Color4f
 	{
@@ -438,37 +486,39 @@ void FSoftwareTexture::GenerateBgraMipmaps()
 		Color4f operator-(float s) const { return Color4f{ a - s, r - s, g - s, b - s }; }
 	};
 
-	int levels = MipmapLevels();
-	std::vector<Color4f> image(PixelsBgra.Size());
+	size_t size = 0;
+	for (int i = 0; i < levels; i++)
+		size += MAX(width >> i, 1) * MAX(height >> i, 1);
+	std::vector<Color4f> image(size);
 
 	// Convert to normalized linear colorspace
 	{
-		for (int x = 0; x < GetPhysicalWidth(); x++)
+		for (int x = 0; x < width; x++)
 		{
-			for (int y = 0; y < GetPhysicalHeight(); y++)
+			for (int y = 0; y < height; y++)
 			{
-				uint32_t c8 = PixelsBgra[x * GetPhysicalHeight() + y];
+				uint32_t c8 = pixels[x * height + y];
 				Color4f c;
 				c.a = powf(APART(c8) * (1.0f / 255.0f), 2.2f);
 				c.r = powf(RPART(c8) * (1.0f / 255.0f), 2.2f);
 				c.g = powf(GPART(c8) * (1.0f / 255.0f), 2.2f);
 				c.b = powf(BPART(c8) * (1.0f / 255.0f), 2.2f);
-				image[x * GetPhysicalHeight() + y] = c;
+				image[x * height + y] = c;
 			}
 		}
 	}
 
 	// Generate mipmaps
 	{
-		std::vector<Color4f> smoothed(GetPhysicalWidth() * GetPhysicalHeight());
+		std::vector<Color4f> smoothed(width * height);
 		Color4f *src = image.data();
-		Color4f *dest = src + GetPhysicalWidth() * GetPhysicalHeight();
+		Color4f *dest = src + width * height;
 		for (int i = 1; i < levels; i++)
 		{
-			int srcw = MAX(GetPhysicalWidth() >> (i - 1), 1);
-			int srch = MAX(GetPhysicalHeight() >> (i - 1), 1);
-			int w = MAX(GetPhysicalWidth() >> i, 1);
-			int h = MAX(GetPhysicalHeight() >> i, 1);
+			int srcw = MAX(width >> (i - 1), 1);
+			int srch = MAX(height >> (i - 1), 1);
+			int w = MAX(width >> i, 1);
+			int h = MAX(height >> i, 1);
 
 			// Downscale
 			for (int x = 0; x < w; x++)
@@ -524,12 +574,12 @@ void FSoftwareTexture::GenerateBgraMipmaps()
 
 	// Convert to bgra8 sRGB colorspace
 	{
-		Color4f *src = image.data() + GetPhysicalWidth() * GetPhysicalHeight();
-		uint32_t *dest = PixelsBgra.Data() + GetPhysicalWidth() * GetPhysicalHeight();
+		Color4f *src = image.data() + width * height;
+		uint32_t *dest = pixels + width * height;
 		for (int i = 1; i < levels; i++)
 		{
-			int w = MAX(GetPhysicalWidth() >> i, 1);
-			int h = MAX(GetPhysicalHeight() >> i, 1);
+			int w = MAX(width >> i, 1);
+			int h = MAX(height >> i, 1);
 			for (int j = 0; j < w * h; j++)
 			{
 				uint32_t a = (uint32_t)clamp(powf(MAX(src[j].a, 0.0f), 1.0f / 2.2f) * 255.0f + 0.5f, 0.0f, 255.0f);
@@ -605,6 +655,7 @@ void FSoftwareTexture::FreeAllSpans()
 		{
 			FreeSpans (Spandata[i]);
 			Spandata[i] = nullptr;
+			SpanBytes[i] = 0;
 		}
 	}
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include "textures.h"
 #include "v_video.h"
 #include "g_levellocals.h"
@@ -28,18 +29,28 @@ protected:
 	int mPhysicalScale;
 	int mBufferFlags;
 
+	// Bookkeeping for FSoftwareTextureCache
+	size_t SpanBytes[3] = { };
+	size_t CacheBytes = 0;
+	int CacheIndex = -1;
+	int MipmapGeneration = 0;
+	std::atomic<int> LastUseFrame = { -1 };
+
 	void FreeAllSpans();
-	template<class T> FSoftwareTextureSpan **CreateSpans(const T *pixels);
+	template<class T> FSoftwareTextureSpan **CreateSpans(const T *pixels, size_t &bytes);
 	void FreeSpans(FSoftwareTextureSpan **spans);
 	void CalcBitSize();
+	void MarkUsed(bool loaded);
+	void UpdateCacheSize();
+
+	// Memory a derived texture holds besides Pixels, PixelsBgra and the spans
+	virtual size_t ExtraCacheBytes() const { return 0; }
+
+	friend class FSoftwareTextureCache;
 
 public:
 	FSoftwareTexture(FGameTexture *tex);
-	
-	virtual ~FSoftwareTexture()
-	{
-		FreeAllSpans();
-	}
+	virtual ~FSoftwareTexture();
 
 	FGameTexture *GetTexture() const
 	{
@@ -94,6 +105,8 @@ public:
 	{
 		Pixels.Reset();
 		PixelsBgra.Reset();
+		MipmapGeneration++;
+		UpdateCacheSize();
 	}
 	
 	// Returns true if the next call to GetPixels() will return an image different from the
@@ -105,6 +118,7 @@ public:
 	void CreatePixelsBgraWithMipmaps();
 	void GenerateBgraMipmaps();
 	void GenerateBgraMipmapsFast();
+	static void GenerateBgraMipmaps(uint32_t *pixels, int width, int height, int levels);
 	int MipmapLevels();
 	
 	// Returns true if GetPixelsBgra includes mipmaps
@@ -164,6 +178,12 @@ private:
 
 	int NextPo2 (int v); // [mxd]
 	void SetupMultipliers (int width, int height); // [mxd]
+
+protected:
+	size_t ExtraCacheBytes() const override;
+
+public:
+	void Unload() override;
 };
 
 class FSWCanvasTexture : public FSoftwareTexture
@@ -0,0 +1,331 @@
+/*
+** r_swtexturecache.cpp
+** Memory budget and background mipmap generation for software renderer textures
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 GZDoom contributors
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Texture data is only unloaded and mipmaps are only replaced in BeginFrame,
+** because the drawer commands of a frame point directly into the pixels.
+**
+*/
+
+#include <algorithm>
+#include "templates.h"
+#include "c_cvars.h"
+#include "stats.h"
+#include "r_swtexture.h"
+#include "r_swtexturecache.h"
+
+// Memory budget for software renderer textures in megabytes, 0 for no limit
+CVAR(Int, r_texcachesize, 1024, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+// Generate the filtered BGRA mipmaps on worker threads
+CVAR(Bool, r_texasyncmipmaps, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+FSoftwareTextureCache *FSoftwareTextureCache::Instance()
+{
+	static FSoftwareTextureCache cache;
+	return &cache;
+}
+
+FSoftwareTextureCache::~FSoftwareTextureCache()
+{
+	StopThreads();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FSoftwareTextureCache::BeginFrame()
+{
+	ApplyMipmaps();
+	EvictTextures();
+
+	LastHits = Hits.exchange(0);
+	LastMisses = Misses.exchange(0);
+	Frame++;
+}
+
+//==========================================================================
+//
+// Counts the first use of a texture in each frame
+//
+//==========================================================================
+
+void FSoftwareTextureCache::MarkUsed(FSoftwareTexture *texture, bool loaded)
+{
+	if (texture->LastUseFrame.exchange(Frame, std::memory_order_relaxed) != Frame)
+	{
+		if (loaded)
+			Hits++;
+		else
+			Misses++;
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FSoftwareTextureCache::UpdateSize(FSoftwareTexture *texture, size_t bytes)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	ResidentBytes = ResidentBytes - texture->CacheBytes + bytes;
+	texture->CacheBytes = bytes;
+
+	if (bytes != 0 && texture->CacheIndex == -1)
+	{
+		texture->CacheIndex = Resident.Push(texture);
+	}
+	else if (bytes == 0 && texture->CacheIndex != -1)
+	{
+		RemoveResident(texture);
+	}
+}
+
+void FSoftwareTextureCache::RemoveResident(FSoftwareTexture *texture)
+{
+	unsigned int index = texture->CacheIndex;
+	FSoftwareTexture *last = Resident.Last();
+	Resident[index] = last;
+	last->CacheIndex = index;
+	Resident.Pop();
+	texture->CacheIndex = -1;
+}
+
+void FSoftwareTextureCache::Remove(FSoftwareTexture *texture)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (texture->CacheIndex != -1)
+	{
+		ResidentBytes -= texture->CacheBytes;
+		texture->CacheBytes = 0;
+		RemoveResident(texture);
+	}
+
+	for (auto &job : QueuedJobs)
+	{
+		if (job->Texture == texture)
+			job->Texture = nullptr;
+	}
+	for (auto job : RunningJobs)
+	{
+		if (job->Texture == texture)
+			job->Texture = nullptr;
+	}
+	for (auto &job : FinishedJobs)
+	{
+		if (job->Texture == texture)
+			job->Texture = nullptr;
+	}
+}
+
+//==========================================================================
+//
+// Unloads the least recently used textures until the total is within the
+// budget. Textures used in the last frame are kept even if that is not
+// enough, as they are likely to be needed again right away.
+//
+//==========================================================================
+
+void FSoftwareTextureCache::EvictTextures()
+{
+	size_t budget = (size_t)MAX(*r_texcachesize, 0) << 20;
+
+	TArray<FSoftwareTexture *> candidates;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (budget == 0 || ResidentBytes <= budget)
+			return;
+
+		for (auto texture : Resident)
+		{
+			if (texture->LastUseFrame.load(std::memory_order_relaxed) < Frame)
+				candidates.Push(texture);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](FSoftwareTexture *a, FSoftwareTexture *b)
+	{
+		return a->LastUseFrame.load(std::memory_order_relaxed) < b->LastUseFrame.load(std::memory_order_relaxed);
+	});
+
+	for (auto texture : candidates)
+	{
+		texture->Unload();
+		texture->FreeAllSpans();
+		texture->UpdateCacheSize();
+		Evictions++;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		if (ResidentBytes <= budget)
+			break;
+	}
+}
+
+//==========================================================================
+//
+// Copies the finished mipmaps into the textures they were made for, unless
+// the texture has been reloaded or unloaded since the job was queued.
+//
+//==========================================================================
+
+void FSoftwareTextureCache::ApplyMipmaps()
+{
+	std::vector<std::unique_ptr<MipmapJob>> finished;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.swap(FinishedJobs);
+	}
+
+	for (auto &job : finished)
+	{
+		FSoftwareTexture *texture = job->Texture;
+		if (texture && texture->MipmapGeneration == job->Generation && texture->PixelsBgra.Size() == job->Pixels.Size())
+		{
+			size_t first = texture->GetPhysicalWidth() * texture->GetPhysicalHeight();
+			memcpy(texture->PixelsBgra.Data() + first, job->Pixels.Data() + first, (job->Pixels.Size() - first) * sizeof(uint32_t));
+		}
+	}
+}
+
+//==========================================================================
+//
+// Queues a texture that currently has box filtered mipmaps for the full
+// quality filter. Returns false if the texture should do it itself.
+//
+//==========================================================================
+
+bool FSoftwareTextureCache::QueueMipmaps(FSoftwareTexture *texture)
+{
+	if (!r_texasyncmipmaps)
+		return false;
+
+	StartThreads();
+
+	std::unique_ptr<MipmapJob> job(new MipmapJob());
+	job->Texture = texture;
+	job->Generation = texture->MipmapGeneration;
+	job->Width = texture->GetPhysicalWidth();
+	job->Height = texture->GetPhysicalHeight();
+	job->Levels = texture->MipmapLevels();
+	job->Pixels = texture->PixelsBgra;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	QueuedJobs.push_back(std::move(job));
+	lock.unlock();
+	condition.notify_one();
+	return true;
+}
+
+void FSoftwareTextureCache::WorkerMain()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		condition.wait(lock, [&]() { return !QueuedJobs.empty() || shutdown_flag; });
+		if (shutdown_flag)
+			break;
+
+		std::unique_ptr<MipmapJob> job = std::move(QueuedJobs.front());
+		QueuedJobs.erase(QueuedJobs.begin());
+		if (job->Texture == nullptr)
+			continue;
+
+		RunningJobs.push_back(job.get());
+		lock.unlock();
+
+		FSoftwareTexture::GenerateBgraMipmaps(job->Pixels.Data(), job->Width, job->Height, job->Levels);
+
+		lock.lock();
+		RunningJobs.erase(std::find(RunningJobs.begin(), RunningJobs.end(), job.get()));
+		if (job->Texture != nullptr)
+			FinishedJobs.push_back(std::move(job));
+	}
+}
+
+void FSoftwareTextureCache::StartThreads()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (!threads.empty())
+		return;
+
+	int count = clamp<int>(std::thread::hardware_concurrency() / 4, 1, 4);
+	for (int i = 0; i < count; i++)
+	{
+		threads.push_back(std::thread([this]() { WorkerMain(); }));
+	}
+}
+
+void FSoftwareTextureCache::StopThreads()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	shutdown_flag = true;
+	lock.unlock();
+	condition.notify_all();
+	for (auto &thread : threads)
+		thread.join();
+	threads.clear();
+	lock.lock();
+	shutdown_flag = false;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+FString FSoftwareTextureCache::GetStats()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	FString out;
+	out.Format("resident=%.1f MB of %d MB  textures=%u  hits=%d  misses=%d  evictions=%d  mipmap jobs=%d",
+		ResidentBytes / (1024.0 * 1024.0), *r_texcachesize, Resident.Size(), LastHits, LastMisses, Evictions,
+		(int)(QueuedJobs.size() + RunningJobs.size() + FinishedJobs.size()));
+	return out;
+}
+
+ADD_STAT(swtexcache)
+{
+	return FSoftwareTextureCache::Instance()->GetStats();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "tarray.h"
+#include "zstring.h"
+
+class FSoftwareTexture;
+
+// Keeps track of the memory held by software renderer textures. When the total goes over
+// r_texcachesize the textures that have been unused the longest are unloaded again, and the
+// high quality BGRA mipmaps are generated on worker threads instead of when a texture is loaded.
+class FSoftwareTextureCache
+{
+public:
+	static FSoftwareTextureCache *Instance();
+
+	// Must be called between frames, when no scene or drawer threads are using texture data
+	void BeginFrame();
+
+	int GetFrame() const { return Frame; }
+
+	void MarkUsed(FSoftwareTexture *texture, bool loaded);
+	void UpdateSize(FSoftwareTexture *texture, size_t bytes);
+	bool QueueMipmaps(FSoftwareTexture *texture);
+	void Remove(FSoftwareTexture *texture);
+
+	FString GetStats();
+
+private:
+	struct MipmapJob
+	{
+		FSoftwareTexture *Texture = nullptr;
+		int Generation = 0;
+		int Width = 0;
+		int Height = 0;
+		int Levels = 0;
+		TArray<uint32_t> Pixels;
+	};
+
+	FSoftwareTextureCache() = default;
+	~FSoftwareTextureCache();
+
+	void StartThreads();
+	void StopThreads();
+	void WorkerMain();
+	void ApplyMipmaps();
+	void EvictTextures();
+	void RemoveResident(FSoftwareTexture *texture);
+
+	std::mutex mutex;
+	TArray<FSoftwareTexture *> Resident;
+	size_t ResidentBytes = 0;
+	int Frame = 0;
+
+	std::atomic<int> Hits = { 0 };
+	std::atomic<int> Misses = { 0 };
+	int LastHits = 0;
+	int LastMisses = 0;
+	int Evictions = 0;
+
+	std::vector<std::thread> threads;
+	std::condition_variable condition;
+	std::vector<std::unique_ptr<MipmapJob>> QueuedJobs;
+	std::vector<MipmapJob *> RunningJobs;
+	std::vector<std::unique_ptr<MipmapJob>> FinishedJobs;
+	bool shutdown_flag = false;
+};
@@ -72,6 +72,7 @@ const uint32_t *FWarpTexture::GetPixelsBgra()
 		WarpBuffer(WarpedPixelsRgba.Data(), otherpix, int(GetWidth() * resizeMult), int(GetHeight() * resizeMult), WidthOffsetMultiplier, HeightOffsetMultiplier, time, mTexture->GetShaderSpeed(), bWarped);
 		GenerateBgraMipmapsFast();
 		FreeAllSpans();
+		UpdateCacheSize();
 		GenTime[2] = time;
 	}
 	return WarpedPixelsRgba.Data();
@@ -92,11 +93,27 @@ const uint8_t *FWarpTexture::GetPixels(int index)
 		WarpedPixels[index].Resize(unsigned(GetWidth() * GetHeight() * resizeMult * resizeMult));
 		WarpBuffer(WarpedPixels[index].Data(), otherpix, int(GetWidth() * resizeMult), int(GetHeight() * resizeMult), WidthOffsetMultiplier, HeightOffsetMultiplier, time, mTexture->GetShaderSpeed(), bWarped);
 		FreeAllSpans();
+		UpdateCacheSize();
 		GenTime[index] = time;
 	}
 	return WarpedPixels[index].Data();
 }
 
+size_t FWarpTexture::ExtraCacheBytes() const
+{
+	return WarpedPixels[0].Size() + WarpedPixels[1].Size() + WarpedPixelsRgba.Size() * sizeof(uint32_t);
+}
+
+// The warped copies are made again from the source on the next use.
+void FWarpTexture::Unload()
+{
+	for (auto &pixels : WarpedPixels)
+		pixels.Reset();
+	WarpedPixelsRgba.Reset();
+	GenTime[0] = GenTime[1] = GenTime[2] = UINT64_MAX;
+	FSoftwareTexture::Unload();
+}
+
 // [mxd] Non power of 2 textures need different offset multipliers, otherwise warp animation won't sync across texture
 void FWarpTexture::SetupMultipliers (int width, int height)
 {
@@ -57,6 +57,7 @@
 #include "swrenderer/scene/r_portal.h"
 #include "swrenderer/scene/r_light.h"
 #include "swrenderer/segments/r_drawsegment.h"
+#include "swrenderer/segments/r_coveragebuffer.h"
 #include "swrenderer/line/r_renderdrawsegment.h"
 #include "swrenderer/things/r_particle.h"
 #include "swrenderer/viewport/r_viewport.h"
@@ -147,6 +148,9 @@ namespace swrenderer
 		if (y1 > y2)
 			return;
 
+		if (thread->Coverage->IsOccluded(x1, x2, y1, y2 + 1, (float)tz))
+			return;
+
 		// Clip particles above the ceiling or below the floor.
 		heightsec = sector->GetHeightSec();
 
@@ -57,6 +57,7 @@
 #include "p_local.h"
 #include "r_voxel.h"
 #include "swrenderer/segments/r_drawsegment.h"
+#include "swrenderer/segments/r_coveragebuffer.h"
 #include "swrenderer/scene/r_portal.h"
 #include "swrenderer/scene/r_scene.h"
 #include "swrenderer/scene/r_light.h"
@@ -134,6 +135,14 @@ namespace swrenderer
 		if (thing->renderflags & RF_SPRITEFLIP)
 			renderflags ^= RF_XFLIP;
 
+		// Skip sprites that the walls already drawn will clip away completely.
+		// A negative floorclip raises the sprite above gzt.
+		double screenscale = viewport->InvZtoScale / wallc.sz1;
+		int covery1 = xs_FloorToInt(viewport->CenterY - (gzt - MIN(thing->Floorclip, 0.0) - viewport->viewpoint.Pos.Z) * screenscale) - 1;
+		int covery2 = xs_CeilToInt(viewport->CenterY - (gzb - viewport->viewpoint.Pos.Z) * screenscale) + 1;
+		if (thread->Coverage->IsOccluded(MAX<int>(wallc.sx1, renderportal->WindowLeft), MIN<int>(wallc.sx2, renderportal->WindowRight), covery1, covery2, (float)wallc.sz1))
+			return;
+
 		double yscale, origyscale;
 		int resizeMult = gl_texture_hqresizemult;
 
@@ -33,9 +33,64 @@
 #include "swrenderer/things/r_visiblesprite.h"
 #include "swrenderer/things/r_visiblespritelist.h"
 #include "r_memory.h"
+#include "c_dispatch.h"
+#include "i_time.h"
+#include "printf.h"
 
 namespace swrenderer
 {
+	// Maps SortDist to a key where a larger distance sorts first. Negative zero is
+	// folded into zero since the two compare equal as floats.
+	static uint32_t SortDistKey(float dist)
+	{
+		if (dist == 0.0f)
+			dist = 0.0f;
+		uint32_t bits;
+		memcpy(&bits, &dist, sizeof(bits));
+		bits = (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+		return ~bits;
+	}
+
+	// Stable sort of the entries by key. Small lists use std::stable_sort, larger ones an
+	// LSD radix sort with 8 bit digits that skips digits where all keys are the same.
+	// Both keep entries with equal keys in their original order.
+	static SpriteSortEntry *SortEntriesByKey(SpriteSortEntry *entries, SpriteSortEntry *scratch, unsigned int count, int keyBytes)
+	{
+		if (count < 256)
+		{
+			std::stable_sort(entries, entries + count, [](const SpriteSortEntry &a, const SpriteSortEntry &b) { return a.Key < b.Key; });
+			return entries;
+		}
+
+		unsigned int histogram[8][256] = {};
+		for (unsigned int i = 0; i < count; i++)
+		{
+			uint64_t key = entries[i].Key;
+			for (int digit = 0; digit < keyBytes; digit++)
+				histogram[digit][(key >> (digit * 8)) & 0xff]++;
+		}
+
+		for (int digit = 0; digit < keyBytes; digit++)
+		{
+			unsigned int *buckets = histogram[digit];
+			if (buckets[(entries[0].Key >> (digit * 8)) & 0xff] == count)
+				continue;
+
+			unsigned int offset = 0;
+			for (int i = 0; i < 256; i++)
+			{
+				unsigned int size = buckets[i];
+				buckets[i] = offset;
+				offset += size;
+			}
+
+			for (unsigned int i = 0; i < count; i++)
+				scratch[buckets[(entries[i].Key >> (digit * 8)) & 0xff]++] = entries[i];
+			std::swap(entries, scratch);
+		}
+		return entries;
+	}
+
 	void VisibleSpriteList::Clear()
 	{
 		Sprites.Clear();
@@ -83,29 +138,32 @@ namespace swrenderer
 				SortedSprites[i] = Sprites[first + count - i - 1];
 		}
 
+		SortEntries.Resize(count);
+		SortScratch.Resize(count);
+
+		int keyBytes = 4;
 		if (r_modelscene)
 		{
+			// Sort by subsector depth first, then by distance
 			for (unsigned int i = 0; i < count; i++)
 			{
-				FVector2 worldPos = SortedSprites[i]->WorldPos().XY();
-				SortedSprites[i]->SubsectorDepth = FindSubsectorDepth(thread, { worldPos.X, worldPos.Y });
+				VisibleSprite *sprite = SortedSprites[i];
+				FVector2 worldPos = sprite->WorldPos().XY();
+				sprite->SubsectorDepth = FindSubsectorDepth(thread, { worldPos.X, worldPos.Y });
+				uint32_t subsectorKey = (uint32_t)sprite->SubsectorDepth ^ 0x80000000;
+				SortEntries[i] = { ((uint64_t)subsectorKey << 32) | SortDistKey(sprite->SortDist()), sprite };
 			}
-
-			std::stable_sort(&SortedSprites[0], &SortedSprites[count], [](VisibleSprite *a, VisibleSprite *b) -> bool
-			{
-				if (a->SubsectorDepth != b->SubsectorDepth)
-					return a->SubsectorDepth < b->SubsectorDepth;
-				else
-					return a->SortDist() > b->SortDist();
-			});
+			keyBytes = 8;
 		}
 		else
 		{
-			std::stable_sort(&SortedSprites[0], &SortedSprites[count], [](VisibleSprite *a, VisibleSprite *b) -> bool
-			{
-				return a->SortDist() > b->SortDist();
-			});
+			for (unsigned int i = 0; i < count; i++)
+				SortEntries[i] = { SortDistKey(SortedSprites[i]->SortDist()), SortedSprites[i] };
 		}
+
+		SpriteSortEntry *sorted = SortEntriesByKey(&SortEntries[0], &SortScratch[0], count, keyBytes);
+		for (unsigned int i = 0; i < count; i++)
+			SortedSprites[i] = sorted[i].Sprite;
 	}
 
 	uint32_t VisibleSpriteList::FindSubsectorDepth(RenderThread *thread, const DVector2 &worldPos)
@@ -139,4 +197,75 @@ namespace swrenderer
 		subsector_t *sub = (subsector_t *)((uint8_t *)node - 1);
 		return thread->OpaquePass->GetSubsectorDepth(sub->Index());
 	}
+
+	//=====================================================================================
+	//
+	// spritesortbench [count]
+	//
+	// Compares the std::stable_sort over sprite pointers that VisibleSpriteList used to
+	// do against the key radix sort, and checks that both produce the same order.
+	//
+	//=====================================================================================
+
+	namespace
+	{
+		class BenchSprite : public VisibleSprite
+		{
+		public:
+			BenchSprite(float dist = 0.0f) { idepth = dist; }
+
+		protected:
+			void Render(RenderThread *thread, short *cliptop, short *clipbottom, int minZ, int maxZ, Fake3DTranslucent clip3DFloor) override { }
+		};
+	}
+
+	CCMD(spritesortbench)
+	{
+		int count = argv.argc() > 1 ? (int)strtol(argv[1], nullptr, 0) : 1000;
+		if (count <= 0) return;
+
+		// Limit the number of distinct distances so that the sort has ties to keep stable
+		TArray<BenchSprite> sprites(count);
+		uint32_t seed = 12345;
+		for (int i = 0; i < count; i++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			sprites.Push(BenchSprite(((seed >> 8) % (count / 2 + 1)) * (1.0f / 256.0f)));
+		}
+
+		TArray<VisibleSprite *> input(count, true), stableSorted(count, true), radixSorted(count, true);
+		for (int i = 0; i < count; i++)
+			input[i] = &sprites[i];
+
+		TArray<SpriteSortEntry> entries(count, true), scratch(count, true);
+		const int passes = 100;
+
+		uint64_t t0 = I_nsTime();
+		for (int pass = 0; pass < passes; pass++)
+		{
+			for (int i = 0; i < count; i++)
+				stableSorted[i] = input[i];
+			std::stable_sort(&stableSorted[0], &stableSorted[0] + count, [](VisibleSprite *a, VisibleSprite *b) -> bool
+			{
+				return a->SortDist() > b->SortDist();
+			});
+		}
+		uint64_t t1 = I_nsTime();
+		for (int pass = 0; pass < passes; pass++)
+		{
+			for (int i = 0; i < count; i++)
+				entries[i] = { SortDistKey(input[i]->SortDist()), input[i] };
+			SpriteSortEntry *sorted = SortEntriesByKey(&entries[0], &scratch[0], count, 4);
+			for (int i = 0; i < count; i++)
+				radixSorted[i] = sorted[i].Sprite;
+		}
+		uint64_t t2 = I_nsTime();
+
+		int mismatches = 0;
+		for (int i = 0; i < count; i++)
+			mismatches += stableSorted[i] != radixSorted[i];
+
+		double n = (double)count * passes;
+		Printf("stable_sort %6.1f  radix %6.1f ns/sprite (%d sprites, %d mismatches)\n", (t1 - t0) / n, (t2 - t1) / n, count, mismatches);
+	}
 }
@@ -5,6 +5,13 @@ namespace swrenderer
 	struct DrawSegment;
 	class VisibleSprite;
 
+	// Sort key extracted from a sprite so that sorting does not need to dereference it
+	struct SpriteSortEntry
+	{
+		uint64_t Key;
+		VisibleSprite *Sprite;
+	};
+
 	class VisibleSpriteList
 	{
 	public:
@@ -22,5 +29,7 @@ namespace swrenderer
 
 		TArray<VisibleSprite *> Sprites;
 		TArray<unsigned int> StartIndices;
+		TArray<SpriteSortEntry> SortEntries;
+		TArray<SpriteSortEntry> SortScratch;
 	};
 }
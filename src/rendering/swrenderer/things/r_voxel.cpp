@@ -53,11 +53,16 @@
 #include "swrenderer/scene/r_light.h"
 #include "swrenderer/viewport/r_viewport.h"
 #include "swrenderer/viewport/r_spritedrawer.h"
+#include "swrenderer/segments/r_coveragebuffer.h"
 #include "r_memory.h"
 #include "swrenderer/r_renderthread.h"
 
 EXTERN_CVAR(Bool, r_fullbrightignoresectorcolor)
 
+// Each step halves the distance at which a voxel switches to its next lower detail mip level,
+// so every mip level is used one level earlier. Ranges from 0 to 8.
+CVAR(Int, r_voxelmipbias, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
 namespace swrenderer
 {
 	void RenderVoxel::Project(RenderThread *thread, AActor *thing, DVector3 pos, FVoxelDef *voxel, const DVector2 &spriteScale, int renderflags, WaterFakeSide fakeside, F3DFloor *fakefloor, F3DFloor *fakeceiling, sector_t *current_sector, int lightlevel, bool foggy, FDynamicColormap *basecolormap)
@@ -189,16 +194,40 @@ namespace swrenderer
 
 		vis->Light.SetColormap(thread, tz, lightlevel, foggy, basecolormap, fullbright, invertcolormap, fadeToBlack, false, false);
 
-		// Fake a voxel drawing to find its extents..
+		// Find the visible slab columns and their extents. They are kept for all the Render calls.
 		SpriteDrawerArgs drawerargs;
 		bool visible = drawerargs.SetStyle(thread->Viewport.get(), vis->RenderStyle, vis->Alpha, vis->Translation, vis->FillColor, vis->Light);
 		if (!visible)
 			return;
-		int flags = vis->bInMirror ? (DVF_MIRRORED | DVF_FIND_X1X2) : DVF_FIND_X1X2;
-		vis->DrawVoxel(thread, drawerargs, vis->pa.vpos, vis->pa.vang, vis->gpos, vis->Angle, vis->xscale, FLOAT2FIXED(vis->yscale), vis->voxel, nullptr, nullptr, 0, 0, flags);
+		int flags = vis->bInMirror ? DVF_MIRRORED : 0;
+		vis->Columns = vis->FindVisibleColumns(thread, drawerargs, vis->pa.vpos, vis->pa.vang, vis->gpos, vis->Angle, vis->xscale, FLOAT2FIXED(vis->yscale), vis->voxel, flags);
+		if (vis->Columns == nullptr)
+			return;
+		vis->x1 = vis->Columns->x1;
+		vis->x2 = vis->Columns->x2;
 		if (vis->x1 >= vis->x2)
 			return;
 
+		// Skip voxels that the walls already drawn will clip away completely. Clipping uses the
+		// depth of the origin, but the rows covered depend on the nearest and farthest voxels.
+		// tz is scaled by the focal tangent (see TanCos), so the radius has to be as well.
+		auto viewport = thread->Viewport.get();
+		const FVoxelMipLevel &mip = voxel->Voxel->Mips[0];
+		double radius = (fabs(mip.Pivot.X) + mip.SizeX + fabs(mip.Pivot.Y) + mip.SizeY) * xscale * viewport->viewwindow.FocalTangent;
+		double nearz = tz - radius;
+		double farz = tz + radius;
+		int covery1 = 0;
+		int covery2 = viewheight;
+		if (nearz > MINZ)
+		{
+			double topz = gzt - viewport->viewpoint.Pos.Z;
+			double bottomz = gzb - MAX(thing->Floorclip, 0.0) - viewport->viewpoint.Pos.Z;
+			covery1 = xs_FloorToInt(viewport->CenterY - topz * viewport->InvZtoScale / (topz > 0.0 ? nearz : farz)) - 1;
+			covery2 = xs_CeilToInt(viewport->CenterY - bottomz * viewport->InvZtoScale / (bottomz < 0.0 ? nearz : farz)) + 1;
+		}
+		if (thread->Coverage->IsOccluded(vis->x1, vis->x2, covery1, covery2, (float)tz))
+			return;
+
 		thread->SpriteList->Push(vis);
 	}
 
@@ -235,9 +264,7 @@ namespace swrenderer
 		}
 
 		// Render the voxel, either directly to the screen or offscreen.
-		DrawVoxel(thread, drawerargs, spr->pa.vpos, spr->pa.vang, spr->gpos, spr->Angle,
-			spr->xscale, FLOAT2FIXED(spr->yscale), spr->voxel, cliptop, clipbottom,
-			minZ, maxZ, flags);
+		DrawVoxel(thread, drawerargs, cliptop, clipbottom, minZ, maxZ);
 
 		/*
 		// Blend the voxel, if that's what we need to do.
@@ -275,20 +302,18 @@ namespace swrenderer
 		*/
 	}
 
-	void RenderVoxel::DrawVoxel(
+	RenderVoxel::VoxelColumnList *RenderVoxel::FindVisibleColumns(
 		RenderThread *thread, SpriteDrawerArgs &drawerargs,
-		const FVector3 &globalpos, FAngle viewangle, const FVector3 &dasprpos, DAngle dasprang, fixed_t daxscale, fixed_t dayscale, FVoxel *voxobj,
-		short *daumost, short *dadmost, int minslabz, int maxslabz, int flags)
+		const FVector3 &globalpos, FAngle viewangle, const FVector3 &dasprpos, DAngle dasprang, fixed_t daxscale, fixed_t dayscale, FVoxel *voxobj, int flags)
 	{
 		int i, j, k, x, y, syoff, ggxstart, ggystart, nxoff;
 		fixed_t cosang, sinang, sprcosang, sprsinang;
 		int backx, backy, gxinc, gyinc;
 		int daxscalerecip, dayscalerecip, cnt, gxstart, gystart, dazscale;
-		int lx, rx, nx, ny, x1 = 0, y1 = 0, x2 = 0, y2 = 0, yinc = 0;
+		int lx, rx, nx, ny, x1 = 0, y1 = 0, x2 = 0, y2 = 0;
 		int yoff, xs = 0, ys = 0, xe, ye, xi = 0, yi = 0, cbackx, cbacky, dagxinc, dagyinc;
 		kvxslab_t *voxptr, *voxend;
 		FVoxelMipLevel *mip;
-		int z1a[64], z2a[64], yplc[64];
 
 		auto viewport = thread->Viewport.get();
 
@@ -313,7 +338,7 @@ namespace swrenderer
 		if (daxscale <= 0 || dayscale <= 0)
 		{
 			// won't be visible.
-			return;
+			return nullptr;
 		}
 
 		angle_t viewang = viewangle.BAMs();
@@ -325,17 +350,14 @@ namespace swrenderer
 		// Select mip level
 		i = abs(DMulScale(dasprx - globalposx, cosang, daspry - globalposy, sinang, 6));
 		i = DivScale(i, MIN(daxscale, dayscale), 6);
-		j = xs_Fix<13>::ToFix(viewport->FocalLengthX);
+		j = xs_Fix<13>::ToFix(viewport->FocalLengthX) >> clamp<int>(r_voxelmipbias, 0, 8);
 		for (k = 0; i >= j && k < voxobj->NumMips; ++k)
 		{
 			i >>= 1;
 		}
 		if (k >= voxobj->NumMips) k = voxobj->NumMips - 1;
 
-		mip = &voxobj->Mips[k];		if (mip->GetSlabData(false) == NULL) return;
-
-		minslabz >>= k;
-		maxslabz >>= k;
+		mip = &voxobj->Mips[k];		if (mip->GetSlabData(false) == NULL) return nullptr;
 
 		daxscale <<= (k + 8); dayscale <<= (k + 8);
 		dazscale = DivScale(dayscale, FLOAT2FIXED(viewport->BaseYaspectMul), 16);
@@ -370,7 +392,7 @@ namespace swrenderer
 		gystart = x*cosang + y*sinang;
 		gxinc = DMulScale(sprsinang, cosang, sprcosang, -sinang, 10);
 		gyinc = DMulScale(sprcosang, cosang, sprsinang, sinang, 10);
-		if ((abs(globalposz - dasprz) >> 10) >= abs(dazscale)) return;
+		if ((abs(globalposz - dasprz) >> 10) >= abs(dazscale)) return nullptr;
 
 		x = 0; y = 0; j = MAX(mip->SizeX, mip->SizeY);
 		fixed_t *ggxinc = (fixed_t *)alloca((j + 1) * sizeof(fixed_t) * 2);
@@ -388,14 +410,13 @@ namespace swrenderer
 		if (!useSlabDataBgra) voxobj->Remap();
 		else voxobj->CreateBgraSlabData();
 
-		int coverageX1 = this->x2;
-		int coverageX2 = this->x1;
-
-		const int maxoutblocks = 100;
-		VoxelBlock *outblocks = nullptr;
-		if ((flags & DVF_FIND_X1X2) == 0)
-			outblocks = thread->FrameMemory->AllocMemory<VoxelBlock>(maxoutblocks);
-		int nextoutblock = 0;
+		VoxelColumnList *list = thread->FrameMemory->NewObject<VoxelColumnList>();
+		list->mip = mip;
+		list->miplevel = k;
+		list->syoff = syoff;
+		list->x1 = this->x2;
+		list->x2 = this->x1;
+		VoxelColumnChunk *chunk = nullptr;
 
 		for (cnt = 0; cnt < 8; cnt++)
 		{
@@ -485,200 +506,236 @@ namespace swrenderer
 					if (rx > this->x2) rx = this->x2;
 					if (rx <= lx) continue;
 
-					if (flags & DVF_FIND_X1X2)
+					if (chunk == nullptr || chunk->count == VoxelColumnChunk::Size)
 					{
-						coverageX1 = MIN(coverageX1, lx);
-						coverageX2 = MAX(coverageX2, rx);
-						continue;
+						VoxelColumnChunk *next = thread->FrameMemory->NewObject<VoxelColumnChunk>();
+						if (chunk)
+							chunk->next = next;
+						else
+							list->first = next;
+						chunk = next;
 					}
 
-					fixed_t l1 = xs_RoundToInt(centerxwidebig_f / (ny - yoff));
-					fixed_t l2 = xs_RoundToInt(centerxwidebig_f / (ny + yoff));
-					for (; voxptr < voxend; voxptr = (kvxslab_t *)((uint8_t *)voxptr + voxptr->zleng + 3))
+					VoxelColumn &column = chunk->columns[chunk->count++];
+					column.slabs = voxptr;
+					column.slabsEnd = voxend;
+					column.lx = lx;
+					column.rx = rx;
+					column.l1 = xs_RoundToInt(centerxwidebig_f / (ny - yoff));
+					column.l2 = xs_RoundToInt(centerxwidebig_f / (ny + yoff));
+					column.oand = oand;
+
+					list->x1 = MIN(list->x1, lx);
+					list->x2 = MAX(list->x2, rx);
+				}
+			}
+		}
+
+		return list;
+	}
+
+	void RenderVoxel::DrawVoxel(RenderThread *thread, SpriteDrawerArgs &drawerargs, short *daumost, short *dadmost, int minslabz, int maxslabz)
+	{
+		int yinc = 0;
+		int z1a[64], z2a[64], yplc[64];
+
+		auto viewport = thread->Viewport.get();
+		FVoxelMipLevel *mip = Columns->mip;
+		int syoff = Columns->syoff;
+
+		minslabz >>= Columns->miplevel;
+		maxslabz >>= Columns->miplevel;
+
+		bool useSlabDataBgra = !drawerargs.DrawerNeedsPalInput() && viewport->RenderTarget->IsBgra();
+		if (!useSlabDataBgra) voxel->Remap();
+		else voxel->CreateBgraSlabData();
+		auto SlabData = mip->GetSlabData(true);
+
+		const int maxoutblocks = 100;
+		VoxelBlock *outblocks = thread->FrameMemory->AllocMemory<VoxelBlock>(maxoutblocks);
+		int nextoutblock = 0;
+
+		for (const VoxelColumnChunk *chunk = Columns->first; chunk != nullptr; chunk = chunk->next)
+		{
+			for (int columnIndex = 0; columnIndex < chunk->count; columnIndex++)
+			{
+				const VoxelColumn &column = chunk->columns[columnIndex];
+				for (const kvxslab_t *voxptr = column.slabs; voxptr < column.slabsEnd; voxptr = (const kvxslab_t *)((const uint8_t *)voxptr + voxptr->zleng + 3))
+				{
+					const uint8_t *col = voxptr->col;
+					int zleng = voxptr->zleng;
+					int ztop = voxptr->ztop;
+					fixed_t z1, z2;
+
+					if (ztop < minslabz)
 					{
-						const uint8_t *col = voxptr->col;
-						int zleng = voxptr->zleng;
-						int ztop = voxptr->ztop;
-						fixed_t z1, z2;
+						int diff = minslabz - ztop;
+						ztop = minslabz;
+						col += diff;
+						zleng -= diff;
+					}
+					if (ztop + zleng > maxslabz)
+					{
+						int diff = ztop + zleng - maxslabz;
+						zleng -= diff;
+					}
+					if (zleng <= 0) continue;
 
-						if (ztop < minslabz)
+					int j = (ztop << 15) - syoff;
+					if (j < 0)
+					{
+						int k = j + (zleng << 15);
+						if (k < 0)
 						{
-							int diff = minslabz - ztop;
-							ztop = minslabz;
-							col += diff;
-							zleng -= diff;
+							if ((voxptr->backfacecull & (column.oand + 32)) == 0) continue;
+							z2 = MulScale(column.l2, k, 32) + viewport->viewwindow.centery;					/* Below slab */
 						}
-						if (ztop + zleng > maxslabz)
+						else
 						{
-							int diff = ztop + zleng - maxslabz;
-							zleng -= diff;
+							if ((voxptr->backfacecull & column.oand) == 0) continue;	/* Middle of slab */
+							z2 = MulScale(column.l1, k, 32) + viewport->viewwindow.centery;
 						}
-						if (zleng <= 0) continue;
+						z1 = MulScale(column.l1, j, 32) + viewport->viewwindow.centery;
+					}
+					else
+					{
+						if ((voxptr->backfacecull & (column.oand + 16)) == 0) continue;
+						z1 = MulScale(column.l2, j, 32) + viewport->viewwindow.centery;						/* Above slab */
+						z2 = MulScale(column.l1, j + (zleng << 15), 32) + viewport->viewwindow.centery;
+					}
 
-						j = (ztop << 15) - syoff;
-						if (j < 0)
+					if (z2 <= z1) continue;
+
+					if (zleng == 1)
+					{
+						yinc = 0;
+					}
+					else
+					{
+						if (z2 - z1 >= 1024) yinc = DivScale(zleng, z2 - z1, 16);
+						else yinc = (((1 << 24) - 1) / (z2 - z1)) * zleng >> 8;
+					}
+					// [RH] Clip each column separately, not just by the first one.
+					for (int stripwidth = MIN<int>(countof(z1a), column.rx - column.lx), lxt = column.lx;
+						lxt < column.rx;
+						(lxt += countof(z1a)), stripwidth = MIN<int>(countof(z1a), column.rx - lxt))
+					{
+						// Calculate top and bottom pixels locations
+						for (int xxx = 0; xxx < stripwidth; ++xxx)
 						{
-							k = j + (zleng << 15);
-							if (k < 0)
+							if (zleng == 1)
 							{
-								if ((voxptr->backfacecull & oand32) == 0) continue;
-								z2 = MulScale(l2, k, 32) + viewport->viewwindow.centery;					/* Below slab */
+								yplc[xxx] = 0;
+								z1a[xxx] = MAX<int>(z1, daumost[lxt + xxx]);
 							}
 							else
 							{
-								if ((voxptr->backfacecull & oand) == 0) continue;	/* Middle of slab */
-								z2 = MulScale(l1, k, 32) + viewport->viewwindow.centery;
+								if (z1 < daumost[lxt + xxx])
+								{
+									yplc[xxx] = yinc * (daumost[lxt + xxx] - z1);
+									z1a[xxx] = daumost[lxt + xxx];
+								}
+								else
+								{
+									yplc[xxx] = 0;
+									z1a[xxx] = z1;
+								}
 							}
-							z1 = MulScale(l1, j, 32) + viewport->viewwindow.centery;
-						}
-						else
-						{
-							if ((voxptr->backfacecull & oand16) == 0) continue;
-							z1 = MulScale(l2, j, 32) + viewport->viewwindow.centery;						/* Above slab */
-							z2 = MulScale(l1, j + (zleng << 15), 32) + viewport->viewwindow.centery;
+							z2a[xxx] = MIN<int>(z2, dadmost[lxt + xxx]);
 						}
 
-						if (z2 <= z1) continue;
-
-						if (zleng == 1)
+						const uint8_t *columnColors = col;
+						if (useSlabDataBgra)
 						{
-							yinc = 0;
+							// The true color slab data array is identical, except its using uint32_t instead of uint8.
+							//
+							// We can find the same slab column by calculating the offset from the start of SlabData
+							// and use that to offset into the BGRA version of the same data.
+							columnColors = (const uint8_t *)(&mip->SlabDataBgra[0] + (ptrdiff_t)(col - SlabData));
 						}
-						else
-						{
-							if (z2 - z1 >= 1024) yinc = DivScale(zleng, z2 - z1, 16);
-							else yinc = (((1 << 24) - 1) / (z2 - z1)) * zleng >> 8;
-						}
-						// [RH] Clip each column separately, not just by the first one.
-						for (int stripwidth = MIN<int>(countof(z1a), rx - lx), lxt = lx;
-							lxt < rx;
-							(lxt += countof(z1a)), stripwidth = MIN<int>(countof(z1a), rx - lxt))
+
+						// Find top and bottom pixels that match and draw them as one strip
+						for (int xxl = 0, xxr; xxl < stripwidth; )
 						{
-							// Calculate top and bottom pixels locations
-							for (int xxx = 0; xxx < stripwidth; ++xxx)
+							if (z1a[xxl] >= z2a[xxl])
+							{ // No column here
+								xxl++;
+								continue;
+							}
+							int z1 = z1a[xxl];
+							int z2 = z2a[xxl];
+							// How many columns share the same extents?
+							for (xxr = xxl + 1; xxr < stripwidth; ++xxr)
 							{
-								if (zleng == 1)
-								{
-									yplc[xxx] = 0;
-									z1a[xxx] = MAX<int>(z1, daumost[lxt + xxx]);
-								}
-								else
-								{
-									if (z1 < daumost[lxt + xxx])
-									{
-										yplc[xxx] = yinc * (daumost[lxt + xxx] - z1);
-										z1a[xxx] = daumost[lxt + xxx];
-									}
-									else
-									{
-										yplc[xxx] = 0;
-										z1a[xxx] = z1;
-									}
-								}
-								z2a[xxx] = MIN<int>(z2, dadmost[lxt + xxx]);
+								if (z1a[xxr] != z1 || z2a[xxr] != z2)
+									break;
 							}
 
-							const uint8_t *columnColors = col;
-							if (useSlabDataBgra)
+							outblocks[nextoutblock].x = lxt + xxl;
+							outblocks[nextoutblock].y = z1;
+							outblocks[nextoutblock].width = xxr - xxl;
+							outblocks[nextoutblock].height = z2 - z1;
+							outblocks[nextoutblock].vPos = yplc[xxl];
+							outblocks[nextoutblock].vStep = yinc;
+							outblocks[nextoutblock].voxels = columnColors;
+							outblocks[nextoutblock].voxelsCount = zleng;
+							nextoutblock++;
+
+							if (nextoutblock == maxoutblocks)
 							{
-								// The true color slab data array is identical, except its using uint32_t instead of uint8.
-								//
-								// We can find the same slab column by calculating the offset from the start of SlabData
-								// and use that to offset into the BGRA version of the same data.
-								columnColors = (const uint8_t *)(&mip->SlabDataBgra[0] + (ptrdiff_t)(col - SlabData));
+								drawerargs.DrawVoxelBlocks(thread, outblocks, maxoutblocks);
+								outblocks = thread->FrameMemory->AllocMemory<VoxelBlock>(maxoutblocks);
+								nextoutblock = 0;
 							}
 
-							// Find top and bottom pixels that match and draw them as one strip
-							for (int xxl = 0, xxr; xxl < stripwidth; )
+							/*
+							for (int x = xxl; x < xxr; ++x)
 							{
-								if (z1a[xxl] >= z2a[xxl])
-								{ // No column here
-									xxl++;
-									continue;
-								}
-								int z1 = z1a[xxl];
-								int z2 = z2a[xxl];
-								// How many columns share the same extents?
-								for (xxr = xxl + 1; xxr < stripwidth; ++xxr)
-								{
-									if (z1a[xxr] != z1 || z2a[xxr] != z2)
-										break;
-								}
-
-								outblocks[nextoutblock].x = lxt + xxl;
-								outblocks[nextoutblock].y = z1;
-								outblocks[nextoutblock].width = xxr - xxl;
-								outblocks[nextoutblock].height = z2 - z1;
-								outblocks[nextoutblock].vPos = yplc[xxl];
-								outblocks[nextoutblock].vStep = yinc;
-								outblocks[nextoutblock].voxels = columnColors;
-								outblocks[nextoutblock].voxelsCount = zleng;
-								nextoutblock++;
-
-								if (nextoutblock == maxoutblocks)
-								{
-									drawerargs.DrawVoxelBlocks(thread, outblocks, maxoutblocks);
-									outblocks = thread->FrameMemory->AllocMemory<VoxelBlock>(maxoutblocks);
-									nextoutblock = 0;
-								}
+								drawerargs.SetDest(viewport, lxt + x, z1);
+								drawerargs.SetCount(z2 - z1);
+								drawerargs.DrawVoxelColumn(thread, yplc[xxl], yinc, columnColors, zleng);
+							}
+							*/
 
-								/*
+							/*
+							if (!(flags & DVF_OFFSCREEN))
+							{
+								// Draw directly to the screen.
+								R_DrawSlab(xxr - xxl, yplc[xxl], z2 - z1, yinc, col, (ylookup[z1] + lxt + xxl) * pixelsize + dc_destorg);
+							}
+							else
+							{
+								// Record the area covered and possibly draw to an offscreen buffer.
+								dc_yl = z1;
+								dc_yh = z2 - 1;
+								dc_count = z2 - z1;
+								dc_iscale = yinc;
 								for (int x = xxl; x < xxr; ++x)
 								{
-									drawerargs.SetDest(viewport, lxt + x, z1);
-									drawerargs.SetCount(z2 - z1);
-									drawerargs.DrawVoxelColumn(thread, yplc[xxl], yinc, columnColors, zleng);
-								}
-								*/
-
-								/*
-								if (!(flags & DVF_OFFSCREEN))
-								{
-									// Draw directly to the screen.
-									R_DrawSlab(xxr - xxl, yplc[xxl], z2 - z1, yinc, col, (ylookup[z1] + lxt + xxl) * pixelsize + dc_destorg);
-								}
-								else
-								{
-									// Record the area covered and possibly draw to an offscreen buffer.
-									dc_yl = z1;
-									dc_yh = z2 - 1;
-									dc_count = z2 - z1;
-									dc_iscale = yinc;
-									for (int x = xxl; x < xxr; ++x)
+									OffscreenCoverageBuffer->InsertSpan(lxt + x, z1, z2);
+									if (!(flags & DVF_SPANSONLY))
 									{
-										OffscreenCoverageBuffer->InsertSpan(lxt + x, z1, z2);
-										if (!(flags & DVF_SPANSONLY))
-										{
-											dc_x = lxt + x;
-											rt_initcols(OffscreenColorBuffer + (dc_x & ~3) * OffscreenBufferHeight);
-											dc_source = col;
-											dc_source2 = nullptr;
-											dc_texturefrac = yplc[xxl];
-											hcolfunc_pre();
-										}
+										dc_x = lxt + x;
+										rt_initcols(OffscreenColorBuffer + (dc_x & ~3) * OffscreenBufferHeight);
+										dc_source = col;
+										dc_source2 = nullptr;
+										dc_texturefrac = yplc[xxl];
+										hcolfunc_pre();
 									}
 								}
-								*/
-
-								xxl = xxr;
 							}
+							*/
+
+							xxl = xxr;
 						}
 					}
 				}
 			}
 		}
 
-		if (flags & DVF_FIND_X1X2)
-		{
-			this->x1 = coverageX1;
-			this->x2 = coverageX2;
-		}
-		else
+		if (nextoutblock != 0)
 		{
-			if (nextoutblock != 0)
-			{
-				drawerargs.DrawVoxelBlocks(thread, outblocks, nextoutblock);
-			}
+			drawerargs.DrawVoxelBlocks(thread, outblocks, nextoutblock);
 		}
 	}
 
@@ -79,16 +79,47 @@ namespace swrenderer
 			VoxelBlockEntry *next;
 		};
 
+		// Slab column that survived the projection and backface tests for this view
+		struct VoxelColumn
+		{
+			const kvxslab_t *slabs;
+			const kvxslab_t *slabsEnd;
+			short lx, rx;
+			fixed_t l1, l2;
+			uint8_t oand;
+		};
+
+		struct VoxelColumnChunk
+		{
+			enum { Size = 256 };
+			VoxelColumnChunk *next = nullptr;
+			int count = 0;
+			VoxelColumn columns[Size];
+		};
+
+		// Visible columns of the voxel, found once in Project and drawn by every Render call
+		// (one per 3D floor slice). Lives in frame memory like the sprite itself.
+		struct VoxelColumnList
+		{
+			FVoxelMipLevel *mip = nullptr;
+			int miplevel = 0;
+			int syoff = 0;
+			int x1 = 0;
+			int x2 = 0;
+			VoxelColumnChunk *first = nullptr;
+		};
+
 		posang pa;
 		DAngle Angle = { 0.0 };
 		fixed_t xscale = 0;
 		FVoxel *voxel = nullptr;
 		bool bInMirror = false;
+		VoxelColumnList *Columns = nullptr;
 
 		uint32_t Translation = 0;
 		uint32_t FillColor = 0;
 
-		enum { DVF_OFFSCREEN = 1, DVF_SPANSONLY = 2, DVF_MIRRORED = 4, DVF_FIND_X1X2 = 8 };
+		enum { DVF_OFFSCREEN = 1, DVF_SPANSONLY = 2, DVF_MIRRORED = 4 };
 
 		static kvxslab_t *GetSlabStart(const FVoxelMipLevel &mip, int x, int y);
 		static kvxslab_t *GetSlabEnd(const FVoxelMipLevel &mip, int x, int y);
@@ -101,10 +132,12 @@ namespace swrenderer
 		static int OffscreenBufferHeight;
 		static uint8_t *OffscreenColorBuffer;
 
-		void DrawVoxel(
+		VoxelColumnList *FindVisibleColumns(
 			RenderThread *thread, SpriteDrawerArgs &drawerargs,
 			const FVector3 &globalpos, FAngle viewangle, const FVector3 &dasprpos, DAngle dasprang, fixed_t daxscale, fixed_t dayscale,
-			FVoxel *voxobj, short *daumost, short *dadmost, int minslabz, int maxslabz, int flags);
+			FVoxel *voxobj, int flags);
+
+		void DrawVoxel(RenderThread *thread, SpriteDrawerArgs &drawerargs, short *daumost, short *dadmost, int minslabz, int maxslabz);
 
 		int sgn(int v)
 		{